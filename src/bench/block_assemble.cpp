@@ -8,6 +8,8 @@
 #include <primitives/transaction.h>
 #include <random.h>
 #include <script/script.h>
+#include <segop/buds.h>
+#include <segop/segop.h>
 #include <sync.h>
 #include <test/util/mining.h>
 #include <test/util/script.h>
@@ -18,6 +20,7 @@
 #include <cassert>
 #include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 using node::BlockAssembler;
@@ -69,5 +72,58 @@ static void BlockAssemblerAddPackageTxns(benchmark::Bench& bench)
     });
 }
 
+//! Assemble a block from a mempool mixing plain payments with T2 and T3 segOP
+//! transactions, optionally capping the weight of the T3 ones.
+static void AssembleSegopBlock(benchmark::Bench& bench, bool cap_t3)
+{
+    const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
+
+    CScriptWitness witness;
+    witness.stack.push_back(WITNESS_STACK_ELEM_OP_TRUE);
+    BlockAssembler::Options options;
+    options.coinbase_output_script = P2WSH_OP_TRUE;
+
+    constexpr size_t NUM_BLOCKS{200};
+    std::vector<CTransactionRef> txs;
+    for (size_t b{0}; b < NUM_BLOCKS; ++b) {
+        CMutableTransaction tx;
+        tx.vin.emplace_back(MineBlock(test_setup->m_node, options));
+        tx.vin.back().scriptWitness = witness;
+        // Vary the fee so that the tiers interleave in feerate order.
+        tx.vout.emplace_back(1337 + b * 1000, P2WSH_OP_TRUE);
+        std::vector<unsigned char> payload;
+        if (b % 3 == 1) {
+            payload = BuildSegopBUDSTextPayload(0x20, 0x01, std::string(200, 'a'));
+        } else if (b % 3 == 2) {
+            payload = BuildSegopTextTlv(std::string(2000, 'b'));
+        }
+        if (!payload.empty()) {
+            tx.vout.emplace_back(0, CScript() << OP_RETURN << BuildSegopCommitmentBlob(payload));
+            tx.segop_payload.version = CSegopPayload::SEGOP_VERSION;
+            tx.segop_payload.data = std::move(payload);
+        }
+        if (NUM_BLOCKS - b >= COINBASE_MATURITY) txs.push_back(MakeTransactionRef(std::move(tx)));
+    }
+    {
+        LOCK(::cs_main);
+
+        for (const auto& txr : txs) {
+            const MempoolAcceptResult res = test_setup->m_node.chainman->ProcessTransaction(txr);
+            assert(res.m_result_type == MempoolAcceptResult::ResultType::VALID);
+        }
+    }
+
+    options.test_block_validity = false;
+    if (cap_t3) options.max_arbda_weight[static_cast<size_t>(segop::ARBDATier::T3)] = 40'000;
+    bench.run([&] {
+        PrepareBlock(test_setup->m_node, options);
+    });
+}
+
+static void AssembleBlockSegop(benchmark::Bench& bench) { AssembleSegopBlock(bench, /*cap_t3=*/false); }
+static void AssembleBlockSegopARBDALimit(benchmark::Bench& bench) { AssembleSegopBlock(bench, /*cap_t3=*/true); }
+
 BENCHMARK(AssembleBlock, benchmark::PriorityLevel::HIGH);
 BENCHMARK(BlockAssemblerAddPackageTxns, benchmark::PriorityLevel::LOW);
+BENCHMARK(AssembleBlockSegop, benchmark::PriorityLevel::HIGH);
+BENCHMARK(AssembleBlockSegopARBDALimit, benchmark::PriorityLevel::HIGH);
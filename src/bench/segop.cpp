@@ -0,0 +1,283 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <consensus/tx_check.h>
+#include <consensus/validation.h>
+#include <core_io.h>
+#include <hash.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <segop/segop.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <test/util/transaction_utils.h>
+#include <univalue.h>
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The payload size distributions benchmarked: a tag or hash, a typical
+// metadata document, and the consensus maximum. The TEXT TLV adds 2, 4 and
+// 6 bytes of framing respectively.
+constexpr size_t PAYLOAD_16B{14};
+constexpr size_t PAYLOAD_1KB{1000};
+constexpr size_t PAYLOAD_64KB{63'990};
+
+//! A one-input, two-output witness transaction, with a segOP payload of `payload_size` TEXT bytes if non-zero.
+CMutableTransaction MakeBenchTx(size_t payload_size)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout = COutPoint{Txid::FromUint256(uint256::ONE), 0};
+    mtx.vin[0].scriptWitness.stack = {std::vector<unsigned char>(72, 0x30), std::vector<unsigned char>(33, 0x02)};
+    mtx.vout.emplace_back(50'000, CScript() << OP_0 << std::vector<unsigned char>(20, 0x14));
+    if (payload_size > 0) AddSegopPayload(mtx, BuildSegopTextTlv(std::string(payload_size, 'x')));
+    return mtx;
+}
+
+void DeserializeTx(benchmark::Bench& bench, size_t payload_size)
+{
+    DataStream stream;
+    stream << TX_WITH_WITNESS(MakeBenchTx(payload_size));
+    const size_t tx_size{stream.size()};
+    std::byte a{0};
+    stream.write({&a, 1}); // Prevent compaction
+
+    bench.unit("tx").run([&] {
+        // Includes computing txid, wtxid and fullxid
+        CTransactionRef tx;
+        stream >> TX_WITH_WITNESS(tx);
+        bool rewound = stream.Rewind(tx_size);
+        assert(rewound);
+    });
+}
+
+//! What decoderawtransaction and sendrawtransaction do with their hex argument.
+void DecodeHex(benchmark::Bench& bench, size_t payload_size)
+{
+    const std::string hex{EncodeHexTx(CTransaction{MakeBenchTx(payload_size)})};
+    bench.unit("tx").run([&] {
+        CMutableTransaction mtx;
+        bool decoded = DecodeHexTx(mtx, hex, /*try_no_witness=*/true, /*try_witness=*/true);
+        assert(decoded);
+    });
+}
+
+//! A block of segOP transactions of about 4MB, all with `payload_size` byte payloads.
+CBlock MakeBenchBlock(size_t payload_size, size_t count = 0)
+{
+    if (count == 0) count = std::min<size_t>(4'000'000 / (payload_size + 200), 2000);
+    CBlock block;
+    for (size_t i = 0; i < count; ++i) {
+        CMutableTransaction mtx{MakeBenchTx(payload_size)};
+        mtx.vin[0].prevout.n = i;
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+    return block;
+}
+
+//! A BUDS-labelled (tier and data type) text payload of `payload_size` text bytes.
+std::vector<unsigned char> MakeBUDSPayload(size_t payload_size)
+{
+    return BuildSegopBUDSTextPayload(0x10, 0x01, std::string(payload_size, 'x'));
+}
+
+void ValidateTLV(benchmark::Bench& bench, size_t payload_size)
+{
+    const auto payload{MakeBUDSPayload(payload_size)};
+    bench.unit("payload").run([&] {
+        bool valid = SegopIsValidTLV(payload);
+        assert(valid);
+    });
+}
+
+void ExtractBUDS(benchmark::Bench& bench, size_t payload_size)
+{
+    const auto payload{MakeBUDSPayload(payload_size)};
+    bench.unit("payload").run([&] {
+        const SegopBUDSInfo info{SegopExtractBUDSInfo(payload)};
+        assert(info.has_tier);
+        ankerl::nanobench::doNotOptimizeAway(info);
+    });
+}
+
+void Commitment(benchmark::Bench& bench, size_t payload_size)
+{
+    const auto payload{BuildSegopTextTlv(std::string(payload_size, 'x'))};
+    bench.unit("payload").run([&] {
+        ankerl::nanobench::doNotOptimizeAway(SegopCommitment(payload));
+    });
+}
+
+//! Computes txid, wtxid and fullxid, and copies the payload reference.
+void ConstructTx(benchmark::Bench& bench, size_t payload_size)
+{
+    const CMutableTransaction mtx{MakeBenchTx(payload_size)};
+    bench.unit("tx").run([&] {
+        const CTransaction tx{mtx};
+        ankerl::nanobench::doNotOptimizeAway(tx.GetWitnessHash());
+    });
+}
+
+void CheckTx(benchmark::Bench& bench, size_t payload_size)
+{
+    const CTransaction tx{MakeBenchTx(payload_size)};
+    bench.unit("tx").run([&] {
+        TxValidationState state;
+        bool checked = CheckTransaction(tx, state);
+        assert(checked);
+    });
+}
+
+void SerializeBlock(benchmark::Bench& bench, size_t payload_size)
+{
+    const CBlock block{MakeBenchBlock(payload_size)};
+    DataStream stream;
+    bench.unit("block").run([&] {
+        stream.clear();
+        stream << TX_WITH_WITNESS(block);
+    });
+}
+
+void DeserializeBlock(benchmark::Bench& bench, size_t payload_size, size_t count = 0)
+{
+    DataStream stream;
+    stream << TX_WITH_WITNESS(MakeBenchBlock(payload_size, count));
+    const size_t block_size{stream.size()};
+    std::byte a{0};
+    stream.write({&a, 1}); // Prevent compaction
+
+    bench.unit("block").run([&] {
+        CBlock decoded;
+        stream >> TX_WITH_WITNESS(decoded);
+        bool rewound = stream.Rewind(block_size);
+        assert(rewound);
+    });
+}
+
+//! What getrawtransaction and getblock do at verbosity 2, payload decoding included.
+void EncodeJson(benchmark::Bench& bench, size_t payload_size)
+{
+    // Output scripts are decoded to addresses, which needs chain params.
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    const CTransaction tx{MakeBenchTx(payload_size)};
+    bench.unit("tx").run([&] {
+        UniValue entry(UniValue::VOBJ);
+        TxToUniv(tx, /*block_hash=*/uint256{}, entry);
+        ankerl::nanobench::doNotOptimizeAway(entry);
+    });
+}
+
+//! The payloads of a block of `count` segOP transactions with `payload_size` byte payloads.
+std::vector<std::vector<unsigned char>> MakeBlockPayloads(size_t count, size_t payload_size)
+{
+    std::vector<std::vector<unsigned char>> payloads;
+    for (size_t i = 0; i < count; ++i) {
+        payloads.push_back(BuildSegopTextTlv(std::string(payload_size, 'a' + i % 26)));
+    }
+    return payloads;
+}
+
+} // namespace
+
+// Block-level commitment hashing, one payload at a time versus in parallel
+// SHA256 lanes (what MakeTransactionRefs does for a block).
+static void SegopCommitmentSerial(benchmark::Bench& bench)
+{
+    const auto payloads{MakeBlockPayloads(64, 16'000)};
+    bench.batch(payloads.size()).unit("payload").run([&] {
+        for (const auto& payload : payloads) {
+            ankerl::nanobench::doNotOptimizeAway(SegopCommitment(payload));
+        }
+    });
+}
+
+static void SegopCommitmentMultiBuffer(benchmark::Bench& bench)
+{
+    const auto payloads{MakeBlockPayloads(64, 16'000)};
+    const std::vector<std::span<const unsigned char>> spans(payloads.begin(), payloads.end());
+    bench.batch(payloads.size()).unit("payload").run([&] {
+        std::vector<HashWriter> writers(payloads.size(), SegopCommitmentWriter());
+        HashWriter::WriteMulti(writers, spans);
+        for (auto& writer : writers) {
+            ankerl::nanobench::doNotOptimizeAway(writer.GetHash());
+        }
+    });
+}
+
+static void SegopDeserializeBlock(benchmark::Bench& bench) { DeserializeBlock(bench, 16'000, 64); }
+
+static void SegopDeserializeTxNoPayload(benchmark::Bench& bench) { DeserializeTx(bench, 0); }
+static void SegopDeserializeTx16B(benchmark::Bench& bench) { DeserializeTx(bench, PAYLOAD_16B); }
+static void SegopDeserializeTx1KB(benchmark::Bench& bench) { DeserializeTx(bench, PAYLOAD_1KB); }
+static void SegopDeserializeTx64KB(benchmark::Bench& bench) { DeserializeTx(bench, PAYLOAD_64KB); }
+static void SegopDecodeHexTxNoPayload(benchmark::Bench& bench) { DecodeHex(bench, 0); }
+static void SegopDecodeHexTx1KB(benchmark::Bench& bench) { DecodeHex(bench, PAYLOAD_1KB); }
+static void SegopDecodeHexTx64KB(benchmark::Bench& bench) { DecodeHex(bench, PAYLOAD_64KB); }
+static void SegopValidateTLV16B(benchmark::Bench& bench) { ValidateTLV(bench, PAYLOAD_16B); }
+static void SegopValidateTLV1KB(benchmark::Bench& bench) { ValidateTLV(bench, PAYLOAD_1KB); }
+static void SegopValidateTLV64KB(benchmark::Bench& bench) { ValidateTLV(bench, PAYLOAD_64KB); }
+static void SegopExtractBUDS16B(benchmark::Bench& bench) { ExtractBUDS(bench, PAYLOAD_16B); }
+static void SegopExtractBUDS1KB(benchmark::Bench& bench) { ExtractBUDS(bench, PAYLOAD_1KB); }
+static void SegopExtractBUDS64KB(benchmark::Bench& bench) { ExtractBUDS(bench, PAYLOAD_64KB); }
+static void SegopCommitment16B(benchmark::Bench& bench) { Commitment(bench, PAYLOAD_16B); }
+static void SegopCommitment1KB(benchmark::Bench& bench) { Commitment(bench, PAYLOAD_1KB); }
+static void SegopCommitment64KB(benchmark::Bench& bench) { Commitment(bench, PAYLOAD_64KB); }
+static void SegopConstructTx16B(benchmark::Bench& bench) { ConstructTx(bench, PAYLOAD_16B); }
+static void SegopConstructTx1KB(benchmark::Bench& bench) { ConstructTx(bench, PAYLOAD_1KB); }
+static void SegopConstructTx64KB(benchmark::Bench& bench) { ConstructTx(bench, PAYLOAD_64KB); }
+static void SegopCheckTx16B(benchmark::Bench& bench) { CheckTx(bench, PAYLOAD_16B); }
+static void SegopCheckTx1KB(benchmark::Bench& bench) { CheckTx(bench, PAYLOAD_1KB); }
+static void SegopCheckTx64KB(benchmark::Bench& bench) { CheckTx(bench, PAYLOAD_64KB); }
+static void SegopSerializeBlock16B(benchmark::Bench& bench) { SerializeBlock(bench, PAYLOAD_16B); }
+static void SegopSerializeBlock1KB(benchmark::Bench& bench) { SerializeBlock(bench, PAYLOAD_1KB); }
+static void SegopSerializeBlock64KB(benchmark::Bench& bench) { SerializeBlock(bench, PAYLOAD_64KB); }
+static void SegopDeserializeBlock16B(benchmark::Bench& bench) { DeserializeBlock(bench, PAYLOAD_16B); }
+static void SegopDeserializeBlock1KB(benchmark::Bench& bench) { DeserializeBlock(bench, PAYLOAD_1KB); }
+static void SegopDeserializeBlock64KB(benchmark::Bench& bench) { DeserializeBlock(bench, PAYLOAD_64KB); }
+static void SegopTxToUniv16B(benchmark::Bench& bench) { EncodeJson(bench, PAYLOAD_16B); }
+static void SegopTxToUniv1KB(benchmark::Bench& bench) { EncodeJson(bench, PAYLOAD_1KB); }
+static void SegopTxToUniv64KB(benchmark::Bench& bench) { EncodeJson(bench, PAYLOAD_64KB); }
+
+BENCHMARK(SegopDeserializeTxNoPayload, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDeserializeTx16B, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDeserializeTx1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDeserializeTx64KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDecodeHexTxNoPayload, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDecodeHexTx1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDecodeHexTx64KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopCommitmentSerial, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopCommitmentMultiBuffer, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDeserializeBlock, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopValidateTLV16B, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopValidateTLV1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopValidateTLV64KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopExtractBUDS16B, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopExtractBUDS1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopExtractBUDS64KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopCommitment16B, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopCommitment1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopCommitment64KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopConstructTx16B, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopConstructTx1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopConstructTx64KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopCheckTx16B, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopCheckTx1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopCheckTx64KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopSerializeBlock16B, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopSerializeBlock1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopSerializeBlock64KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDeserializeBlock16B, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDeserializeBlock1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopDeserializeBlock64KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopTxToUniv16B, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopTxToUniv1KB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SegopTxToUniv64KB, benchmark::PriorityLevel::HIGH);
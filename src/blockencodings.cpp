@@ -11,18 +11,24 @@
 #include <crypto/siphash.h>
 #include <logging.h>
 #include <random.h>
+#include <segop/segop_store.h>
 #include <streams.h>
 #include <txmempool.h>
 #include <validation.h>
 
 #include <unordered_map>
 
-CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce) :
+CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce, bool strip_segop) :
         nonce(nonce),
         shorttxids(block.vtx.size() - 1), prefilledtxn(1), header(block) {
     FillShortTxIDSelector();
     //TODO: Use our mempool prior to block acceptance to predictively fill more than just the coinbase
     prefilledtxn[0] = {0, block.vtx[0]};
+    if (strip_segop && !block.vtx[0]->segop_payload.IsNull()) {
+        CMutableTransaction stripped{*block.vtx[0]};
+        stripped.segop_payload.SetNull();
+        prefilledtxn[0].tx = MakeTransactionRef(std::move(stripped));
+    }
     for (size_t i = 1; i < block.vtx.size(); i++) {
         const CTransaction& tx = *block.vtx[i];
         shorttxids[i - 1] = GetShortID(tx.GetWitnessHash());
@@ -114,6 +120,18 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     std::vector<bool> have_txn(txn_available.size());
     {
     LOCK(pool->cs);
+    // Prefilled transactions arrive without their segOP payload. Take the
+    // full transaction from the mempool where we have it; the rest are
+    // fetched with getsegopdata once the block is filled.
+    for (size_t i = 0; i < txn_available.size(); i++) {
+        if (!txn_available[i] || !segop::IsPayloadStripped(*txn_available[i])) continue;
+        if (const auto it{pool->GetIter(txn_available[i]->GetHash())}) {
+            if ((*it)->GetTx().GetWitnessHash() == txn_available[i]->GetWitnessHash()) {
+                txn_available[i] = (*it)->GetSharedTx();
+                segop_mempool_count++;
+            }
+        }
+    }
     for (const auto& [wtxid, txit] : pool->txns_randomized) {
         uint64_t shortid = cmpctblock.GetShortID(wtxid);
         std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
@@ -218,7 +236,7 @@ ReadStatus PartiallyDownloadedBlock::FillBlock(CBlock& block, const std::vector<
         return READ_STATUS_FAILED; // Possible Short ID collision
     }
 
-    LogDebug(BCLog::CMPCTBLOCK, "Successfully reconstructed block %s with %u txn prefilled, %u txn from mempool (incl at least %u from extra pool) and %u txn (%u bytes) requested\n", hash.ToString(), prefilled_count, mempool_count, extra_count, vtx_missing.size(), tx_missing_size);
+    LogDebug(BCLog::CMPCTBLOCK, "Successfully reconstructed block %s with %u txn prefilled (%u segOP payloads from mempool), %u txn from mempool (incl at least %u from extra pool) and %u txn (%u bytes) requested\n", hash.ToString(), prefilled_count, segop_mempool_count, mempool_count, extra_count, vtx_missing.size(), tx_missing_size);
     if (vtx_missing.size() < 5) {
         for (const auto& tx : vtx_missing) {
             LogDebug(BCLog::CMPCTBLOCK, "Reconstructed block %s required tx %s\n", hash.ToString(), tx->GetHash().ToString());
@@ -111,8 +111,11 @@ public:
 
     /**
      * @param[in]  nonce  This should be randomly generated, and is used for the siphash secret key
+     * @param[in]  strip_segop  Prefill transactions without their segOP payloads (segOP spec
+     *                          §11.6.2); the P2SOP output still identifies each payload and its
+     *                          commitment. Only for peers that can fetch them (see net_processing).
      */
-    CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce);
+    CBlockHeaderAndShortTxIDs(const CBlock& block, const uint64_t nonce, bool strip_segop = false);
 
     uint64_t GetShortID(const Wtxid& wtxid) const;
 
@@ -133,7 +136,7 @@ public:
 class PartiallyDownloadedBlock {
 protected:
     std::vector<CTransactionRef> txn_available;
-    size_t prefilled_count = 0, mempool_count = 0, extra_count = 0;
+    size_t prefilled_count = 0, mempool_count = 0, extra_count = 0, segop_mempool_count = 0;
     const CTxMemPool* pool;
 public:
     CBlockHeader header;
@@ -147,7 +150,9 @@ public:
     // extra_txn is a list of extra transactions to look at, in <witness hash, reference> form
     ReadStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<Wtxid, CTransactionRef>>& extra_txn);
     bool IsTxAvailable(size_t index) const;
-    // segwit_active enforces witness mutation checks just before reporting a healthy status
+    // segwit_active enforces witness mutation checks just before reporting a healthy status.
+    // Prefilled segOP transactions whose payload was not found in the mempool are left
+    // stripped; see segop::GetStrippedPayloads().
     ReadStatus FillBlock(CBlock& block, const std::vector<CTransactionRef>& vtx_missing, bool segwit_active);
 };
 
@@ -14,7 +14,7 @@
 #include <algorithm>
 #include <set>
 
-// segOP helpers (CSegopPayload, SegopIsValidTLV, BuildSegopCommitmentBlob)
+// segOP helpers (CSegopPayload, SegopIsValidTLV, SegopIsP2SOPScript)
 #include <segop/segop.h>
 
 /**
@@ -43,126 +43,97 @@
 // Helpers for detecting and matching P2SOP outputs
 // -----------------------------------------------------------------------------
 
+namespace {
+struct P2SOPOutputs {
+    int count{0};    //!< P2SOP-looking outputs
+    int matching{0}; //!< ... of which are canonical and carry the expected commitment
+};
+} // namespace
+
 /**
- * Return true if the given scriptPubKey looks like *any* P2SOP output
- * (regardless of which commitment it carries).
+ * Scan the outputs once for P2SOP-looking scripts, and match each against the
+ * commitment cached on the transaction (CTransaction::GetSegopCommitment()).
+ * The 32 commitment bytes are compared in place in the script:
  *
- * Format we match:
- *      OP_RETURN <push_len> "P2SOP" ...
- * where:
- *      - push_len >= 5 (enough to hold "P2SOP")
+ *   OP_RETURN <0x25> "P2SOP" <commitment>
  */
-static bool ScriptHasP2SOPPrefix(const CScript& script)
+static P2SOPOutputs CountP2SOPOutputs(const CTransaction& tx)
 {
-    // Need: OP_RETURN + 1-byte push opcode + at least 5 bytes of data.
-    if (script.size() < 1 + 1 + 5) return false;
-
-    if (script[0] != OP_RETURN) return false;
-    const unsigned char push_len = static_cast<unsigned char>(script[1]);
-
-    // Need at least 5 bytes of pushed data for "P2SOP".
-    if (push_len < 5) return false;
+    static constexpr size_t BLOB_SIZE{5 + uint256::size()};
+    const uint256& commitment{tx.GetSegopCommitment()};
 
-    // script layout: [0] = OP_RETURN
-    //                [1] = push_len
-    //                [2..] = data bytes
-    // We only check the first 5 data bytes for the ASCII tag.
-    if (script[2] != 'P') return false;
-    if (script[3] != '2') return false;
-    if (script[4] != 'S') return false;
-    if (script[5] != 'O') return false;
-    if (script[6] != 'P') return false;
+    P2SOPOutputs outputs;
+    for (const auto& txout : tx.vout) {
+        const CScript& script = txout.scriptPubKey;
 
-    return true;
-}
+        // Quickly skip anything that doesn't look like P2SOP at all.
+        if (!SegopIsP2SOPScript(script)) {
+            continue;
+        }
+        ++outputs.count;
 
-/** Return true if the transaction has *any* P2SOP-looking output. */
-static bool TxHasAnyP2SOP(const CTransaction& tx)
-{
-    for (const auto& txout : tx.vout) {
-        if (ScriptHasP2SOPPrefix(txout.scriptPubKey)) {
-            return true;
+        // Any other length, or a different commitment, is a mismatch.
+        if (script.size() == 2 + BLOB_SIZE && script[1] == BLOB_SIZE &&
+            std::equal(commitment.begin(), commitment.end(), script.begin() + 2 + 5)) {
+            ++outputs.matching;
         }
     }
-    return false;
+    return outputs;
 }
 
+// -----------------------------------------------------------------------------
+// Main structural transaction checks (with segOP rules)
+// -----------------------------------------------------------------------------
+
 /**
- * Check that the transaction has *exactly one* P2SOP output whose data bytes
- * match the expected P2SOP blob exactly:
- *
- *   expected_blob = "P2SOP" || TAGGED_HASH("segop:commitment", payload)
- *
- * The script must be:
- *
- *   OP_RETURN <len = expected_blob.size()> <expected_blob bytes...>
- *
- * Returns true iff:
- *   - there is at least one P2SOP-looking output, and
- *   - exactly one of them has data == expected_blob, and
- *   - there are no *other* P2SOP-looking outputs with different data.
+ * segOP rules of CheckTransaction(): payload version, size, TLV structure and
+ * the 1:1 coupling with a P2SOP output; or no P2SOP output without a payload.
  */
-static bool TxHasExactlyOneMatchingP2SOP(const CTransaction& tx,
-                                         const std::vector<unsigned char>& expected_blob)
+bool CheckSegopPayload(const CTransaction& tx, TxValidationState& state)
 {
-    if (expected_blob.size() < 5) {
-        // Should never happen; "P2SOP" alone is 5 bytes.
-        return false;
-    }
-
-    int match_count = 0;
+    const bool has_segop = !tx.segop_payload.IsNull();
 
-    for (const auto& txout : tx.vout) {
-        const CScript& script = txout.scriptPubKey;
+    if (has_segop) {
+        // ---------------------------------------------------------------------
+        // segOP present: enforce payload version, size, TLV structure, and 1:1 coupling.
+        // ---------------------------------------------------------------------
 
-        // Quickly skip anything that doesn't look like P2SOP at all.
-        if (!ScriptHasP2SOPPrefix(script)) {
-            continue;
+        // Version enforcement (segOP v1 only for now).
+        if (tx.segop_payload.version != CSegopPayload::SEGOP_VERSION) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-segop-version");
         }
 
-        // script layout: [0] = OP_RETURN
-        //                [1] = push_len
-        //                [2..] = data bytes ("P2SOP" || commitment)
-        const unsigned char push_len = static_cast<unsigned char>(script[1]);
-
-        // Data length must match expected_blob size.
-        if (push_len != expected_blob.size()) {
-            // P2SOP-looking output with different length: forbidden.
-            return false;
+        // Size cap (from segop.h / spec).
+        if (tx.segop_payload.TooLarge()) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-segop-toolarge");
         }
 
-        if (script.size() != 1 + 1 + expected_blob.size()) {
-            // Malformed script relative to push_len.
-            return false;
+        // TLV well-formedness: [type(1)][len(varint)][value(len)] repeated; exact end.
+        if (!SegopIsValidTLV(tx.segop_payload.data)) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-segop-tlv");
         }
 
-        // Compare data bytes directly with expected_blob.
-        const bool equal = std::equal(
-            expected_blob.begin(),
-            expected_blob.end(),
-            script.begin() + 2
-        );
-
-        if (!equal) {
-            // P2SOP-looking output, but wrong commitment.
-            return false;
+        // Exactly one P2SOP output, committing to the payload:
+        //   P2SOP_blob = "P2SOP" || TAGGED_HASH("segop:commitment", segop_payload_bytes)
+        //
+        // The commitment was computed once when the transaction was built.
+        const P2SOPOutputs p2sop{CountP2SOPOutputs(tx)};
+        if (p2sop.count != 1 || p2sop.matching != 1) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-segop-no-p2sop");
         }
-
-        // Found one correct P2SOP.
-        match_count++;
-        if (match_count > 1) {
-            // More than one P2SOP with the correct blob is not allowed.
-            return false;
+    } else {
+        // ---------------------------------------------------------------------
+        // No segOP payload: P2SOP must not be present at all.
+        // ---------------------------------------------------------------------
+        if (CountP2SOPOutputs(tx).count != 0) {
+            return state.Invalid(TxValidationResult::TX_CONSENSUS,
+                                 "bad-txns-segop-p2sop-without-segop");
         }
     }
 
-    return match_count == 1;
+    return true;
 }
 
-// -----------------------------------------------------------------------------
-// Main structural transaction checks (with segOP rules)
-// -----------------------------------------------------------------------------
-
 /**
  * Check basic structural properties of a transaction that do not depend on the
  * UTXO set or chain state.
@@ -176,8 +147,10 @@ static bool TxHasExactlyOneMatchingP2SOP(const CTransaction& tx,
  *
  *   - if NO segOP payload is present:
  *       * there must be NO P2SOP outputs at all.
+ *
+ * With segop_checked set, the segOP rules (CheckSegopPayload) are skipped.
  */
-bool CheckTransaction(const CTransaction& tx, TxValidationState& state)
+bool CheckTransaction(const CTransaction& tx, TxValidationState& state, bool segop_checked)
 {
     // Basic checks that don't depend on any context
     if (tx.vin.empty()) {
@@ -197,47 +170,8 @@ bool CheckTransaction(const CTransaction& tx, TxValidationState& state)
         return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-oversize");
     }
 
-    const bool has_segop = !tx.segop_payload.IsNull();
-
-    if (has_segop) {
-        // ---------------------------------------------------------------------
-        // segOP present: enforce payload version, size, TLV structure, and 1:1 coupling.
-        // ---------------------------------------------------------------------
-
-        // Version enforcement (segOP v1 only for now).
-        if (tx.segop_payload.version != CSegopPayload::SEGOP_VERSION) {
-            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-segop-version");
-        }
-
-        // Size cap (from segop.h / spec).
-        if (tx.segop_payload.TooLarge()) {
-            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-segop-toolarge");
-        }
-
-        // TLV well-formedness: [type(1)][len(varint)][value(len)] repeated; exact end.
-        if (!SegopIsValidTLV(tx.segop_payload.data)) {
-            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-segop-tlv");
-        }
-
-        // Build the expected P2SOP blob according to the spec:
-        //   P2SOP_blob = "P2SOP" || TAGGED_HASH("segop:commitment", segop_payload_bytes)
-        //
-        // segop_payload_bytes here are exactly tx.segop_payload.data (TLV bytes),
-        // not including marker or version.
-        const std::vector<unsigned char> expected_p2sop_blob =
-            BuildSegopCommitmentBlob(tx.segop_payload.data);
-
-        if (!TxHasExactlyOneMatchingP2SOP(tx, expected_p2sop_blob)) {
-            return state.Invalid(TxValidationResult::TX_CONSENSUS, "bad-txns-segop-no-p2sop");
-        }
-    } else {
-        // ---------------------------------------------------------------------
-        // No segOP payload: P2SOP must not be present at all.
-        // ---------------------------------------------------------------------
-        if (TxHasAnyP2SOP(tx)) {
-            return state.Invalid(TxValidationResult::TX_CONSENSUS,
-                                 "bad-txns-segop-p2sop-without-segop");
-        }
+    if (!segop_checked && !CheckSegopPayload(tx, state)) {
+        return false; // state filled in by CheckSegopPayload
     }
 
     // Check for negative or overflow output values (same style as upstream).
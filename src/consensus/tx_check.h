@@ -15,6 +15,15 @@
 class CTransaction;
 class TxValidationState;
 
-bool CheckTransaction(const CTransaction& tx, TxValidationState& state);
+/**
+ * Context-free transaction checks, including the segOP payload rules. Pass
+ * segop_checked when this exact transaction (same fullxid) is already known
+ * to satisfy the segOP rules, e.g. from ValidationCache::m_segop_check_cache,
+ * or when they are run separately with CheckSegopPayload.
+ */
+bool CheckTransaction(const CTransaction& tx, TxValidationState& state, bool segop_checked = false);
+
+/** The segOP payload and P2SOP output rules of CheckTransaction on their own. */
+bool CheckSegopPayload(const CTransaction& tx, TxValidationState& state);
 
 #endif // BITCOIN_CONSENSUS_TX_CHECK_H
@@ -14,6 +14,7 @@
 #include <util/strencodings.h>
 
 #include <algorithm>
+#include <span>
 #include <string>
 
 using util::SplitString;
@@ -122,16 +123,15 @@ static bool CheckTxScriptsSanity(const CMutableTransaction& tx)
     return true;
 }
 
-static bool DecodeTx(CMutableTransaction& tx, const std::vector<unsigned char>& tx_data, bool try_no_witness, bool try_witness)
+static bool DecodeTx(CMutableTransaction& tx, std::span<const unsigned char> tx_data, bool try_no_witness, bool try_witness)
 {
     // General strategy:
     // - Decode both with extended serialization (which interprets the 0x0001 tag as a marker for
-    //   the presence of witnesses) and with legacy serialization (which interprets the tag as a
-    //   0-input 1-output incomplete transaction).
+    //   the presence of witnesses, and flag bit 0x02 as a marker for a segOP payload) and with
+    //   legacy serialization (which interprets the tag as a 0-input 1-output incomplete transaction).
     //   - Restricted by try_no_witness (which disables legacy if false) and try_witness (which
     //     disables extended if false).
-    //   - Ignore serializations that do not fully consume the hex string, *except* that for the
-    //     extended form we allow a trailing segOP payload and attempt to parse it.
+    //   - Ignore serializations that do not fully consume the hex string.
     // - If neither succeeds, fail.
     // - If only one succeeds, return that one.
     // - If both decode attempts succeed:
@@ -142,33 +142,12 @@ static bool DecodeTx(CMutableTransaction& tx, const std::vector<unsigned char>&
     bool ok_extended = false, ok_legacy = false;
 
     // Try decoding with extended serialization support, and remember if the result successfully
-    // consumes the entire input. With segOP support, we additionally allow a trailing segOP
-    // payload after the witness data and try to parse it into tx_extended.segop_payload.
+    // consumes the entire input. The segOP section is read in the same pass.
     if (try_witness) {
-        DataStream ssData(tx_data);
+        SpanReader reader{tx_data};
         try {
-            ssData >> TX_WITH_WITNESS(tx_extended);
-
-            if (ssData.empty()) {
-                // Normal (non-segOP) extended transaction: everything consumed.
-                ok_extended = true;
-            } else {
-                // segOP-aware decode: if there are trailing bytes, try to interpret them
-                // as a CSegopPayload. Only treat this as successful if that parse consumes
-                // *all* remaining bytes.
-                try {
-                    CSegopPayload segop;
-                    ssData >> segop;
-
-                    if (ssData.empty()) {
-                        tx_extended.segop_payload = std::move(segop);
-                        ok_extended = true;
-                    }
-                } catch (const std::exception&) {
-                    // Trailing bytes were not a valid segOP payload; fall through and
-                    // treat extended decoding as failed.
-                }
-            }
+            reader >> TX_WITH_WITNESS(tx_extended);
+            if (reader.empty()) ok_extended = true;
         } catch (const std::exception&) {
             // Fall through.
         }
@@ -183,10 +162,10 @@ static bool DecodeTx(CMutableTransaction& tx, const std::vector<unsigned char>&
 
     // Try decoding with legacy serialization, and remember if the result successfully consumes the entire input.
     if (try_no_witness) {
-        DataStream ssData(tx_data);
+        SpanReader reader{tx_data};
         try {
-            ssData >> TX_NO_WITNESS(tx_legacy);
-            if (ssData.empty()) ok_legacy = true;
+            reader >> TX_NO_WITNESS(tx_legacy);
+            if (reader.empty()) ok_legacy = true;
         } catch (const std::exception&) {
             // Fall through.
         }
@@ -8,6 +8,8 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <utility>
+#include <vector>
 
 #if !defined(DISABLE_OPTIMIZED_SHA256)
 #include <compat/cpuid.h>
@@ -34,6 +36,11 @@ namespace sha256d64_sse41
 void Transform_4way(unsigned char* out, const unsigned char* in);
 }
 
+namespace sha256_avx2
+{
+void TransformMulti_8way(uint32_t* const s[8], const unsigned char* const chunk[8]);
+}
+
 namespace sha256d64_avx2
 {
 void Transform_8way(unsigned char* out, const unsigned char* in);
@@ -47,6 +54,7 @@ void Transform_2way(unsigned char* out, const unsigned char* in);
 namespace sha256_x86_shani
 {
 void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
+void TransformMulti_2way(uint32_t* const s[2], const unsigned char* const chunk[2]);
 }
 
 namespace sha256_arm_shani
@@ -437,6 +445,7 @@ void TransformD64(unsigned char* out, const unsigned char* in)
 
 typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
 typedef void (*TransformD64Type)(unsigned char*, const unsigned char*);
+typedef void (*TransformMultiType)(uint32_t* const*, const unsigned char* const*);
 
 template<TransformType tr>
 void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
@@ -482,6 +491,8 @@ TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformMultiType TransformMulti_2way = nullptr;
+TransformMultiType TransformMulti_8way = nullptr;
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -565,6 +576,24 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test TransformMulti_2way and TransformMulti_8way, if available: lane i
+    // continues from the state after i blocks with block i.
+    for (auto [tr, lanes] : {std::pair{TransformMulti_2way, size_t{2}}, std::pair{TransformMulti_8way, size_t{8}}}) {
+        if (!tr) continue;
+        uint32_t states[8][8];
+        uint32_t* state_ptrs[8];
+        const unsigned char* chunks[8];
+        for (size_t i = 0; i < lanes; ++i) {
+            std::copy(result[i], result[i] + 8, states[i]);
+            state_ptrs[i] = states[i];
+            chunks[i] = data + 1 + 64 * i;
+        }
+        tr(state_ptrs, chunks);
+        for (size_t i = 0; i < lanes; ++i) {
+            if (!std::equal(states[i], states[i] + 8, result[i + 1])) return false;
+        }
+    }
+
     return true;
 }
 
@@ -590,6 +619,8 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
     TransformD64_2way = nullptr;
     TransformD64_4way = nullptr;
     TransformD64_8way = nullptr;
+    TransformMulti_2way = nullptr;
+    TransformMulti_8way = nullptr;
 
 #if !defined(DISABLE_OPTIMIZED_SHA256)
 #if defined(HAVE_GETCPUID)
@@ -625,6 +656,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
         Transform = sha256_x86_shani::Transform;
         TransformD64 = TransformD64Wrapper<sha256_x86_shani::Transform>;
         TransformD64_2way = sha256d64_x86_shani::Transform_2way;
+        TransformMulti_2way = sha256_x86_shani::TransformMulti_2way;
         ret = "x86_shani(1way;2way)";
         have_sse4 = false; // Disable SSE4/AVX2;
         have_avx2 = false;
@@ -646,6 +678,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
 #if defined(ENABLE_AVX2)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformMulti_8way = sha256_avx2::TransformMulti_8way;
         ret += ";avx2(8way)";
     }
 #endif
@@ -779,3 +812,94 @@ void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
         --blocks;
     }
 }
+
+namespace {
+/** A run of whole blocks still to be compressed into a hasher's state. */
+struct MultiLane {
+    uint32_t* state;
+    const unsigned char* data;
+    size_t blocks;
+};
+
+/** Compress the runs `N` at a time, refilling a lane as soon as its run ends,
+ *  for as long as at least `min_active` lanes are busy. Returns the runs that
+ *  are left over, partially or not at all done. */
+template <size_t N>
+std::vector<MultiLane> RunLanes(TransformMultiType tr, std::vector<MultiLane> runs, size_t min_active)
+{
+    // Idle lanes compress a dummy block into a scratch state.
+    static const unsigned char idle_data[64]{};
+    uint32_t idle_state[N][8]{};
+
+    MultiLane lanes[N];
+    uint32_t* states[N];
+    const unsigned char* chunks[N];
+    size_t next{0}, active{0};
+    for (size_t i = 0; i < N; ++i) {
+        lanes[i] = next < runs.size() ? runs[next++] : MultiLane{idle_state[i], idle_data, 0};
+        if (lanes[i].blocks) ++active;
+    }
+    while (active >= min_active) {
+        for (size_t i = 0; i < N; ++i) {
+            states[i] = lanes[i].state;
+            chunks[i] = lanes[i].data;
+        }
+        tr(states, chunks);
+        for (size_t i = 0; i < N; ++i) {
+            if (!lanes[i].blocks) continue;
+            lanes[i].data += 64;
+            if (--lanes[i].blocks == 0) {
+                if (next < runs.size()) {
+                    lanes[i] = runs[next++];
+                } else {
+                    lanes[i] = MultiLane{idle_state[i], idle_data, 0};
+                    --active;
+                }
+            }
+        }
+    }
+
+    std::vector<MultiLane> left;
+    for (const MultiLane& lane : lanes) {
+        if (lane.blocks) left.push_back(lane);
+    }
+    left.insert(left.end(), runs.begin() + next, runs.end());
+    return left;
+}
+} // namespace
+
+void SHA256WriteMulti(CSHA256* const* hashers, const unsigned char* const* data, const size_t* lengths, size_t count)
+{
+    std::vector<MultiLane> runs;
+    runs.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        CSHA256& hasher = *hashers[i];
+        const unsigned char* ptr = data[i];
+        size_t len = lengths[i];
+        // Top up a partially filled buffer first, so the rest is block aligned.
+        if (size_t bufsize = hasher.bytes % 64) {
+            const size_t head = std::min(len, 64 - bufsize);
+            hasher.Write(ptr, head);
+            ptr += head;
+            len -= head;
+        }
+        // Buffering the tail only touches buf, which is free again once the
+        // (now empty) buffer's blocks are accounted for below.
+        if (const size_t blocks = len / 64) {
+            runs.push_back({hasher.s, ptr, blocks});
+            hasher.bytes += 64 * blocks;
+        }
+        hasher.Write(ptr + len / 64 * 64, len % 64);
+    }
+
+    // Below those occupancies the parallel kernels are no faster than one
+    // lane of the regular Transform.
+    if (TransformMulti_8way) {
+        runs = RunLanes<8>(TransformMulti_8way, std::move(runs), /*min_active=*/3);
+    } else if (TransformMulti_2way) {
+        runs = RunLanes<2>(TransformMulti_2way, std::move(runs), /*min_active=*/2);
+    }
+    for (const MultiLane& run : runs) {
+        Transform(run.state, run.data, run.blocks);
+    }
+}
@@ -17,6 +17,8 @@ private:
     unsigned char buf[64];
     uint64_t bytes{0};
 
+    friend void SHA256WriteMulti(CSHA256* const* hashers, const unsigned char* const* data, const size_t* lengths, size_t count);
+
 public:
     static const size_t OUTPUT_SIZE = 32;
 
@@ -50,4 +52,13 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** Write several messages into as many SHA256 hashers at once.
+ *  Equivalent to hashers[i]->Write(data[i], lengths[i]) for each i < count
+ *  (the hashers must be distinct objects),
+ *  but the full 64-byte blocks of different messages are compressed side by
+ *  side where the CPU allows (8 lanes with AVX2, 2 with x86 SHA-NI). This
+ *  pays off for batches of messages of a kilobyte or more.
+ */
+void SHA256WriteMulti(CSHA256* const* hashers, const unsigned char* const* data, const size_t* lengths, size_t count);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
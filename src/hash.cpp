@@ -8,7 +8,9 @@
 #include <crypto/hmac_sha512.h>
 
 #include <bit>
+#include <cassert>
 #include <string>
+#include <vector>
 
 unsigned int MurmurHash3(unsigned int nHashSeed, std::span<const unsigned char> vDataToHash)
 {
@@ -75,6 +77,23 @@ void BIP32Hash(const ChainCode &chainCode, unsigned int nChild, unsigned char he
     CHMAC_SHA512(chainCode.begin(), chainCode.size()).Write(&header, 1).Write(data, 32).Write(num, 4).Finalize(output);
 }
 
+void HashWriter::WriteMulti(std::span<HashWriter> writers, std::span<const std::span<const unsigned char>> data)
+{
+    assert(writers.size() == data.size());
+    std::vector<CSHA256*> hashers;
+    std::vector<const unsigned char*> ptrs;
+    std::vector<size_t> lengths;
+    hashers.reserve(writers.size());
+    ptrs.reserve(writers.size());
+    lengths.reserve(writers.size());
+    for (size_t i{0}; i < writers.size(); ++i) {
+        hashers.push_back(&writers[i].ctx);
+        ptrs.push_back(data[i].data());
+        lengths.push_back(data[i].size());
+    }
+    SHA256WriteMulti(hashers.data(), ptrs.data(), lengths.data(), writers.size());
+}
+
 uint256 SHA256Uint256(const uint256& input)
 {
     uint256 result;
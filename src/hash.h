@@ -15,6 +15,7 @@
 #include <span.h>
 #include <uint256.h>
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -108,6 +109,10 @@ public:
         ctx.Write(UCharCast(src.data()), src.size());
     }
 
+    /** Write data[i] to writers[i] for each i, hashing the messages in
+     *  parallel SHA256 lanes where available (see SHA256WriteMulti). */
+    static void WriteMulti(std::span<HashWriter> writers, std::span<const std::span<const unsigned char>> data);
+
     /** Compute the double-SHA256 hash of all data written to this object.
      *
      * Invalidates this object.
@@ -203,6 +208,53 @@ public:
     }
 };
 
+/**
+ * Feeds a single serialization into several HashWriters at once.
+ *
+ * Each write goes to the sinks selected with SetSinks() (bit i selects sink
+ * i), so objects whose hashes cover overlapping parts of one serialization
+ * can be hashed in one pass, with each sink skipping the sections it does
+ * not commit to.
+ */
+template <size_t N>
+class MultiHashWriter
+{
+    static_assert(N > 0 && N <= 32);
+
+private:
+    std::array<HashWriter, N> m_sinks;
+    uint32_t m_mask{(uint32_t{1} << (N - 1) << 1) - 1};
+
+public:
+    MultiHashWriter() = default;
+    /** Start from the given (possibly primed, e.g. TaggedHash()) writers. */
+    explicit MultiHashWriter(std::array<HashWriter, N> sinks) : m_sinks{std::move(sinks)} {}
+
+    /** Select the sinks subsequent writes go to. */
+    MultiHashWriter& SetSinks(uint32_t mask)
+    {
+        m_mask = mask;
+        return *this;
+    }
+
+    void write(std::span<const std::byte> src)
+    {
+        for (size_t i{0}; i < N; ++i) {
+            if ((m_mask >> i) & 1) m_sinks[i].write(src);
+        }
+    }
+
+    /** Access sink `i`, e.g. to finalize it. */
+    HashWriter& Sink(size_t i) LIFETIMEBOUND { return m_sinks.at(i); }
+
+    template <typename T>
+    MultiHashWriter& operator<<(const T& obj)
+    {
+        ::Serialize(*this, obj);
+        return *this;
+    }
+};
+
 /** Single-SHA256 a 32-byte input (represented as uint256). */
 [[nodiscard]] uint256 SHA256Uint256(const uint256& input);
 
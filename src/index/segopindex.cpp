@@ -0,0 +1,260 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/segopindex.h>
+
+#include <common/args.h>
+#include <dbwrapper.h>
+#include <logging.h>
+#include <merkleblock.h>
+#include <node/blockstorage.h>
+#include <segop/segop.h>
+#include <segop/segop_store.h>
+#include <serialize.h>
+#include <validation.h>
+
+#include <algorithm>
+#include <ios>
+
+/* The index has one entry per segOP transaction under each of three key
+ * spaces:
+ *
+ *   [DB_SEGOP_HEIGHT, height (BE), txid]
+ *   [DB_SEGOP_TIER, BUDS tier, height (BE), txid]
+ *   [DB_SEGOP_TYPE, BUDS data type, height (BE), txid]
+ *
+ * Heights are big-endian so that a scan from [prefix(, code), start_height]
+ * visits entries in block order. All three carry the same value, the block
+ * hash included, so a scan never needs a second lookup.
+ *
+ * Each indexed block also has its segOP merkle root:
+ *
+ *   [DB_SEGOP_ROOT, block hash] -> (root, number of leaves)
+ */
+constexpr uint8_t DB_SEGOP_HEIGHT{'h'};
+constexpr uint8_t DB_SEGOP_TIER{'t'};
+constexpr uint8_t DB_SEGOP_TYPE{'y'};
+constexpr uint8_t DB_SEGOP_ROOT{'r'};
+
+std::unique_ptr<SegopIndex> g_segopindex;
+
+namespace {
+
+struct DBKey {
+    uint8_t prefix{DB_SEGOP_HEIGHT};
+    //! BUDS tier or data type; not part of DB_SEGOP_HEIGHT keys.
+    uint8_t code{0};
+    int height{0};
+    uint256 txid;
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, prefix);
+        if (prefix != DB_SEGOP_HEIGHT) ser_writedata8(s, code);
+        ser_writedata32be(s, height);
+        s << txid;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        prefix = ser_readdata8(s);
+        if (prefix != DB_SEGOP_HEIGHT && prefix != DB_SEGOP_TIER && prefix != DB_SEGOP_TYPE) {
+            throw std::ios_base::failure("Invalid format for segOP index DB key");
+        }
+        code = prefix == DB_SEGOP_HEIGHT ? 0 : ser_readdata8(s);
+        height = ser_readdata32be(s);
+        s >> txid;
+    }
+};
+
+struct DBVal {
+    uint32_t payload_size{0};
+    uint8_t tier{0};
+    uint8_t type{0};
+    uint8_t arbda{0};
+    CDiskTxPos pos;
+    uint256 block_hash;
+
+    SERIALIZE_METHODS(DBVal, obj) { READWRITE(VARINT(obj.payload_size), obj.tier, obj.type, obj.arbda, obj.pos, obj.block_hash); }
+};
+
+struct DBRootVal {
+    uint256 root;
+    uint32_t leaves{0};
+
+    SERIALIZE_METHODS(DBRootVal, obj) { READWRITE(obj.root, VARINT(obj.leaves)); }
+};
+
+} // namespace
+
+/** Access to the segOP index database (indexes/segopindex/) */
+class SegopIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Write the entries and segOP root of one block to the DB.
+    [[nodiscard]] bool WriteEntries(int height, const std::vector<std::pair<Txid, DBVal>>& entries,
+                                    const uint256& block_hash, const DBRootVal& root);
+
+    /// Erase all entries at the given height, and the root of that block, from the DB.
+    [[nodiscard]] bool EraseHeight(int height, const uint256& block_hash);
+};
+
+SegopIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "segopindex", n_cache_size, f_memory, f_wipe)
+{}
+
+bool SegopIndex::DB::WriteEntries(int height, const std::vector<std::pair<Txid, DBVal>>& entries,
+                                  const uint256& block_hash, const DBRootVal& root)
+{
+    CDBBatch batch(*this);
+    if (root.leaves > 0) batch.Write(std::make_pair(DB_SEGOP_ROOT, block_hash), root);
+    for (const auto& [txid, val] : entries) {
+        batch.Write(DBKey{DB_SEGOP_HEIGHT, 0, height, txid.ToUint256()}, val);
+        batch.Write(DBKey{DB_SEGOP_TIER, val.tier, height, txid.ToUint256()}, val);
+        batch.Write(DBKey{DB_SEGOP_TYPE, val.type, height, txid.ToUint256()}, val);
+    }
+    return WriteBatch(batch);
+}
+
+bool SegopIndex::DB::EraseHeight(int height, const uint256& block_hash)
+{
+    CDBBatch batch(*this);
+    batch.Erase(std::make_pair(DB_SEGOP_ROOT, block_hash));
+    std::unique_ptr<CDBIterator> db_it(NewIterator());
+    DBKey key{DB_SEGOP_HEIGHT, 0, height, uint256{}};
+    for (db_it->Seek(key); db_it->Valid(); db_it->Next()) {
+        if (!db_it->GetKey(key) || key.prefix != DB_SEGOP_HEIGHT || key.height != height) break;
+        DBVal val;
+        if (!db_it->GetValue(val)) {
+            LogError("unable to read value in segopindex at height %d", height);
+            return false;
+        }
+        batch.Erase(key);
+        batch.Erase(DBKey{DB_SEGOP_TIER, val.tier, height, key.txid});
+        batch.Erase(DBKey{DB_SEGOP_TYPE, val.type, height, key.txid});
+    }
+    return WriteBatch(batch);
+}
+
+SegopIndex::SegopIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "segopindex"), m_db(std::make_unique<SegopIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+SegopIndex::~SegopIndex() = default;
+
+bool SegopIndex::CustomAppend(const interfaces::BlockInfo& block)
+{
+    if (block.height == 0) return true;
+
+    assert(block.data);
+    CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
+    // Offsets must match the record as stored, which may omit segOP payloads.
+    const auto& segop_store{m_chainstate->m_blockman.m_segop_store};
+    const bool stripped{segop_store && segop_store->IsStrippedBlock(pos)};
+    std::vector<std::pair<Txid, DBVal>> entries;
+    const auto leaves{GetSegopLeaves(*block.data)};
+    const DBRootVal root{.root = ComputeSegopMerkleRoot(leaves), .leaves = static_cast<uint32_t>(leaves.size())};
+    for (const auto& tx : block.data->vtx) {
+        if (!tx->segop_payload.IsNull()) {
+            const SegopBUDSInfo info{SegopExtractBUDSInfo(tx->segop_payload.data)};
+            entries.emplace_back(tx->GetHash(), DBVal{
+                .payload_size = static_cast<uint32_t>(tx->segop_payload.data.size()),
+                .tier = static_cast<uint8_t>(info.tier),
+                .type = static_cast<uint8_t>(info.type),
+                .arbda = static_cast<uint8_t>(info.arbda),
+                .pos = pos,
+                .block_hash = block.hash,
+            });
+        } else if (segop::IsPayloadStripped(*tx)) {
+            LogDebug(BCLog::PRUNE, "segOP payload of %s at height %d is no longer available, not indexed\n",
+                     tx->GetHash().ToString(), block.height);
+        }
+        pos.nTxOffset += stripped ? ::GetSerializeSize(TX_WITH_WITNESS_NO_SEGOP(*tx)) :
+                                    ::GetSerializeSize(TX_WITH_WITNESS(*tx));
+    }
+    return m_db->WriteEntries(block.height, entries, block.hash, root);
+}
+
+bool SegopIndex::CustomRemove(const interfaces::BlockInfo& block)
+{
+    return m_db->EraseHeight(block.height, block.hash);
+}
+
+BaseIndex::DB& SegopIndex::GetDB() const { return *m_db; }
+
+bool SegopIndex::FindSegopTxs(int start_height, int end_height, const SegopIndexFilter& filter, size_t limit,
+                              std::vector<SegopIndexEntry>& entries) const
+{
+    // The data type implies the tier, so scan the narrowest key space.
+    DBKey key{DB_SEGOP_HEIGHT, 0, std::max(start_height, 0), uint256{}};
+    if (filter.type) {
+        key.prefix = DB_SEGOP_TYPE;
+        key.code = static_cast<uint8_t>(*filter.type);
+    } else if (filter.tier) {
+        key.prefix = DB_SEGOP_TIER;
+        key.code = static_cast<uint8_t>(*filter.tier);
+    }
+    const uint8_t prefix{key.prefix};
+    const uint8_t code{key.code};
+
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    for (db_it->Seek(key); db_it->Valid() && entries.size() < limit; db_it->Next()) {
+        if (!db_it->GetKey(key) || key.prefix != prefix || key.code != code || key.height > end_height) break;
+        DBVal val;
+        if (!db_it->GetValue(val)) {
+            LogError("unable to read value in segopindex at key (%c, %d, %s)", prefix, key.height, key.txid.ToString());
+            return false;
+        }
+        if (filter.tier && val.tier != static_cast<uint8_t>(*filter.tier)) continue;
+        entries.push_back(SegopIndexEntry{
+            .txid = Txid::FromUint256(key.txid),
+            .height = key.height,
+            .block_hash = val.block_hash,
+            .payload_size = val.payload_size,
+            .tier = static_cast<segop::BUDSTier>(val.tier),
+            .type = static_cast<segop::BUDSDataType>(val.type),
+            .arbda = static_cast<segop::ARBDATier>(val.arbda),
+            .pos = val.pos,
+        });
+    }
+    return true;
+}
+
+bool SegopIndex::FindBlockRoot(const uint256& block_hash, SegopBlockRoot& root) const
+{
+    DBRootVal val;
+    if (!m_db->Read(std::make_pair(DB_SEGOP_ROOT, block_hash), val)) return false;
+    root = SegopBlockRoot{.root = val.root, .leaves = val.leaves};
+    return true;
+}
+
+bool SegopIndex::ReadTx(const SegopIndexEntry& entry, CTransactionRef& tx) const
+{
+    AutoFile file{m_chainstate->m_blockman.OpenBlockFile(entry.pos, true)};
+    if (file.IsNull()) {
+        LogError("OpenBlockFile failed");
+        return false;
+    }
+    try {
+        CBlockHeader header;
+        file >> header;
+        file.seek(entry.pos.nTxOffset, SEEK_CUR);
+        file >> TX_WITH_WITNESS(tx);
+    } catch (const std::exception& e) {
+        LogError("Deserialize or I/O error - %s", e.what());
+        return false;
+    }
+    if (tx->GetHash() != entry.txid) {
+        LogError("txid mismatch");
+        return false;
+    }
+    if (const auto& segop_store{m_chainstate->m_blockman.m_segop_store}) {
+        segop_store->AttachPayload(tx);
+    }
+    return true;
+}
@@ -0,0 +1,107 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_INDEX_SEGOPINDEX_H
+#define BITCOIN_INDEX_SEGOPINDEX_H
+
+#include <index/base.h>
+#include <index/disktxpos.h>
+#include <primitives/transaction_identifier.h>
+#include <segop/buds.h>
+#include <uint256.h>
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+static constexpr bool DEFAULT_SEGOPINDEX{false};
+
+/** One indexed segOP transaction. */
+struct SegopIndexEntry {
+    Txid txid;
+    int height{0};
+    //! Hash of the block at `height` when the entry was indexed, which may
+    //! since have been reorged out.
+    uint256 block_hash;
+    uint32_t payload_size{0};
+    segop::BUDSTier tier{segop::BUDSTier::UNSPECIFIED};
+    segop::BUDSDataType type{segop::BUDSDataType::UNSPECIFIED};
+    segop::ARBDATier arbda{segop::ARBDATier::T0};
+    //! Location of the transaction in the block files, as for the txindex.
+    CDiskTxPos pos;
+};
+
+/** The root of a block's segOP merkle tree (see ComputeSegopMerkleRoot()). */
+struct SegopBlockRoot {
+    uint256 root;
+    uint32_t leaves{0};
+};
+
+/** Restricts a SegopIndex::FindSegopTxs() range scan to one BUDS tier and/or data type. */
+struct SegopIndexFilter {
+    std::optional<segop::BUDSTier> tier{};
+    std::optional<segop::BUDSDataType> type{};
+};
+
+/**
+ * SegopIndex records every transaction that carries a segOP payload, with its
+ * BUDS classification, so that segOP data can be found without scanning
+ * blocks. Entries are keyed by height, and again by BUDS tier and by BUDS
+ * data type (each followed by height), so that all three can be range-scanned
+ * in block order.
+ *
+ * The root of each block's segOP merkle tree is kept as well, keyed by block
+ * hash, so that segOP proofs can be checked without reading the block.
+ *
+ * Payloads that had already been pruned from the payload store when the index
+ * reached their block cannot be classified, and are not indexed.
+ */
+class SegopIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    bool AllowPrune() const override { return false; }
+
+protected:
+    bool CustomAppend(const interfaces::BlockInfo& block) override;
+
+    bool CustomRemove(const interfaces::BlockInfo& block) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit SegopIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~SegopIndex() override;
+
+    /// List indexed segOP transactions in block order.
+    ///
+    /// @param[in]   start_height  The first height to include.
+    /// @param[in]   end_height  The last height to include.
+    /// @param[in]   filter  Only include entries of this BUDS tier and/or data type.
+    /// @param[in]   limit  The maximum number of entries to return.
+    /// @param[out]  entries  The matching entries, ordered by height and then txid.
+    /// @return  false on a database error
+    bool FindSegopTxs(int start_height, int end_height, const SegopIndexFilter& filter, size_t limit,
+                      std::vector<SegopIndexEntry>& entries) const;
+
+    /// Look up the segOP merkle root of an indexed block. Returns false if
+    /// the block is not indexed or was indexed before roots were recorded.
+    bool FindBlockRoot(const uint256& block_hash, SegopBlockRoot& root) const;
+
+    /// Read an indexed transaction, with its payload re-attached if the
+    /// payload store still has it.
+    bool ReadTx(const SegopIndexEntry& entry, CTransactionRef& tx) const;
+};
+
+/// The global segOP payload index. May be null.
+extern std::unique_ptr<SegopIndex> g_segopindex;
+
+#endif // BITCOIN_INDEX_SEGOPINDEX_H
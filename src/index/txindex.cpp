@@ -62,11 +62,15 @@ bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
 
     assert(block.data);
     CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
+    // Offsets must match the record as stored, which may omit segOP payloads.
+    const auto& segop_store{m_chainstate->m_blockman.m_segop_store};
+    const bool stripped{segop_store && segop_store->IsStrippedBlock(pos)};
     std::vector<std::pair<Txid, CDiskTxPos>> vPos;
     vPos.reserve(block.data->vtx.size());
     for (const auto& tx : block.data->vtx) {
         vPos.emplace_back(tx->GetHash(), pos);
-        pos.nTxOffset += ::GetSerializeSize(TX_WITH_WITNESS(*tx));
+        pos.nTxOffset += stripped ? ::GetSerializeSize(TX_WITH_WITNESS_NO_SEGOP(*tx)) :
+                                    ::GetSerializeSize(TX_WITH_WITNESS(*tx));
     }
     return m_db->WriteTxs(vPos);
 }
@@ -98,6 +102,9 @@ bool TxIndex::FindTx(const Txid& tx_hash, uint256& block_hash, CTransactionRef&
         LogError("txid mismatch");
         return false;
     }
+    if (const auto& segop_store{m_chainstate->m_blockman.m_segop_store}) {
+        segop_store->AttachPayload(tx);
+    }
     block_hash = header.GetHash();
     return true;
 }
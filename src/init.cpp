@@ -26,6 +26,7 @@
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/segopindex.h>
 #include <index/txindex.h>
 #include <init/common.h>
 #include <interfaces/chain.h>
@@ -70,7 +71,9 @@
 #include <scheduler.h>
 #include <script/sigcache.h>
 #include <segop/segop.h>
+#include <segop/segop_compress.h>
 #include <segop/segop_prune.h>
+#include <segop/segop_retention.h>
 #include <sync.h>
 #include <torcontrol.h>
 #include <txdb.h>
@@ -117,6 +120,7 @@
 #ifdef ENABLE_ZMQ
 #include <zmq/zmqabstractnotifier.h>
 #include <zmq/zmqnotificationinterface.h>
+#include <zmq/zmqpublishnotifier.h>
 #include <zmq/zmqrpc.h>
 #endif
 
@@ -362,6 +366,7 @@ void Shutdown(NodeContext& node)
     // Stop and delete all indexes only after flushing background callbacks.
     for (auto* index : node.indexes) index->Stop();
     if (g_txindex) g_txindex.reset();
+    if (g_segopindex) g_segopindex.reset();
     if (g_coin_stats_index) g_coin_stats_index.reset();
     DestroyAllBlockFilterIndexes();
     node.indexes.clear(); // all instances are nullptr now
@@ -395,6 +400,11 @@ void Shutdown(NodeContext& node)
     }
 #endif
 
+    if (node.segop_retention) {
+        if (node.validation_signals) node.validation_signals->UnregisterValidationInterface(node.segop_retention.get());
+        node.segop_retention.reset();
+    }
+
     node.chain_clients.clear();
     if (node.validation_signals) {
         node.validation_signals->UnregisterAllValidationInterfaces();
@@ -504,6 +514,7 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-allowignoredconf", strprintf("For backwards compatibility, treat an unused %s file in the datadir as a warning, not an error.", BITCOIN_CONF_FILENAME), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-loadblock=<file>", "Imports blocks from external file on startup", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-maxmempool=<n>", strprintf("Keep the transaction memory pool below <n> megabytes (default: %u)", DEFAULT_MAX_MEMPOOL_SIZE_MB), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-maxsegopmempool=<n>", strprintf("Keep the segOP payloads in the transaction memory pool below <n> megabytes, evicting the lowest-feerate segOP transactions first (default: %u)", DEFAULT_MAX_SEGOP_MEMPOOL_SIZE_MB), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     // TODO: remove in v31.0
     argsman.AddArg("-maxorphantx=<n>", strprintf("(Removed option, see release notes)"), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-mempoolexpiry=<n>", strprintf("Do not keep transactions in the mempool longer than <n> hours (default: %u)", DEFAULT_MEMPOOL_EXPIRY_HOURS), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -527,10 +538,13 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     // segOP pruning & retention
     argsman.AddArg(
         "-segopprune",
-        _("Enable segOP payload pruning in RPC responses. When enabled, "
-          "segOP payloads older than the effective retention window "
-          "E = max(W, R) are treated as pruned and only their P2SOP "
-          "commitments are returned."),
+        _("Enable segOP payload pruning. When enabled, blocks are stored "
+          "with their segOP payloads in separate sop?????.dat files, and "
+          "payloads older than the effective retention window E = max(W, R) "
+          "are deleted from disk and reported as pruned by RPC; only their "
+          "P2SOP commitments remain. As old blocks can then no longer be "
+          "served in full, the node signals NODE_NETWORK_LIMITED instead of "
+          "NODE_NETWORK."),
         ArgsManager::ALLOW_ANY,
         OptionsCategory::OPTIONS);
 
@@ -553,10 +567,11 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
             "%s (default: %u, minimum: %u, maximum: %u)",
             _("segOP Archival Window A in blocks. Nodes retaining a larger "
               "archival window keep segOP lane data for tip-A blocks "
-              "available for fast historical queries."),
-            segop::DEFAULT_SEGOP_VALIDATION_WINDOW,
-            segop::MIN_SEGOP_VALIDATION_WINDOW,
-            segop::MAX_SEGOP_VALIDATION_WINDOW),
+              "available for fast historical queries. Older payload files "
+              "are compacted to drop superseded records."),
+            segop::DEFAULT_SEGOP_ARCHIVE_WINDOW,
+            segop::MIN_SEGOP_ARCHIVE_WINDOW,
+            segop::MAX_SEGOP_ARCHIVE_WINDOW),
         ArgsManager::ALLOW_ANY,
         OptionsCategory::OPTIONS);
 
@@ -567,11 +582,24 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
             _("Operator Retention Window R in blocks. Local policy window for "
               "keeping segOP lane data beyond the archival window; does not "
               "affect consensus."),
-            segop::DEFAULT_SEGOP_VALIDATION_WINDOW,
-            segop::MIN_SEGOP_VALIDATION_WINDOW,
-            segop::MAX_SEGOP_VALIDATION_WINDOW),
+            segop::DEFAULT_SEGOP_OPERATOR_WINDOW,
+            segop::MIN_SEGOP_OPERATOR_WINDOW,
+            segop::MAX_SEGOP_OPERATOR_WINDOW),
         ArgsManager::ALLOW_ANY,
         OptionsCategory::OPTIONS);
+    argsman.AddArg("-segoplightibd", strprintf("Download blocks buried under the -assumevalid block and outside the segOP validation window without their segOP payloads, "
+                                               "trusting their P2SOP commitments. The node will not serve those payloads. Implies keeping a segOP payload store (default: %u)", DEFAULT_SEGOP_LIGHT_IBD),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-segopcompress=<type>", "Store segOP payloads whose largest TLV record is of this type LZ-compressed in the segOP payload store. "
+                                            "Commitments and served payloads are unaffected. <type> can be text, json, binary or a numeric TLV type; "
+                                            "without a type, text and json. Requires -segopprune or -segoplightibd. Can be specified multiple times (default: none)",
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-segopcompressmin=<n>", strprintf("Only compress segOP payloads of at least <n> bytes (default: %u)", segop::DEFAULT_SEGOP_COMPRESS_MIN_SIZE),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-segopprunebatch=<n>", strprintf("Erase at most this many segOP payload index entries per connected block while pruning (default: %u)", segop::DEFAULT_SEGOP_PRUNE_BATCH),
+                   ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-segopcompactbytes=<n>", strprintf("Copy at most this many bytes of a segOP payload file per connected block while compacting it (default: %u)", segop::DEFAULT_SEGOP_COMPACT_BYTES),
+                   ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::OPTIONS);
     ///
 
     argsman.AddArg("-reindex-chainstate", "If enabled, wipe chain state, and rebuild it from blk*.dat files on disk. If an assumeutxo snapshot was loaded, its chainstate will be wiped as well. The snapshot can then be reloaded via RPC.", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
@@ -581,6 +609,7 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-shutdownnotify=<cmd>", "Execute command immediately before beginning shutdown. The need for shutdown may be urgent, so be careful not to delay it long (if the command doesn't require interaction with the server, consider having it fork into the background).", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
 #endif
     argsman.AddArg("-txindex", strprintf("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)", DEFAULT_TXINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-segopindex", strprintf("Maintain an index of segOP transactions by height, BUDS tier and data type, used by the listsegop rpc call (default: %u)", DEFAULT_SEGOPINDEX), ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blockfilterindex=<type>",
                  strprintf("Maintain an index of compact filters by block (default: %s, values: %s).", DEFAULT_BLOCKFILTERINDEX, ListBlockFilterTypes()) +
                  " If <type> is not supplied or if <type> = 1, indexes for all known types are enabled.",
@@ -663,22 +692,32 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
     argsman.AddArg("-zmqpubrawblock=<address>", "Enable publish raw block in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawtx=<address>", "Enable publish raw transaction in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsequence=<address>", "Enable publish hash block and tx sequence in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubhashsegop=<address>", "Enable publish txid, fullxid and BUDS tier and data type of segOP transactions in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubrawsegop=<address>", "Enable publish txid, fullxid, BUDS tier and data type and payload of segOP transactions in <address>", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqsegopfilter=<name>", "Only publish segOP transactions of this BUDS tier (e.g. T2_OPERATIONAL) or data type (e.g. L2_STATE_ANCHOR) on the segOP topics (default: publish all)", ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubhashblockhwm=<n>", strprintf("Set publish hash block outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubhashtxhwm=<n>", strprintf("Set publish hash transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawblockhwm=<n>", strprintf("Set publish raw block outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubrawtxhwm=<n>", strprintf("Set publish raw transaction outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
     argsman.AddArg("-zmqpubsequencehwm=<n>", strprintf("Set publish hash sequence message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubhashsegophwm=<n>", strprintf("Set publish hash segOP outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
+    argsman.AddArg("-zmqpubrawsegophwm=<n>", strprintf("Set publish raw segOP outbound message high water mark (default: %d)", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM), ArgsManager::ALLOW_ANY, OptionsCategory::ZMQ);
 #else
     hidden_args.emplace_back("-zmqpubhashblock=<address>");
     hidden_args.emplace_back("-zmqpubhashtx=<address>");
     hidden_args.emplace_back("-zmqpubrawblock=<address>");
     hidden_args.emplace_back("-zmqpubrawtx=<address>");
     hidden_args.emplace_back("-zmqpubsequence=<n>");
+    hidden_args.emplace_back("-zmqpubhashsegop=<address>");
+    hidden_args.emplace_back("-zmqpubrawsegop=<address>");
+    hidden_args.emplace_back("-zmqsegopfilter=<name>");
     hidden_args.emplace_back("-zmqpubhashblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubhashtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawblockhwm=<n>");
     hidden_args.emplace_back("-zmqpubrawtxhwm=<n>");
     hidden_args.emplace_back("-zmqpubsequencehwm=<n>");
+    hidden_args.emplace_back("-zmqpubhashsegophwm=<n>");
+    hidden_args.emplace_back("-zmqpubrawsegophwm=<n>");
 #endif
 
     argsman.AddArg("-checkblocks=<n>", strprintf("How many blocks to check at startup (default: %u, 0 = all)", DEFAULT_CHECKBLOCKS), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::DEBUG_TEST);
@@ -729,6 +768,7 @@ void SetupServerArgs(ArgsManager& argsman, bool can_listen_ipc)
 
     argsman.AddArg("-blockmaxweight=<n>", strprintf("Set maximum BIP141 block weight (default: %d)", DEFAULT_BLOCK_MAX_WEIGHT), ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::BLOCK_CREATION);
     argsman.AddArg("-blockreservedweight=<n>", strprintf("Reserve space for the fixed-size block header plus the largest coinbase transaction the mining software may add to the block. (default: %d).", DEFAULT_BLOCK_RESERVED_WEIGHT), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
+    argsman.AddArg("-blockmaxarbdaweight=<tier>:<n>", "Limit the weight of transactions of an ARBDA tier (T0-T3, where T0 includes transactions without a segOP payload) in created blocks, e.g. T3:400000. Can be specified once per tier (default: unlimited)", ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
     argsman.AddArg("-blockmintxfee=<amt>", strprintf("Set lowest fee rate (in %s/kvB) for transactions to be included in block creation. (default: %s)", CURRENCY_UNIT, FormatMoney(DEFAULT_BLOCK_MIN_TX_FEE)), ArgsManager::ALLOW_ANY, OptionsCategory::BLOCK_CREATION);
     argsman.AddArg("-blockversion=<n>", "Override block version to test forking scenarios", ArgsManager::ALLOW_ANY | ArgsManager::DEBUG_ONLY, OptionsCategory::BLOCK_CREATION);
 
@@ -1030,6 +1070,8 @@ bool AppInitParameterInteraction(const ArgsManager& args)
     if (args.GetIntArg("-prune", 0)) {
         if (args.GetBoolArg("-txindex", DEFAULT_TXINDEX))
             return InitError(_("Prune mode is incompatible with -txindex."));
+        if (args.GetBoolArg("-segopindex", DEFAULT_SEGOPINDEX))
+            return InitError(_("Prune mode is incompatible with -segopindex."));
         if (args.GetBoolArg("-reindex-chainstate", false)) {
             return InitError(_("Prune mode is incompatible with -reindex-chainstate. Use full -reindex instead."));
         }
@@ -1099,6 +1141,18 @@ bool AppInitParameterInteraction(const ArgsManager& args)
         }
     }
 
+    for (const std::string& arg : args.GetArgs("-blockmaxarbdaweight")) {
+        if (!node::ParseARBDAMaxWeight(arg)) {
+            return InitError(strprintf(_("Invalid -blockmaxarbdaweight value '%s' (expected <tier>:<weight>, e.g. T3:400000)"), arg));
+        }
+    }
+
+#ifdef ENABLE_ZMQ
+    if (const auto filter{args.GetArg("-zmqsegopfilter")}; filter && !ParseZMQSegopFilter(*filter)) {
+        return InitError(strprintf(_("Invalid -zmqsegopfilter value '%s' (expected a BUDS tier or data type name)"), *filter));
+    }
+#endif
+
     {
         const auto max_block_weight = args.GetIntArg("-blockmaxweight", DEFAULT_BLOCK_MAX_WEIGHT);
         if (max_block_weight > MAX_BLOCK_WEIGHT) {
@@ -1262,6 +1316,8 @@ bool CheckHostPortOptions(const ArgsManager& args) {
         {"-zmqpubrawblock",  true,                false},
         {"-zmqpubrawtx",     true,                false},
         {"-zmqpubsequence",  true,                false},
+        {"-zmqpubhashsegop", true,                false},
+        {"-zmqpubrawsegop",  true,                false},
     }) {
         for (const std::string& param_value : args.GetArgs(param_name)) {
             const std::string param_value_hostport{
@@ -1284,6 +1340,12 @@ bool CheckHostPortOptions(const ArgsManager& args) {
     return true;
 }
 
+/** Whether old blocks may be missing their segOP payloads, so that NODE_NETWORK cannot be offered. */
+static bool IsSegopPayloadPruning(const BlockManager& blockman)
+{
+    return segop::IsPruneEnabled() || (blockman.m_segop_store && blockman.m_segop_store->HavePruned());
+}
+
 // A GUI user may opt to retry once with do_reindex set if there is a failure during chainstate initialization.
 // The function therefore has to support re-entry.
 static ChainstateLoadResult InitAndLoadChainstate(
@@ -1357,7 +1419,7 @@ static ChainstateLoadResult InitAndLoadChainstate(
     // dependency between validation and index/base, since the latter is not in
     // libbitcoinkernel.
     chainman.snapshot_download_completed = [&node]() {
-        if (!node.chainman->m_blockman.IsPruneMode()) {
+        if (!node.chainman->m_blockman.IsPruneMode() && !IsSegopPayloadPruning(node.chainman->m_blockman)) {
             LogInfo("[snapshot] re-enabling NODE_NETWORK services");
             node.connman->AddLocalServices(NODE_NETWORK);
         }
@@ -1430,8 +1492,8 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         const int operator_w = args.GetIntArg(
             "-segopoperatorwindow", segop::DEFAULT_SEGOP_OPERATOR_WINDOW);
 
-        // Signature: InitPrunePolicy(bool enabled, int validation_w, int archive_w, int operator_w)
-        segop::InitPrunePolicy(segop_prune_enabled, validation_w, archive_w, operator_w);
+        // Signature: InitPrunePolicy(int validation_w, int archive_w, int operator_w, bool enabled)
+        segop::InitPrunePolicy(validation_w, archive_w, operator_w, segop_prune_enabled);
     }
 
     // ********************************************************* Step 4a: application initialization
@@ -1807,6 +1869,9 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
     if (args.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
         LogInfo("* Using %.1f MiB for transaction index database", index_cache_sizes.tx_index * (1.0 / 1024 / 1024));
     }
+    if (args.GetBoolArg("-segopindex", DEFAULT_SEGOPINDEX)) {
+        LogInfo("* Using %.1f MiB for segOP index database", index_cache_sizes.segop_index * (1.0 / 1024 / 1024));
+    }
     for (BlockFilterType filter_type : g_enabled_filter_types) {
         LogInfo("* Using %.1f MiB for %s block filter index database",
                   index_cache_sizes.filter_index * (1.0 / 1024 / 1024), BlockFilterTypeName(filter_type));
@@ -1868,6 +1933,12 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
                                      peerman_opts);
     validation_signals.RegisterValidationInterface(node.peerman.get());
 
+    if (const auto& segop_store{chainman.m_blockman.m_segop_store}) {
+        node.segop_retention = std::make_unique<segop::RetentionManager>(*segop_store, args.GetIntArg("-segopprunebatch", segop::DEFAULT_SEGOP_PRUNE_BATCH),
+                                                                          args.GetIntArg("-segopcompactbytes", segop::DEFAULT_SEGOP_COMPACT_BYTES));
+        validation_signals.RegisterValidationInterface(node.segop_retention.get());
+    }
+
     // ********************************************************* Step 8: start indexers
 
     if (args.GetBoolArg("-txindex", DEFAULT_TXINDEX)) {
@@ -1875,6 +1946,11 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         node.indexes.emplace_back(g_txindex.get());
     }
 
+    if (args.GetBoolArg("-segopindex", DEFAULT_SEGOPINDEX)) {
+        g_segopindex = std::make_unique<SegopIndex>(interfaces::MakeChain(node), index_cache_sizes.segop_index, false, do_reindex);
+        node.indexes.emplace_back(g_segopindex.get());
+    }
+
     for (const auto& filter_type : g_enabled_filter_types) {
         InitBlockFilterIndex([&]{ return interfaces::MakeChain(node); }, filter_type, index_cache_sizes.filter_index, false, do_reindex);
         node.indexes.emplace_back(GetBlockFilterIndex(filter_type));
@@ -1909,7 +1985,9 @@ bool AppInitMain(NodeContext& node, interfaces::BlockAndHeaderTipInfo* tip_info)
         }
     } else {
         // Prior to setting NODE_NETWORK, check if we can provide historical blocks.
-        if (!WITH_LOCK(chainman.GetMutex(), return chainman.BackgroundSyncInProgress())) {
+        if (IsSegopPayloadPruning(chainman.m_blockman)) {
+            LogInfo("Running node in NODE_NETWORK_LIMITED mode, as old blocks are missing their segOP payloads");
+        } else if (!WITH_LOCK(chainman.GetMutex(), return chainman.BackgroundSyncInProgress())) {
             LogInfo("Setting NODE_NETWORK on non-prune mode");
             g_local_services = ServiceFlags(g_local_services | NODE_NETWORK);
         } else {
@@ -7,6 +7,7 @@
 
 #include <dbwrapper.h>
 #include <kernel/notifications_interface.h>
+#include <segop/segop_compress.h>
 #include <util/fs.h>
 
 #include <cstdint>
@@ -26,6 +27,11 @@ struct BlockManagerOpts {
     bool use_xor{DEFAULT_XOR_BLOCKSDIR};
     uint64_t prune_target{0};
     bool fast_prune{false};
+    //! Keep segOP payloads in sop?????.dat instead of inline in blk?????.dat,
+    //! so that retention pruning can free their disk space.
+    bool segop_store{false};
+    //! Which payloads the segOP store keeps compressed on disk.
+    segop::CompressionOptions segop_compression{};
     const fs::path blocks_dir;
     Notifications& notifications;
     DBParams block_tree_db_params;
@@ -22,6 +22,7 @@ class CChainParams;
 class ValidationSignals;
 
 static constexpr auto DEFAULT_MAX_TIP_AGE{24h};
+static constexpr bool DEFAULT_SEGOP_LIGHT_IBD{false};
 
 namespace kernel {
 
@@ -38,6 +39,9 @@ struct ChainstateManagerOpts {
     std::optional<arith_uint256> minimum_chain_work{};
     //! If set, it will override the block hash whose ancestors we will assume to have valid scripts without checking them.
     std::optional<uint256> assumed_valid_block{};
+    //! Download blocks buried under the assumevalid block without their segOP
+    //! payloads, and accept them with only the P2SOP commitments (-segoplightibd).
+    bool segop_light_ibd{DEFAULT_SEGOP_LIGHT_IBD};
     //! If the tip is older than this, the node is considered to be in initial block download.
     std::chrono::seconds max_tip_age{DEFAULT_MAX_TIP_AGE};
     DBOptions coins_db{};
@@ -11,6 +11,8 @@
 #include <policy/policy.h>
 #include <policy/settings.h>
 #include <primitives/transaction.h>
+#include <segop/buds.h>
+#include <segop/segop.h>
 #include <util/epochguard.h>
 #include <util/overflow.h>
 
@@ -82,6 +84,8 @@ private:
     const CAmount nFee;             //!< Cached to avoid expensive parent-transaction lookups
     const int32_t nTxWeight;         //!< ... and avoid recomputing tx weight (also used for GetTxSize())
     const size_t nUsageSize;        //!< ... and total memory usage
+    const uint32_t m_segop_size;    //!< ... and segOP payload bytes (segOP lane usage)
+    const SegopPackedBUDSInfo m_buds_info; //!< ... and BUDS classification of the payload (ARBDA T0 without one)
     const int64_t nTime;            //!< Local time when entering the mempool
     const uint64_t entry_sequence;  //!< Sequence number used to determine whether this transaction is too recent for relay
     const unsigned int entryHeight; //!< Chain height when entering the mempool
@@ -114,6 +118,8 @@ public:
           nFee{fee},
           nTxWeight{GetTransactionWeight(*tx)},
           nUsageSize{RecursiveDynamicUsage(tx)},
+          m_segop_size{static_cast<uint32_t>(tx->segop_payload.data.size())},
+          m_buds_info{tx->segop_payload.IsNull() ? SegopPackedBUDSInfo{} : SegopPackedBUDSInfo{SegopExtractBUDSInfo(tx->segop_payload.data)}},
           nTime{time},
           entry_sequence{entry_sequence},
           entryHeight{entry_height},
@@ -148,6 +154,9 @@ public:
     int64_t GetSigOpCost() const { return sigOpCost; }
     CAmount GetModifiedFee() const { return m_modified_fee; }
     size_t DynamicMemoryUsage() const { return nUsageSize; }
+    uint32_t GetSegopSize() const { return m_segop_size; }
+    const SegopPackedBUDSInfo& GetBUDSInfo() const { return m_buds_info; }
+    segop::ARBDATier GetARBDATier() const { return m_buds_info.ARBDA(); }
     const LockPoints& GetLockPoints() const { return lockPoints; }
 
     // Adjusts the descendant state.
@@ -7,6 +7,8 @@
 
 #include <hash.h>
 #include <consensus/consensus.h>
+#include <consensus/merkle.h>
+#include <segop/segop.h>
 
 
 std::vector<unsigned char> BitsToBytes(const std::vector<bool>& bits)
@@ -54,6 +56,63 @@ CMerkleBlock::CMerkleBlock(const CBlock& block, CBloomFilter* filter, const std:
     txn = CPartialMerkleTree(vHashes, vMatch);
 }
 
+std::vector<std::pair<Txid, uint256>> GetSegopLeaves(const CBlock& block)
+{
+    std::vector<std::pair<Txid, uint256>> leaves;
+    for (const auto& tx : block.vtx) {
+        for (const CTxOut& txout : tx->vout) {
+            if (const auto commitment{SegopGetCommitment(txout.scriptPubKey)}) {
+                leaves.emplace_back(tx->GetHash(), *commitment);
+                break;
+            }
+        }
+    }
+    return leaves;
+}
+
+uint256 SegopLeafHash(const Txid& txid, const uint256& commitment)
+{
+    return (HashWriter{} << txid << commitment).GetHash();
+}
+
+uint256 ComputeSegopMerkleRoot(const std::vector<std::pair<Txid, uint256>>& leaves)
+{
+    std::vector<uint256> hashes;
+    hashes.reserve(leaves.size());
+    for (const auto& [txid, commitment] : leaves) {
+        hashes.push_back(SegopLeafHash(txid, commitment));
+    }
+    return ComputeMerkleRoot(std::move(hashes));
+}
+
+CSegopMerkleBlock::CSegopMerkleBlock(const CBlock& block, const std::set<Txid>& txids)
+{
+    header = block.GetBlockHeader();
+
+    std::vector<bool> vMatch;
+    std::vector<Txid> vHashes;
+    for (const auto& [txid, commitment] : GetSegopLeaves(block)) {
+        const bool match{txids.contains(txid)};
+        if (match) matched.emplace_back(txid, commitment);
+        vMatch.push_back(match);
+        vHashes.push_back(Txid::FromUint256(SegopLeafHash(txid, commitment)));
+    }
+
+    leaves = CPartialMerkleTree(vHashes, vMatch);
+}
+
+uint256 CSegopMerkleBlock::ExtractMatches()
+{
+    std::vector<Txid> vMatch;
+    std::vector<unsigned int> vIndex;
+    const uint256 root{leaves.ExtractMatches(vMatch, vIndex)};
+    if (root.IsNull() || vMatch.size() != matched.size()) return uint256{};
+    for (size_t i = 0; i < matched.size(); ++i) {
+        if (vMatch[i].ToUint256() != SegopLeafHash(matched[i].first, matched[i].second)) return uint256{};
+    }
+    return root;
+}
+
 // NOLINTNEXTLINE(misc-no-recursion)
 uint256 CPartialMerkleTree::CalcHash(int height, unsigned int pos, const std::vector<Txid> &vTxid) {
     //we can never have zero txs in a merkle block, we always need the coinbase tx
@@ -13,6 +13,7 @@
 #include <uint256.h>
 
 #include <set>
+#include <utility>
 #include <vector>
 
 // Helper functions for serialization.
@@ -157,4 +158,58 @@ private:
     CMerkleBlock(const CBlock& block, CBloomFilter* filter, const std::set<Txid>* txids);
 };
 
+/**
+ * The leaves of a block's segOP tree: the txid and P2SOP commitment of every
+ * transaction with a P2SOP output, in block order. Stripped transactions
+ * keep their P2SOP outputs, so this does not need the payloads themselves.
+ */
+std::vector<std::pair<Txid, uint256>> GetSegopLeaves(const CBlock& block);
+
+/** The hash of one segOP tree leaf. */
+uint256 SegopLeafHash(const Txid& txid, const uint256& commitment);
+
+/**
+ * Root of the merkle tree (built as the transaction tree) over a block's
+ * segOP leaves, or null if it has none.
+ */
+uint256 ComputeSegopMerkleRoot(const std::vector<std::pair<Txid, uint256>>& leaves);
+
+/**
+ * A proof that segOP commitments were included in a block: the block
+ * header and a partial merkle tree over the block's segOP leaves, with the
+ * (txid, commitment) pairs of the matched leaves.
+ *
+ * Only transactions carrying a P2SOP output are leaves, so the tree is
+ * usually far smaller than the transaction tree and so is the proof.
+ * The segOP root is not committed to by the header; the proof shows that
+ * the leaves are part of the segOP tree that a node computed for the block
+ * identified by the header (see verifysegopproof).
+ *
+ * NOTE: The block must have at least one segOP leaf.
+ */
+class CSegopMerkleBlock
+{
+public:
+    CBlockHeader header;
+    //! Partial tree over the leaf hashes, stored in place of txids.
+    CPartialMerkleTree leaves;
+    std::vector<std::pair<Txid, uint256>> matched;
+
+    CSegopMerkleBlock() = default;
+
+    /** Create from a CBlock, matching the segOP transactions in `txids`. */
+    CSegopMerkleBlock(const CBlock& block, const std::set<Txid>& txids);
+
+    SERIALIZE_METHODS(CSegopMerkleBlock, obj) { READWRITE(obj.header, obj.leaves, obj.matched); }
+
+    /**
+     * Check that `matched` is exactly what the partial tree commits to.
+     * @returns the segOP root, or null if the proof is malformed
+     */
+    uint256 ExtractMatches();
+
+    /** Number of segOP leaves in the block, to check against the node's own count. */
+    unsigned int GetNumLeaves() const { return leaves.GetNumTransactions(); }
+};
+
 #endif // BITCOIN_MERKLEBLOCK_H
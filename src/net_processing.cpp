@@ -22,6 +22,7 @@
 #include <flatfile.h>
 #include <headerssync.h>
 #include <index/blockfilterindex.h>
+#include <index/txindex.h>
 #include <kernel/chain.h>
 #include <logging.h>
 #include <merkleblock.h>
@@ -34,6 +35,7 @@
 #include <node/connection_types.h>
 #include <node/protocol_version.h>
 #include <node/timeoffsets.h>
+#include <node/transaction.h>
 #include <node/txdownloadman.h>
 #include <node/txorphanage.h>
 #include <node/txreconciliation.h>
@@ -48,6 +50,10 @@
 #include <random.h>
 #include <scheduler.h>
 #include <script/script.h>
+#include <segop/segop.h>
+#include <segop/segop_prune.h>
+#include <segop/segop_request.h>
+#include <segop/segop_store.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
@@ -57,6 +63,7 @@
 #include <uint256.h>
 #include <util/check.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 #include <util/time.h>
 #include <util/trace.h>
 #include <validation.h>
@@ -195,6 +202,12 @@ static constexpr double MAX_ADDR_RATE_PER_SECOND{0.1};
 static constexpr size_t MAX_ADDR_PROCESSING_TOKEN_BUCKET{MAX_ADDR_TO_SEND};
 /** The compactblocks version we support. See BIP 152. */
 static constexpr uint64_t CMPCTBLOCKS_VERSION{2};
+/** Maximum number of getsegopdata messages served to a peer per minute (segOP spec §11.9.2). */
+static constexpr size_t MAX_GETSEGOPDATA_PER_MINUTE{64};
+/** Maximum number of segOP payload bytes served to a peer per minute (segOP spec §11.9.2). */
+static constexpr size_t MAX_SEGOPDATA_BYTES_PER_MINUTE{256 * 1000};
+/** How long a reconstructed compact block waits for its segOP payloads before we fall back to downloading the full block. */
+static constexpr auto SEGOP_BLOCK_PAYLOAD_TIMEOUT{1min};
 
 // Internal stuff
 namespace {
@@ -382,6 +395,13 @@ struct Peer {
     /** Total number of addresses that were processed (excludes rate-limited ones). */
     std::atomic<uint64_t> m_addr_processed{0};
 
+    /** Start of the current one-minute window for segOP payload serving limits */
+    std::chrono::microseconds m_segop_serve_window_start GUARDED_BY(NetEventsInterface::g_msgproc_mutex){0};
+    /** Number of getsegopdata messages served in the current window */
+    size_t m_segop_requests_served GUARDED_BY(NetEventsInterface::g_msgproc_mutex){0};
+    /** Number of segOP payload bytes served in the current window */
+    size_t m_segop_bytes_served GUARDED_BY(NetEventsInterface::g_msgproc_mutex){0};
+
     /** Whether we've sent this peer a getheaders in response to an inv prior to initial-headers-sync completing */
     bool m_inv_triggered_getheaders_before_sync GUARDED_BY(NetEventsInterface::g_msgproc_mutex){false};
 
@@ -516,16 +536,16 @@ public:
     void BlockChecked(const std::shared_ptr<const CBlock>& block, const BlockValidationState& state) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void NewPoWValidBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& pblock) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, !m_peer_mutex);
 
     /** Implement NetEventsInterface */
     void InitializeNode(const CNode& node, ServiceFlags our_services) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_tx_download_mutex);
-    void FinalizeNode(const CNode& node) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, !m_tx_download_mutex);
+    void FinalizeNode(const CNode& node) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, !m_tx_download_mutex, !m_segop_request_mutex);
     bool HasAllDesirableServiceFlags(ServiceFlags services) const override;
     bool ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex, !m_segop_request_mutex);
     bool SendMessages(CNode* pto) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, g_msgproc_mutex, !m_tx_download_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, g_msgproc_mutex, !m_tx_download_mutex, !m_segop_request_mutex);
 
     /** Implement PeerManager */
     void StartScheduledTasks(CScheduler& scheduler) override;
@@ -545,7 +565,7 @@ public:
     void UnitTestMisbehaving(NodeId peer_id) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex) { Misbehaving(*Assert(GetPeerRef(peer_id)), ""); };
     void ProcessMessage(CNode& pfrom, const std::string& msg_type, DataStream& vRecv,
                         const std::chrono::microseconds time_received, const std::atomic<bool>& interruptMsgProc) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex, !m_segop_request_mutex);
     void UpdateLastBlockAnnounceTime(NodeId node, int64_t time_in_seconds) override;
     ServiceFlags GetDesirableServiceFlags(ServiceFlags services) const override;
 
@@ -767,6 +787,21 @@ private:
 
     std::unique_ptr<TxReconciliationTracker> m_txreconciliation;
 
+    /** Outstanding getsegopdata requests */
+    Mutex m_segop_request_mutex;
+    segop::SegopRequestTracker m_segop_requests GUARDED_BY(m_segop_request_mutex);
+
+    /** A reconstructed compact block whose segOP payloads are being fetched (segOP spec §11.6.2). */
+    struct SegopPendingBlock {
+        std::shared_ptr<CBlock> block;
+        /** The peer the block was received from, credited or blamed once it is processed */
+        NodeId peer;
+        /** Number of transactions still stripped of their payload */
+        size_t missing;
+        std::chrono::microseconds expiry;
+    };
+    std::map<uint256, SegopPendingBlock> m_segop_pending_blocks GUARDED_BY(m_segop_request_mutex);
+
     /** The height of the best chain */
     std::atomic<int> m_best_height{-1};
     /** The time of the best chain tip block */
@@ -950,10 +985,12 @@ private:
 
     /** Process a new block. Perform any post-processing housekeeping */
     void ProcessBlock(CNode& node, const std::shared_ptr<const CBlock>& block, bool force_processing, bool min_pow_checked);
+    /** Same, without crediting a peer. Returns whether the block was new. */
+    bool ProcessBlock(const std::shared_ptr<const CBlock>& block, bool force_processing, bool min_pow_checked);
 
     /** Process compact block txns  */
     void ProcessCompactBlockTxns(CNode& pfrom, Peer& peer, const BlockTransactions& block_transactions)
-        EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex, !m_most_recent_block_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex, !m_most_recent_block_mutex, !m_segop_request_mutex, !m_peer_mutex);
 
     /**
      * When a peer sends us a valid block, instruct it to announce blocks to us
@@ -1055,6 +1092,61 @@ private:
      */
     void ProcessGetCFCheckPt(CNode& node, Peer& peer, DataStream& vRecv);
 
+    /**
+     * Serve a getsegopdata request (segOP spec §11.4) from the most recent
+     * block, the mempool or the payload store, subject to the per-peer
+     * limits of §11.9.2. Payloads we can't or won't serve are reported with
+     * a notfound message.
+     */
+    void ProcessGetSegopData(CNode& pfrom, Peer& peer, const std::vector<Txid>& txids, std::chrono::microseconds now)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, NetEventsInterface::g_msgproc_mutex);
+
+    /** Find the segOP payload of `txid` for a getsegopdata request, if we can serve it to `peer`. */
+    std::optional<CSegopPayload> FindSegopPayloadForGetData(Peer& peer, const Txid& txid)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex, NetEventsInterface::g_msgproc_mutex);
+
+    /**
+     * Fetch segOP payloads from peers signalling NODE_SOP_RECENT or
+     * NODE_SOP_ARCHIVE with getsegopdata. Each txid comes with the P2SOP
+     * commitment the payload must match, and `height` is the height of the
+     * block that confirmed them.
+     */
+    void FetchSegopPayloads(const std::vector<std::pair<Txid, uint256>>& payloads, int height)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_segop_request_mutex);
+
+    /**
+     * Handle a payload fetched through getsegopdata that matched its P2SOP
+     * commitment by completing the compact blocks waiting for it. A completed
+     * block is processed on behalf of the peer it came from.
+     */
+    void ProcessSegopPayload(const Txid& txid, const CSegopPayload& payload, int height)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_segop_request_mutex);
+
+    enum class SegopFetch {
+        COMPLETE,    //!< No payload is missing; process the block now
+        FETCHING,    //!< The block is held back until its payloads arrive
+        UNAVAILABLE, //!< No peer can serve the payloads; download the block in full
+    };
+
+    /**
+     * If a reconstructed compact block lacks segOP payloads, hold it back and
+     * request them with getsegopdata instead of processing it. The block stays
+     * in flight meanwhile. If it is already held back, `peer` is not recorded:
+     * the block remains attributed to the peer it first came from.
+     */
+    SegopFetch MaybeFetchSegopPayloadsForBlock(const std::shared_ptr<CBlock>& block, int height, NodeId peer, std::chrono::microseconds now)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_segop_request_mutex, !m_peer_mutex);
+
+    /** Whether any peer can serve segOP payloads, of blocks beyond the validation window if `archive_only`. */
+    bool HaveSegopPayloadPeer(bool archive_only) const EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
+
+    /** Give up on compact blocks whose payloads did not arrive in time; they are downloaded in full instead. */
+    void ExpireSegopPendingBlocks(std::chrono::microseconds now)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_segop_request_mutex, !cs_main);
+
+    /** Signal NODE_SOP_RECENT / NODE_SOP_ARCHIVE according to what the payload store holds at `tip_height`. */
+    void UpdateSegopServices(int tip_height);
+
     /** Checks if address relay is permitted with peer. If needed, initializes
      * the m_addr_known bloom filter and sets m_addr_relay_enabled to true.
      *
@@ -1627,6 +1719,7 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
         m_txdownloadman.DisconnectedPeer(nodeid);
     }
     if (m_txreconciliation) m_txreconciliation->ForgetPeer(nodeid);
+    WITH_LOCK(m_segop_request_mutex, m_segop_requests.DisconnectedPeer(nodeid));
     m_num_preferred_download_peers -= state->fPreferredDownload;
     m_peers_downloading_from -= (!state->vBlocksInFlight.empty());
     assert(m_peers_downloading_from >= 0);
@@ -1916,6 +2009,8 @@ void PeerManagerImpl::StartScheduledTasks(CScheduler& scheduler)
     // schedule next run for 10-15 minutes in the future
     const auto delta = 10min + FastRandomContext().randrange<std::chrono::milliseconds>(5min);
     scheduler.scheduleFromNow([&] { ReattemptInitialBroadcast(scheduler); }, delta);
+
+    UpdateSegopServices(m_best_height);
 }
 
 void PeerManagerImpl::ActiveTipChange(const CBlockIndex& new_tip, bool is_ibd)
@@ -1993,6 +2088,12 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
     uint256 hashBlock(pblock->GetHash());
     const std::shared_future<CSerializedNetMsg> lazy_ser{
         std::async(std::launch::deferred, [&] { return NetMsg::Make(NetMsgType::CMPCTBLOCK, *pcmpctblock); })};
+    // Peers that can fetch segOP payloads get the coinbase without its own.
+    const bool has_segop_coinbase{!pblock->vtx[0]->segop_payload.IsNull()};
+    const std::shared_future<CSerializedNetMsg> lazy_ser_segop_stripped{
+        std::async(std::launch::deferred, [&] {
+            return NetMsg::Make(NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs{*pblock, FastRandomContext().rand64(), /*strip_segop=*/true});
+        })};
 
     {
         auto most_recent_block_txs = std::make_unique<std::map<GenTxid, CTransactionRef>>();
@@ -2008,7 +2109,7 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
         m_most_recent_block_txs = std::move(most_recent_block_txs);
     }
 
-    m_connman.ForEachNode([this, pindex, &lazy_ser, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+    m_connman.ForEachNode([this, pindex, &lazy_ser, &lazy_ser_segop_stripped, has_segop_coinbase, &hashBlock](CNode* pnode) EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
         AssertLockHeld(::cs_main);
 
         if (pnode->GetCommonVersion() < INVALID_CB_NO_BAN_VERSION || pnode->fDisconnect)
@@ -2022,7 +2123,9 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
             LogDebug(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", "PeerManager::NewPoWValidBlock",
                     hashBlock.ToString(), pnode->GetId());
 
-            const CSerializedNetMsg& ser_cmpctblock{lazy_ser.get()};
+            const PeerRef peer{has_segop_coinbase ? GetPeerRef(pnode->GetId()) : nullptr};
+            const bool strip_segop{peer && (peer->m_their_services & (NODE_SOP_RECENT | NODE_SOP_ARCHIVE))};
+            const CSerializedNetMsg& ser_cmpctblock{(strip_segop ? lazy_ser_segop_stripped : lazy_ser).get()};
             PushMessage(*pnode, ser_cmpctblock.Copy());
             state.pindexBestHeaderSent = pindex;
         }
@@ -2036,6 +2139,7 @@ void PeerManagerImpl::NewPoWValidBlock(const CBlockIndex *pindex, const std::sha
 void PeerManagerImpl::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload)
 {
     SetBestBlock(pindexNew->nHeight, std::chrono::seconds{pindexNew->GetBlockTime()});
+    UpdateSegopServices(pindexNew->nHeight);
 
     // Don't relay inventory during initial block download.
     if (fInitialDownload) return;
@@ -2141,6 +2245,152 @@ void PeerManagerImpl::RelayTransaction(const Txid& txid, const Wtxid& wtxid)
     }
 }
 
+void PeerManagerImpl::FetchSegopPayloads(const std::vector<std::pair<Txid, uint256>>& payloads, int height)
+{
+    // Payloads beyond the validation window are only held by archive nodes.
+    const bool archive_only{!segop::IsInValidationWindow(m_best_height, height)};
+    LOCK(m_segop_request_mutex);
+    for (const auto& [txid, commitment] : payloads) {
+        m_segop_requests.Want(txid, {.commitment = commitment, .height = height, .archive_only = archive_only});
+    }
+}
+
+void PeerManagerImpl::ProcessSegopPayload(const Txid& txid, const CSegopPayload& payload, int height)
+{
+    std::vector<std::pair<std::shared_ptr<const CBlock>, NodeId>> completed;
+    {
+        LOCK(m_segop_request_mutex);
+        for (auto it = m_segop_pending_blocks.begin(); it != m_segop_pending_blocks.end();) {
+            SegopPendingBlock& pending{it->second};
+            for (CTransactionRef& tx : pending.block->vtx) {
+                if (tx->GetHash() != txid || !segop::IsPayloadStripped(*tx)) continue;
+                CMutableTransaction mtx{*tx};
+                mtx.segop_payload = payload;
+                tx = MakeTransactionRef(std::move(mtx));
+                --pending.missing;
+            }
+            if (pending.missing == 0) {
+                completed.emplace_back(std::move(pending.block), pending.peer);
+                it = m_segop_pending_blocks.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    for (const auto& [block, source] : completed) {
+        LogDebug(BCLog::CMPCTBLOCK, "Fetched all segOP payloads for block %s\n", block->GetHash().ToString());
+        // The block was requested (it is in flight from the peer that sent
+        // the compact block), so process it as such; see the compact block
+        // handler. mapBlockSource names that peer, and it, not whoever sent
+        // the last payload, is credited with the block.
+        if (ProcessBlock(block, /*force_processing=*/true, /*min_pow_checked=*/true)) {
+            m_connman.ForNode(source, [](CNode* node) {
+                node->m_last_block_time = GetTime<std::chrono::seconds>();
+                return true;
+            });
+        }
+    }
+}
+
+bool PeerManagerImpl::HaveSegopPayloadPeer(bool archive_only) const
+{
+    const ServiceFlags wanted{archive_only ? NODE_SOP_ARCHIVE : ServiceFlags(NODE_SOP_RECENT | NODE_SOP_ARCHIVE)};
+    LOCK(m_peer_mutex);
+    return std::ranges::any_of(m_peer_map, [&](const auto& entry) { return entry.second->m_their_services & wanted; });
+}
+
+PeerManagerImpl::SegopFetch PeerManagerImpl::MaybeFetchSegopPayloadsForBlock(const std::shared_ptr<CBlock>& block, int height, NodeId peer, std::chrono::microseconds now)
+{
+    // Payloads are content-addressed: bytes we already hold under another
+    // txid (a rebroadcast, repeated metadata) need not be fetched again.
+    const auto& segop_store{m_chainman.m_blockman.m_segop_store};
+    for (CTransactionRef& tx : block->vtx) {
+        if (!segop::IsPayloadStripped(*tx)) continue;
+        const auto commitment{segop::GetPayloadCommitment(*tx)};
+        if (!commitment) continue;
+        auto payload{m_mempool.GetSegopPayload(*commitment)};
+        if (!payload && segop_store) payload = segop_store->ReadPayloadByCommitment(*commitment);
+        if (!payload || SegopCommitment(payload->data) != *commitment) continue;
+        CMutableTransaction mtx{*tx};
+        mtx.segop_payload = std::move(*payload);
+        tx = MakeTransactionRef(std::move(mtx));
+    }
+
+    const auto stripped{segop::GetStrippedPayloads(*block)};
+    if (stripped.empty()) return SegopFetch::COMPLETE;
+
+    // With no peer to ask, waiting would only delay the full download.
+    if (!HaveSegopPayloadPeer(/*archive_only=*/!segop::IsInValidationWindow(m_best_height, height))) {
+        LogDebug(BCLog::CMPCTBLOCK, "No peer to fetch %u segOP payloads for block %s from\n", stripped.size(), block->GetHash().ToString());
+        return SegopFetch::UNAVAILABLE;
+    }
+
+    {
+        LOCK(m_segop_request_mutex);
+        const auto [it, inserted]{m_segop_pending_blocks.try_emplace(block->GetHash(),
+            SegopPendingBlock{.block = block, .peer = peer, .missing = stripped.size(), .expiry = now + SEGOP_BLOCK_PAYLOAD_TIMEOUT})};
+        if (!inserted) return SegopFetch::FETCHING;
+    }
+    LogDebug(BCLog::CMPCTBLOCK, "Fetching %u segOP payloads for block %s from peers\n", stripped.size(), block->GetHash().ToString());
+    FetchSegopPayloads(stripped, height);
+    return SegopFetch::FETCHING;
+}
+
+void PeerManagerImpl::ExpireSegopPendingBlocks(std::chrono::microseconds now)
+{
+    std::vector<std::pair<uint256, NodeId>> expired;
+    {
+        LOCK(m_segop_request_mutex);
+        for (auto it = m_segop_pending_blocks.begin(); it != m_segop_pending_blocks.end();) {
+            if (it->second.expiry > now) {
+                ++it;
+                continue;
+            }
+            for (const auto& [txid, commitment] : segop::GetStrippedPayloads(*it->second.block)) {
+                m_segop_requests.ForgetTxid(txid);
+            }
+            expired.emplace_back(it->first, it->second.peer);
+            it = m_segop_pending_blocks.erase(it);
+        }
+    }
+    if (expired.empty()) return;
+
+    LOCK(cs_main);
+    for (const auto& [hash, peer] : expired) {
+        LogDebug(BCLog::CMPCTBLOCK, "Timed out fetching segOP payloads for block %s, peer=%d\n", hash.ToString(), peer);
+        // Once no longer in flight, from whichever peers, the block is
+        // downloaded in full like any other.
+        RemoveBlockRequest(hash, std::nullopt);
+    }
+}
+
+void PeerManagerImpl::UpdateSegopServices(int tip_height)
+{
+    if (tip_height < 0) return;
+
+    // Without a payload store, confirmed payloads can only be looked up
+    // through the transaction index, which requires unpruned blocks.
+    const auto& segop_store{m_chainman.m_blockman.m_segop_store};
+    const int min_retained_height{segop_store ? segop_store->MinRetainedHeight() :
+                                  g_txindex   ? 0 :
+                                                std::numeric_limits<int>::max()};
+    ServiceFlags services{NODE_NONE};
+    if (segop::CoversValidationWindow(min_retained_height, tip_height)) {
+        services = ServiceFlags(services | NODE_SOP_RECENT);
+    }
+    if (min_retained_height == 0 && !segop::IsPruneEnabled()) {
+        services = ServiceFlags(services | NODE_SOP_ARCHIVE);
+    }
+
+    const ServiceFlags current{ServiceFlags(m_connman.GetLocalServices() & (NODE_SOP_RECENT | NODE_SOP_ARCHIVE))};
+    if (current == services) return;
+    LogDebug(BCLog::NET, "segOP payloads retained from height %d, signalling services %s\n",
+             min_retained_height, util::Join(serviceFlagsToStr(services), ", "));
+    m_connman.RemoveLocalServices(ServiceFlags(current & ~services));
+    m_connman.AddLocalServices(services);
+}
+
 void PeerManagerImpl::RelayAddress(NodeId originator,
                                    const CAddress& addr,
                                    bool fReachable)
@@ -2261,6 +2511,13 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
         if (!(pindex->nStatus & BLOCK_HAVE_DATA)) {
             return;
         }
+        // A block whose segOP payloads have been pruned would fail the
+        // P2SOP coupling check on the receiving side, so don't send it.
+        if (!inv.IsMsgSegopStrippedBlk() && m_chainman.m_blockman.IsSegopPayloadPruned(*pindex)) {
+            LogDebug(BCLog::NET, "Ignore block request for block with pruned segOP payloads, %s\n", pfrom.DisconnectMsg(fLogIPs));
+            pfrom.fDisconnect = true;
+            return;
+        }
         can_direct_fetch = CanDirectFetch();
         block_pos = pindex->GetBlockPos();
     }
@@ -2302,6 +2559,8 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
             MakeAndPushMessage(pfrom, NetMsgType::BLOCK, TX_NO_WITNESS(*pblock));
         } else if (inv.IsMsgWitnessBlk()) {
             MakeAndPushMessage(pfrom, NetMsgType::BLOCK, TX_WITH_WITNESS(*pblock));
+        } else if (inv.IsMsgSegopStrippedBlk()) {
+            MakeAndPushMessage(pfrom, NetMsgType::BLOCK, TX_WITH_WITNESS_NO_SEGOP(*pblock));
         } else if (inv.IsMsgFilteredBlk()) {
             bool sendMerkleBlock = false;
             CMerkleBlock merkleBlock;
@@ -2331,10 +2590,12 @@ void PeerManagerImpl::ProcessGetBlockData(CNode& pfrom, Peer& peer, const CInv&
             // and we don't feel like constructing the object for them, so
             // instead we respond with the full, non-compact block.
             if (can_direct_fetch && pindex->nHeight >= tip->nHeight - MAX_CMPCTBLOCK_DEPTH) {
-                if (a_recent_compact_block && a_recent_compact_block->header.GetHash() == inv.hash) {
+                // Peers that can fetch segOP payloads get the coinbase without its own.
+                const bool strip_segop{!pblock->vtx[0]->segop_payload.IsNull() && (peer.m_their_services & (NODE_SOP_RECENT | NODE_SOP_ARCHIVE))};
+                if (a_recent_compact_block && a_recent_compact_block->header.GetHash() == inv.hash && !strip_segop) {
                     MakeAndPushMessage(pfrom, NetMsgType::CMPCTBLOCK, *a_recent_compact_block);
                 } else {
-                    CBlockHeaderAndShortTxIDs cmpctblock{*pblock, m_rng.rand64()};
+                    CBlockHeaderAndShortTxIDs cmpctblock{*pblock, m_rng.rand64(), strip_segop};
                     MakeAndPushMessage(pfrom, NetMsgType::CMPCTBLOCK, cmpctblock);
                 }
             } else {
@@ -2382,6 +2643,93 @@ CTransactionRef PeerManagerImpl::FindTxForGetData(const Peer::TxRelay& tx_relay,
     return {};
 }
 
+std::optional<CSegopPayload> PeerManagerImpl::FindSegopPayloadForGetData(Peer& peer, const Txid& txid)
+{
+    // Recently announced or mined transactions, under the same rules as a
+    // getdata for the transaction itself.
+    if (auto tx_relay = peer.GetTxRelay()) {
+        if (auto tx{FindTxForGetData(*tx_relay, GenTxid{txid})}; tx && !tx->segop_payload.IsNull()) {
+            return tx->segop_payload;
+        }
+    }
+
+    // Confirmed transactions within our retention window.
+    if (const auto& segop_store{m_chainman.m_blockman.m_segop_store}) {
+        return segop_store->ReadPayload(txid);
+    }
+
+    // The block we just announced, which the peer most likely asks about,
+    // is in memory. Any other takes a single transaction index lookup: full
+    // blocks are never read for a getsegopdata request.
+    if (const auto block{WITH_LOCK(m_most_recent_block_mutex, return m_most_recent_block)}) {
+        for (const CTransactionRef& tx : block->vtx) {
+            if (tx->GetHash() == txid) {
+                if (tx->segop_payload.IsNull()) return std::nullopt;
+                return tx->segop_payload;
+            }
+        }
+    }
+    if (!g_txindex) return std::nullopt;
+    uint256 block_hash;
+    if (const auto tx{node::GetTransaction(/*block_index=*/nullptr, /*mempool=*/nullptr, txid, block_hash, m_chainman.m_blockman)};
+        tx && !tx->segop_payload.IsNull()) {
+        return tx->segop_payload;
+    }
+    return std::nullopt;
+}
+
+void PeerManagerImpl::ProcessGetSegopData(CNode& pfrom, Peer& peer, const std::vector<Txid>& txids, std::chrono::microseconds now)
+{
+    if (now - peer.m_segop_serve_window_start >= 1min) {
+        peer.m_segop_serve_window_start = now;
+        peer.m_segop_requests_served = 0;
+        peer.m_segop_bytes_served = 0;
+    }
+    const bool rate_limited{!pfrom.HasPermission(NetPermissionFlags::Download)};
+
+    std::vector<CInv> not_found;
+    if (rate_limited && ++peer.m_segop_requests_served > MAX_GETSEGOPDATA_PER_MINUTE) {
+        LogDebug(BCLog::NET, "getsegopdata rate limit reached, not serving peer=%d\n", pfrom.GetId());
+        for (const Txid& txid : txids) {
+            not_found.emplace_back(MSG_SOPDATA, txid.ToUint256());
+        }
+        MakeAndPushMessage(pfrom, NetMsgType::NOTFOUND, not_found);
+        return;
+    }
+
+    std::vector<segop::SegopDataEntry> entries;
+    size_t entries_bytes{0};
+    for (const Txid& txid : txids) {
+        auto payload{FindSegopPayloadForGetData(peer, txid)};
+        if (!payload) {
+            not_found.emplace_back(MSG_SOPDATA, txid.ToUint256());
+            continue;
+        }
+        segop::SegopDataEntry entry{.txid = txid, .payload = std::move(*payload)};
+        const size_t entry_bytes{GetSerializeSize(entry)};
+        if (rate_limited && peer.m_segop_bytes_served + entry_bytes > MAX_SEGOPDATA_BYTES_PER_MINUTE) {
+            not_found.emplace_back(MSG_SOPDATA, txid.ToUint256());
+            continue;
+        }
+        if (!entries.empty() && (entries.size() >= segop::MAX_SEGOPDATA_ENTRIES ||
+                                 entries_bytes + entry_bytes > segop::MAX_SEGOPDATA_MSG_BYTES)) {
+            MakeAndPushMessage(pfrom, NetMsgType::SEGOPDATA, entries);
+            entries.clear();
+            entries_bytes = 0;
+        }
+        peer.m_segop_bytes_served += entry_bytes;
+        entries_bytes += entry_bytes;
+        entries.push_back(std::move(entry));
+    }
+
+    if (!entries.empty()) {
+        MakeAndPushMessage(pfrom, NetMsgType::SEGOPDATA, entries);
+    }
+    if (!not_found.empty()) {
+        MakeAndPushMessage(pfrom, NetMsgType::NOTFOUND, not_found);
+    }
+}
+
 void PeerManagerImpl::ProcessGetData(CNode& pfrom, Peer& peer, const std::atomic<bool>& interruptMsgProc)
 {
     AssertLockNotHeld(cs_main);
@@ -3283,11 +3631,17 @@ void PeerManagerImpl::ProcessGetCFCheckPt(CNode& node, Peer& peer, DataStream& v
 }
 
 void PeerManagerImpl::ProcessBlock(CNode& node, const std::shared_ptr<const CBlock>& block, bool force_processing, bool min_pow_checked)
+{
+    if (ProcessBlock(block, force_processing, min_pow_checked)) {
+        node.m_last_block_time = GetTime<std::chrono::seconds>();
+    }
+}
+
+bool PeerManagerImpl::ProcessBlock(const std::shared_ptr<const CBlock>& block, bool force_processing, bool min_pow_checked)
 {
     bool new_block{false};
     m_chainman.ProcessNewBlock(block, force_processing, min_pow_checked, &new_block);
     if (new_block) {
-        node.m_last_block_time = GetTime<std::chrono::seconds>();
         // In case this block came from a different peer than we requested
         // from, we can erase the block request now anyway (as we just stored
         // this block to disk).
@@ -3297,6 +3651,7 @@ void PeerManagerImpl::ProcessBlock(CNode& node, const std::shared_ptr<const CBlo
         LOCK(cs_main);
         mapBlockSource.erase(block->GetHash());
     }
+    return new_block;
 }
 
 void PeerManagerImpl::ProcessCompactBlockTxns(CNode& pfrom, Peer& peer, const BlockTransactions& block_transactions)
@@ -3343,6 +3698,12 @@ void PeerManagerImpl::ProcessCompactBlockTxns(CNode& pfrom, Peer& peer, const Bl
         const CBlockIndex* prev_block{Assume(m_chainman.m_blockman.LookupBlockIndex(partialBlock.header.hashPrevBlock))};
         ReadStatus status = partialBlock.FillBlock(*pblock, block_transactions.txn,
                                                    /*segwit_active=*/DeploymentActiveAfter(prev_block, m_chainman, Consensus::DEPLOYMENT_SEGWIT));
+        SegopFetch segop_fetch{SegopFetch::COMPLETE};
+        if (status == READ_STATUS_OK) {
+            segop_fetch = MaybeFetchSegopPayloadsForBlock(pblock, prev_block->nHeight + 1, pfrom.GetId(), GetTime<std::chrono::microseconds>());
+            // Payloads no peer can serve are in the full block.
+            if (segop_fetch == SegopFetch::UNAVAILABLE) status = READ_STATUS_FAILED;
+        }
         if (status == READ_STATUS_INVALID) {
             RemoveBlockRequest(block_transactions.blockhash, pfrom.GetId()); // Reset in-flight state in case Misbehaving does not result in a disconnect
             Misbehaving(peer, "invalid compact block/non-matching block transactions");
@@ -3361,6 +3722,11 @@ void PeerManagerImpl::ProcessCompactBlockTxns(CNode& pfrom, Peer& peer, const Bl
                 LogDebug(BCLog::NET, "Peer %d sent us a compact block but it failed to reconstruct, waiting on first download to complete\n", pfrom.GetId());
                 return;
             }
+        } else if (segop_fetch == SegopFetch::FETCHING) {
+            // Compact blocks carry no segOP payloads. The missing ones are
+            // fetched with getsegopdata and the block is processed once they
+            // are all in; until then it stays in flight from this peer.
+            mapBlockSource.emplace(block_transactions.blockhash, std::make_pair(pfrom.GetId(), false));
         } else {
             // Block is okay for further processing
             RemoveBlockRequest(block_transactions.blockhash, pfrom.GetId()); // it is now an empty pointer
@@ -4537,10 +4903,14 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         if (fBlockReconstructed) {
             // If we got here, we were able to optimistically reconstruct a
             // block that is in flight from some other peer.
+            const SegopFetch segop_fetch{MaybeFetchSegopPayloadsForBlock(pblock, pindex->nHeight, pfrom.GetId(), GetTime<std::chrono::microseconds>())};
+            // Payloads no peer can serve are left to the full download.
+            if (segop_fetch == SegopFetch::UNAVAILABLE) return;
             {
                 LOCK(cs_main);
                 mapBlockSource.emplace(pblock->GetHash(), std::make_pair(pfrom.GetId(), false));
             }
+            if (segop_fetch == SegopFetch::FETCHING) return;
             // Setting force_processing to true means that we bypass some of
             // our anti-DoS protections in AcceptBlock, which filters
             // unrequested blocks that might be trying to waste our resources
@@ -4905,17 +5275,65 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         return;
     }
 
+    if (msg_type == NetMsgType::GETSEGOPDATA) {
+        std::vector<Txid> txids;
+        vRecv >> txids;
+        if (txids.empty() || txids.size() > segop::MAX_GETSEGOPDATA_SIZE) {
+            Misbehaving(*peer, strprintf("getsegopdata message size = %u", txids.size()));
+            return;
+        }
+        if (std::set<Txid>(txids.begin(), txids.end()).size() != txids.size()) {
+            Misbehaving(*peer, "getsegopdata with duplicate txids");
+            return;
+        }
+        ProcessGetSegopData(pfrom, *peer, txids, time_received);
+        return;
+    }
+
+    if (msg_type == NetMsgType::SEGOPDATA) {
+        std::vector<segop::SegopDataEntry> entries;
+        vRecv >> entries;
+        if (entries.size() > segop::MAX_SEGOPDATA_ENTRIES) {
+            Misbehaving(*peer, strprintf("segopdata message size = %u", entries.size()));
+            return;
+        }
+        for (const auto& entry : entries) {
+            const auto wanted{WITH_LOCK(m_segop_request_mutex, return m_segop_requests.ReceivedResponse(pfrom.GetId(), entry.txid))};
+            if (!wanted) {
+                LogDebug(BCLog::NET, "Ignoring unsolicited segOP payload for %s from peer=%d\n", entry.txid.ToString(), pfrom.GetId());
+                continue;
+            }
+            if (entry.payload.version != CSegopPayload::SEGOP_VERSION || entry.payload.TooLarge() ||
+                SegopCommitment(entry.payload.data) != wanted->commitment) {
+                Misbehaving(*peer, strprintf("segOP payload for %s does not match its P2SOP commitment", entry.txid.ToString()));
+                return;
+            }
+            WITH_LOCK(m_segop_request_mutex, m_segop_requests.ForgetTxid(entry.txid));
+            ProcessSegopPayload(entry.txid, entry.payload, wanted->height);
+        }
+        return;
+    }
+
     if (msg_type == NetMsgType::NOTFOUND) {
         std::vector<CInv> vInv;
         vRecv >> vInv;
         std::vector<GenTxid> tx_invs;
+        std::vector<Txid> sop_invs;
         if (vInv.size() <= node::MAX_PEER_TX_ANNOUNCEMENTS + MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
             for (CInv &inv : vInv) {
                 if (inv.IsGenTxMsg()) {
                     tx_invs.emplace_back(ToGenTxid(inv));
+                } else if (inv.IsMsgSopData()) {
+                    sop_invs.push_back(Txid::FromUint256(inv.hash));
                 }
             }
         }
+        if (!sop_invs.empty()) {
+            LOCK(m_segop_request_mutex);
+            for (const Txid& txid : sop_invs) {
+                m_segop_requests.ReceivedResponse(pfrom.GetId(), txid);
+            }
+        }
         LOCK(m_tx_download_mutex);
         m_txdownloadman.ReceivedNotFound(pfrom.GetId(), tx_invs);
         return;
@@ -5625,11 +6043,17 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     LogDebug(BCLog::NET, "%s sending header-and-ids %s to peer=%d\n", __func__,
                             vHeaders.front().GetHash().ToString(), pto->GetId());
 
+                    // Peers that can fetch segOP payloads get the coinbase without its own.
+                    const bool segop_peer{(peer->m_their_services & (NODE_SOP_RECENT | NODE_SOP_ARCHIVE)) != 0};
                     std::optional<CSerializedNetMsg> cached_cmpctblock_msg;
                     {
                         LOCK(m_most_recent_block_mutex);
                         if (m_most_recent_block_hash == pBestIndex->GetBlockHash()) {
-                            cached_cmpctblock_msg = NetMsg::Make(NetMsgType::CMPCTBLOCK, *m_most_recent_compact_block);
+                            if (segop_peer && !m_most_recent_block->vtx[0]->segop_payload.IsNull()) {
+                                cached_cmpctblock_msg = NetMsg::Make(NetMsgType::CMPCTBLOCK, CBlockHeaderAndShortTxIDs{*m_most_recent_block, m_rng.rand64(), /*strip_segop=*/true});
+                            } else {
+                                cached_cmpctblock_msg = NetMsg::Make(NetMsgType::CMPCTBLOCK, *m_most_recent_compact_block);
+                            }
                         }
                     }
                     if (cached_cmpctblock_msg.has_value()) {
@@ -5638,7 +6062,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         CBlock block;
                         const bool ret{m_chainman.m_blockman.ReadBlock(block, *pBestIndex)};
                         assert(ret);
-                        CBlockHeaderAndShortTxIDs cmpctblock{block, m_rng.rand64()};
+                        CBlockHeaderAndShortTxIDs cmpctblock{block, m_rng.rand64(), segop_peer};
                         MakeAndPushMessage(*pto, NetMsgType::CMPCTBLOCK, cmpctblock);
                     }
                     state.pindexBestHeaderSent = pBestIndex;
@@ -5913,6 +6337,12 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
             }
             for (const CBlockIndex *pindex : vToDownload) {
                 uint32_t nFetchFlags = GetFetchFlags(*peer);
+                // Buried blocks need not carry their segOP payloads under
+                // -segoplightibd, if the peer understands the request.
+                if ((nFetchFlags & MSG_WITNESS_FLAG) && (peer->m_their_services & (NODE_SOP_RECENT | NODE_SOP_ARCHIVE)) &&
+                    m_chainman.IsSegopPayloadAssumed(*pindex)) {
+                    nFetchFlags |= MSG_SEGOP_STRIPPED_FLAG;
+                }
                 vGetData.emplace_back(MSG_BLOCK | nFetchFlags, pindex->GetBlockHash());
                 BlockRequested(pto->GetId(), *pindex);
                 LogDebug(BCLog::NET, "Requesting block %s (%d) peer=%d\n", pindex->GetBlockHash().ToString(),
@@ -5943,6 +6373,19 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         if (!vGetData.empty())
             MakeAndPushMessage(*pto, NetMsgType::GETDATA, vGetData);
     } // release cs_main
+
+    //
+    // Message: getsegopdata
+    //
+    ExpireSegopPendingBlocks(current_time);
+    if (const ServiceFlags their_services{peer->m_their_services}; their_services & (NODE_SOP_RECENT | NODE_SOP_ARCHIVE)) {
+        const std::vector<Txid> txids{WITH_LOCK(m_segop_request_mutex,
+            return m_segop_requests.GetRequestable(pto->GetId(), their_services & NODE_SOP_ARCHIVE, current_time))};
+        if (!txids.empty()) {
+            MakeAndPushMessage(*pto, NetMsgType::GETSEGOPDATA, txids);
+        }
+    }
+
     MaybeSendFeefilter(*pto, *peer, current_time);
     return true;
 }
@@ -5,10 +5,13 @@
 #include <node/blockmanager_args.h>
 
 #include <common/args.h>
+#include <kernel/chainstatemanager_opts.h>
 #include <node/blockstorage.h>
 #include <node/database_args.h>
+#include <segop/segop.h>
 #include <tinyformat.h>
 #include <util/result.h>
+#include <util/strencodings.h>
 #include <util/translation.h>
 #include <validation.h>
 
@@ -34,6 +37,34 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, BlockManager::Op
     opts.prune_target = nPruneTarget;
 
     if (auto value{args.GetBoolArg("-fastprune")}) opts.fast_prune = *value;
+    if (auto value{args.GetBoolArg("-segopprune")}) opts.segop_store = *value;
+    // Blocks downloaded without their payloads are recorded as such in the store.
+    if (args.GetBoolArg("-segoplightibd", DEFAULT_SEGOP_LIGHT_IBD)) opts.segop_store = true;
+
+    for (const std::string& type : args.GetArgs("-segopcompress")) {
+        // Checked first, as it would otherwise be taken for TLV type 0.
+        if (type == "0") continue;
+        if (type.empty() || type == "1") {
+            opts.segop_compression.tlv_types.insert({SegopTlvType::TEXT_UTF8, SegopTlvType::JSON_UTF8});
+        } else if (type == "text") {
+            opts.segop_compression.tlv_types.insert(SegopTlvType::TEXT_UTF8);
+        } else if (type == "json") {
+            opts.segop_compression.tlv_types.insert(SegopTlvType::JSON_UTF8);
+        } else if (type == "binary") {
+            opts.segop_compression.tlv_types.insert(SegopTlvType::BINARY_BLOB);
+        } else if (const auto code{ToIntegral<uint8_t>(type)}) {
+            opts.segop_compression.tlv_types.insert(*code);
+        } else {
+            return util::Error{strprintf(_("Unknown segOP TLV type -segopcompress=%s."), type)};
+        }
+    }
+    if (!opts.segop_compression.tlv_types.empty() && !opts.segop_store) {
+        return util::Error{_("-segopcompress requires a segOP payload store (-segopprune or -segoplightibd).")};
+    }
+    if (auto value{args.GetIntArg("-segopcompressmin")}) {
+        if (*value < 0) return util::Error{_("-segopcompressmin cannot be negative.")};
+        opts.segop_compression.min_size = *value;
+    }
 
     ReadDatabaseArgs(args, opts.block_tree_db_params.options);
 
@@ -584,6 +584,18 @@ bool BlockManager::IsBlockPruned(const CBlockIndex& block) const
     return m_have_pruned && !(block.nStatus & BLOCK_HAVE_DATA) && (block.nTx > 0);
 }
 
+bool BlockManager::IsSegopPayloadPruned(const CBlockIndex& block) const
+{
+    AssertLockHeld(::cs_main);
+    return (block.nStatus & BLOCK_HAVE_DATA) && IsSegopPayloadPruned(block.GetBlockPos(), block.nHeight);
+}
+
+bool BlockManager::IsSegopPayloadPruned(const FlatFilePos& pos, int height) const
+{
+    if (!m_segop_store || height >= m_segop_store->MinRetainedHeight()) return false;
+    return m_segop_store->IsStrippedBlock(pos);
+}
+
 const CBlockIndex* BlockManager::GetFirstBlock(const CBlockIndex& upper_block, uint32_t status_mask, const CBlockIndex* lower_block) const
 {
     AssertLockHeld(::cs_main);
@@ -722,6 +734,10 @@ bool BlockManager::FlushBlockFile(int blockfile_num, bool fFinalize, bool finali
         m_opts.notifications.flushError(_("Flushing block file to disk failed. This is likely the result of an I/O error."));
         success = false;
     }
+    if (m_segop_store && !m_segop_store->Flush(fFinalize)) {
+        m_opts.notifications.flushError(_("Flushing segOP payload file to disk failed. This is likely the result of an I/O error."));
+        success = false;
+    }
     // we do not always flush the undo file, as the chain tip may be lagging behind the incoming blocks,
     // e.g. during IBD or a sync after a node going offline
     if (!fFinalize || finalize_undo) {
@@ -896,7 +912,9 @@ void BlockManager::UpdateBlockInfo(const CBlock& block, unsigned int nHeight, co
     }
 
     // Update the file information with the current block.
-    const unsigned int added_size = ::GetSerializeSize(TX_WITH_WITNESS(block));
+    const bool stripped{m_segop_store && m_segop_store->IsStrippedBlock(pos)};
+    const unsigned int added_size = stripped ? ::GetSerializeSize(TX_WITH_WITNESS_NO_SEGOP(block)) :
+                                               ::GetSerializeSize(TX_WITH_WITNESS(block));
     const int nFile = pos.nFile;
     if (static_cast<int>(m_blockfile_info.size()) <= nFile) {
         m_blockfile_info.resize(nFile + 1);
@@ -1003,7 +1021,7 @@ bool BlockManager::ReadBlock(CBlock& block, const FlatFilePos& pos, const std::o
 
     // Open history file to read
     std::vector<std::byte> block_data;
-    if (!ReadRawBlock(block_data, pos)) {
+    if (!ReadStoredBlock(block_data, pos)) {
         return false;
     }
 
@@ -1015,6 +1033,12 @@ bool BlockManager::ReadBlock(CBlock& block, const FlatFilePos& pos, const std::o
         return false;
     }
 
+    // Re-attach segOP payloads. Once they have been pruned the transactions
+    // stay stripped; txids, wtxids and the merkle root are unaffected.
+    if (m_segop_store && m_segop_store->IsStrippedBlock(pos) && !m_segop_store->AttachPayloads(block)) {
+        LogDebug(BCLog::PRUNE, "segOP payloads of block at %s are no longer available\n", pos.ToString());
+    }
+
     const auto block_hash{block.GetHash()};
 
     // Check the header
@@ -1045,6 +1069,31 @@ bool BlockManager::ReadBlock(CBlock& block, const CBlockIndex& index) const
 }
 
 bool BlockManager::ReadRawBlock(std::vector<std::byte>& block, const FlatFilePos& pos) const
+{
+    if (!ReadStoredBlock(block, pos)) {
+        return false;
+    }
+    if (!m_segop_store || !m_segop_store->IsStrippedBlock(pos)) {
+        return true;
+    }
+
+    // The record was written without segOP payloads; callers expect the
+    // network serialization, so re-hydrate it from the payload store.
+    try {
+        CBlock stripped;
+        SpanReader{block} >> TX_WITH_WITNESS(stripped);
+        m_segop_store->AttachPayloads(stripped);
+        DataStream hydrated;
+        hydrated << TX_WITH_WITNESS(stripped);
+        block.assign(hydrated.begin(), hydrated.end());
+    } catch (const std::exception& e) {
+        LogError("Deserialize or I/O error - %s at %s while reading raw block", e.what(), pos.ToString());
+        return false;
+    }
+    return true;
+}
+
+bool BlockManager::ReadStoredBlock(std::vector<std::byte>& block, const FlatFilePos& pos) const
 {
     if (pos.nPos < STORAGE_HEADER_BYTES) {
         // If nPos is less than STORAGE_HEADER_BYTES, we can't read the header that precedes the block data
@@ -1089,7 +1138,20 @@ bool BlockManager::ReadRawBlock(std::vector<std::byte>& block, const FlatFilePos
 
 FlatFilePos BlockManager::WriteBlock(const CBlock& block, int nHeight)
 {
-    const unsigned int block_size{static_cast<unsigned int>(GetSerializeSize(TX_WITH_WITNESS(block)))};
+    // With the segOP payload store active, payloads go to sop?????.dat and
+    // the block is stored without them so that they can be pruned separately.
+    uint32_t segop_stripped{0};
+    if (m_segop_store) {
+        const auto written{m_segop_store->WriteBlockPayloads(block, nHeight)};
+        if (!written) {
+            m_opts.notifications.fatalError(_("Failed to write segOP payloads."));
+            return FlatFilePos();
+        }
+        segop_stripped = *written;
+    }
+    const TransactionSerParams& ser_params{segop_stripped > 0 ? TX_WITH_WITNESS_NO_SEGOP : TX_WITH_WITNESS};
+
+    const unsigned int block_size{static_cast<unsigned int>(GetSerializeSize(ser_params(block)))};
     FlatFilePos pos{FindNextBlockPos(block_size + STORAGE_HEADER_BYTES, nHeight, block.GetBlockTime())};
     if (pos.IsNull()) {
         LogError("FindNextBlockPos failed for %s while writing block", pos.ToString());
@@ -1108,7 +1170,7 @@ FlatFilePos BlockManager::WriteBlock(const CBlock& block, int nHeight)
         fileout << GetParams().MessageStart() << block_size;
         pos.nPos += STORAGE_HEADER_BYTES;
         // Write block
-        fileout << TX_WITH_WITNESS(block);
+        fileout << ser_params(block);
     }
 
     if (file.fclose() != 0) {
@@ -1117,6 +1179,12 @@ FlatFilePos BlockManager::WriteBlock(const CBlock& block, int nHeight)
         return FlatFilePos();
     }
 
+    if (segop_stripped > 0 && !m_segop_store->MarkStrippedBlock(pos, segop_stripped)) {
+        LogError("Failed to record segOP payload location for block %s", pos.ToString());
+        m_opts.notifications.fatalError(_("Failed to write segOP payloads."));
+        return FlatFilePos();
+    }
+
     return pos;
 }
 
@@ -1187,6 +1255,23 @@ BlockManager::BlockManager(const util::SignalInterrupt& interrupt, Options opts)
 {
     m_block_tree_db = std::make_unique<BlockTreeDB>(m_opts.block_tree_db_params);
 
+    // Once blocks have been written stripped, the store must stay open to
+    // read them back, even if -segopprune has since been turned off.
+    const fs::path segop_db_path{m_opts.blocks_dir / "segop"};
+    if (m_opts.segop_store || fs::exists(segop_db_path)) {
+        m_segop_store = std::make_unique<segop::PayloadStore>(
+            m_opts.blocks_dir,
+            DBParams{
+                .path = segop_db_path,
+                .cache_bytes = 1 << 20,
+                .memory_only = m_opts.block_tree_db_params.memory_only,
+                .options = m_opts.block_tree_db_params.options,
+            },
+            m_obfuscation,
+            m_opts.fast_prune,
+            m_opts.segop_compression);
+    }
+
     if (m_opts.block_tree_db_params.wipe_data) {
         m_block_tree_db->WriteReindexing(true);
         m_blockfiles_indexed = false;
@@ -14,6 +14,7 @@
 #include <kernel/cs_main.h>
 #include <kernel/messagestartchars.h>
 #include <primitives/block.h>
+#include <segop/segop_store.h>
 #include <streams.h>
 #include <sync.h>
 #include <uint256.h>
@@ -172,6 +173,9 @@ private:
 
     AutoFile OpenUndoFile(const FlatFilePos& pos, bool fReadOnly = false) const;
 
+    /** Read the blk record at `pos` exactly as stored, i.e. possibly with segOP payloads stripped. */
+    bool ReadStoredBlock(std::vector<std::byte>& block, const FlatFilePos& pos) const;
+
     /* Calculate the block/rev files to delete based on height specified by user with RPC command pruneblockchain */
     void FindFilesToPruneManual(
         std::set<int>& setFilesToPrune,
@@ -300,6 +304,9 @@ public:
 
     std::unique_ptr<BlockTreeDB> m_block_tree_db GUARDED_BY(::cs_main);
 
+    /** segOP payload store (sop?????.dat). Null unless -segopprune is, or was, enabled. */
+    std::unique_ptr<segop::PayloadStore> m_segop_store;
+
     bool WriteBlockIndexDB() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
     bool LoadBlockIndexDB(const std::optional<uint256>& snapshot_blockhash)
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
@@ -396,6 +403,11 @@ public:
     //! Check whether the block associated with this index entry is pruned or not.
     bool IsBlockPruned(const CBlockIndex& block) const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
+    //! Check whether the segOP payloads of this block have been pruned from the payload store.
+    bool IsSegopPayloadPruned(const CBlockIndex& block) const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    //! Same, for the block stored at `pos` at `height`, whether or not it is indexed yet (-reindex).
+    bool IsSegopPayloadPruned(const FlatFilePos& pos, int height) const;
+
     //! Create or update a prune lock identified by its name
     void UpdatePruneLock(const std::string& name, const PruneLockInfo& lock_info) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
@@ -17,6 +17,7 @@
 #include <node/warnings.h>
 #include <policy/fees.h>
 #include <scheduler.h>
+#include <segop/segop_retention.h>
 #include <txmempool.h>
 #include <validation.h>
 #include <validationinterface.h>
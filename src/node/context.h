@@ -35,6 +35,9 @@ class WalletLoader;
 namespace kernel {
 struct Context;
 }
+namespace segop {
+class RetentionManager;
+}
 namespace util {
 class SignalInterrupt;
 }
@@ -71,6 +74,8 @@ struct NodeContext {
     std::unique_ptr<PeerManager> peerman;
     std::unique_ptr<ChainstateManager> chainman;
     std::unique_ptr<BanMan> banman;
+    //! Applies the segOP retention windows to the payload store, if there is one.
+    std::unique_ptr<segop::RetentionManager> segop_retention;
     ArgsManager* args{nullptr}; // Currently a raw pointer because the memory is not managed by this struct
     std::vector<BaseIndex*> indexes; // raw pointers because memory is not managed by this struct
     std::unique_ptr<interfaces::Chain> chain;
@@ -53,6 +53,13 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& argsman, const CChainP
         mempool_opts.max_size_bytes = *mb * 1'000'000;
     }
 
+    if (auto mb = argsman.GetIntArg("-maxsegopmempool")) {
+        if (*mb < 0) {
+            return util::Error{Untranslated(strprintf("-maxsegopmempool is set to %i but can't be negative", *mb))};
+        }
+        mempool_opts.max_segop_size_bytes = *mb * 1'000'000;
+    }
+
     if (auto hours = argsman.GetIntArg("-mempoolexpiry")) mempool_opts.expiry = std::chrono::hours{*hours};
 
     // incremental relay fee sets the minimum feerate increase necessary for replacement in the mempool
@@ -23,6 +23,7 @@
 #include <pow.h>
 #include <primitives/transaction.h>
 #include <util/moneystr.h>
+#include <util/strencodings.h>
 #include <util/signalinterrupt.h>
 #include <util/time.h>
 #include <validation.h>
@@ -93,6 +94,16 @@ BlockAssembler::BlockAssembler(Chainstate& chainstate, const CTxMemPool* mempool
 {
 }
 
+std::optional<std::pair<segop::ARBDATier, uint64_t>> ParseARBDAMaxWeight(std::string_view arg)
+{
+    const auto sep{arg.find(':')};
+    if (sep == std::string_view::npos) return std::nullopt;
+    const auto tier{segop::ARBDATierFromString(arg.substr(0, sep))};
+    const auto weight{ToIntegral<uint64_t>(arg.substr(sep + 1))};
+    if (!tier || !weight) return std::nullopt;
+    return std::make_pair(*tier, *weight);
+}
+
 void ApplyArgsManOptions(const ArgsManager& args, BlockAssembler::Options& options)
 {
     // Block resource limits
@@ -102,6 +113,11 @@ void ApplyArgsManOptions(const ArgsManager& args, BlockAssembler::Options& optio
     }
     options.print_modified_fee = args.GetBoolArg("-printpriority", options.print_modified_fee);
     options.block_reserved_weight = args.GetIntArg("-blockreservedweight", options.block_reserved_weight);
+    for (const std::string& arg : args.GetArgs("-blockmaxarbdaweight")) {
+        if (const auto parsed{ParseARBDAMaxWeight(arg)}) {
+            options.max_arbda_weight[static_cast<size_t>(parsed->first)] = parsed->second;
+        }
+    }
 }
 
 void BlockAssembler::resetBlock()
@@ -111,6 +127,7 @@ void BlockAssembler::resetBlock()
     // Reserve space for fixed-size block header, txs count, and coinbase tx.
     nBlockWeight = m_options.block_reserved_weight;
     nBlockSigOpsCost = m_options.coinbase_output_max_additional_sigops;
+    m_arbda_weight.fill(0);
 
     // These counters do not include coinbase tx
     nBlockTx = 0;
@@ -217,6 +234,25 @@ bool BlockAssembler::TestPackage(uint64_t packageSize, int64_t packageSigOpsCost
     return true;
 }
 
+bool BlockAssembler::TestARBDAWeight(CTxMemPool::txiter iter) const
+{
+    const size_t tier{static_cast<size_t>(iter->GetARBDATier())};
+    return m_arbda_weight[tier] + iter->GetTxWeight() <= m_options.max_arbda_weight[tier];
+}
+
+bool BlockAssembler::TestPackageARBDAWeight(const CTxMemPool::setEntries& package) const
+{
+    std::array<uint64_t, 4> weight{m_arbda_weight};
+    for (CTxMemPool::txiter it : package) {
+        const size_t tier{static_cast<size_t>(it->GetARBDATier())};
+        weight[tier] += it->GetTxWeight();
+        if (weight[tier] > m_options.max_arbda_weight[tier]) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // Perform transaction-level checks before adding to block:
 // - transaction finality (locktime)
 bool BlockAssembler::TestPackageTransactions(const CTxMemPool::setEntries& package) const
@@ -235,6 +271,7 @@ void BlockAssembler::AddToBlock(CTxMemPool::txiter iter)
     pblocktemplate->vTxFees.push_back(iter->GetFee());
     pblocktemplate->vTxSigOpsCost.push_back(iter->GetSigOpCost());
     nBlockWeight += iter->GetTxWeight();
+    m_arbda_weight[static_cast<size_t>(iter->GetARBDATier())] += iter->GetTxWeight();
     ++nBlockTx;
     nBlockSigOpsCost += iter->GetSigOpCost();
     nFees += iter->GetFee();
@@ -405,13 +442,24 @@ void BlockAssembler::addPackageTxs(int& nPackagesSelected, int& nDescendantsUpda
             continue;
         }
 
+        // A transaction whose ARBDA tier has used up its weight budget can be
+        // skipped before computing its ancestors. Other tiers may still have
+        // room, so this does not count towards nConsecutiveFailed.
+        if (!TestARBDAWeight(iter)) {
+            if (fUsingModified) {
+                mapModifiedTx.get<ancestor_score>().erase(modit);
+                failedTx.insert(iter->GetSharedTx()->GetHash());
+            }
+            continue;
+        }
+
         auto ancestors{mempool.AssumeCalculateMemPoolAncestors(__func__, *iter, CTxMemPool::Limits::NoLimits(), /*fSearchForParents=*/false)};
 
         onlyUnconfirmed(ancestors);
         ancestors.insert(iter);
 
-        // Test if all tx's are Final
-        if (!TestPackageTransactions(ancestors)) {
+        // Test if all tx's are Final, and the ancestors fit their ARBDA tiers' budgets
+        if (!TestPackageTransactions(ancestors) || !TestPackageARBDAWeight(ancestors)) {
             if (fUsingModified) {
                 mapModifiedTx.get<ancestor_score>().erase(modit);
                 failedTx.insert(iter->GetSharedTx()->GetHash());
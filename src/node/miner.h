@@ -10,12 +10,17 @@
 #include <node/types.h>
 #include <policy/policy.h>
 #include <primitives/block.h>
+#include <segop/buds.h>
 #include <txmempool.h>
 #include <util/feefrac.h>
 
+#include <array>
 #include <cstdint>
+#include <limits>
 #include <memory>
 #include <optional>
+#include <string_view>
+#include <utility>
 
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/indexed_by.hpp>
@@ -157,6 +162,8 @@ private:
     uint64_t nBlockWeight;
     uint64_t nBlockTx;
     uint64_t nBlockSigOpsCost;
+    //! Weight of the block's transactions, by ARBDA tier (see Options::max_arbda_weight)
+    std::array<uint64_t, 4> m_arbda_weight;
     CAmount nFees;
     std::unordered_set<Txid, SaltedTxidHasher> inBlock;
 
@@ -176,6 +183,14 @@ public:
         // Whether to call TestBlockValidity() at the end of CreateNewBlock().
         bool test_block_validity{true};
         bool print_modified_fee{DEFAULT_PRINT_MODIFIED_FEE};
+        /**
+         * Maximum weight of transactions of each ARBDA tier in the block,
+         * indexed by segop::ARBDATier. Transactions without a segOP payload
+         * count as T0. Unlimited by default.
+         */
+        std::array<uint64_t, 4> max_arbda_weight{
+            std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max(),
+            std::numeric_limits<uint64_t>::max(), std::numeric_limits<uint64_t>::max()};
     };
 
     explicit BlockAssembler(Chainstate& chainstate, const CTxMemPool* mempool, const Options& options);
@@ -211,6 +226,10 @@ private:
     void onlyUnconfirmed(CTxMemPool::setEntries& testSet);
     /** Test if a new package would "fit" in the block */
     bool TestPackage(uint64_t packageSize, int64_t packageSigOpsCost) const;
+    /** Test if a transaction's own ARBDA tier still has room for it, without looking at its ancestors */
+    bool TestARBDAWeight(CTxMemPool::txiter iter) const;
+    /** Test if a package keeps every ARBDA tier within its weight budget */
+    bool TestPackageARBDAWeight(const CTxMemPool::setEntries& package) const;
     /** Perform checks on each transaction in a package:
       * locktime, premature-witness, serialized size (if necessary)
       * These checks should always succeed, and they're here
@@ -232,7 +251,10 @@ int64_t UpdateTime(CBlockHeader* pblock, const Consensus::Params& consensusParam
 /** Update an old GenerateCoinbaseCommitment from CreateNewBlock after the block txs have changed */
 void RegenerateCommitments(CBlock& block, ChainstateManager& chainman);
 
-/** Apply -blockmintxfee and -blockmaxweight options from ArgsManager to BlockAssembler options. */
+/** Parse a -blockmaxarbdaweight value of the form <tier>:<weight>, e.g. "T3:400000". */
+std::optional<std::pair<segop::ARBDATier, uint64_t>> ParseARBDAMaxWeight(std::string_view arg);
+
+/** Apply -blockmintxfee, -blockmaxweight and -blockmaxarbdaweight options from ArgsManager to BlockAssembler options. */
 void ApplyArgsManOptions(const ArgsManager& gArgs, BlockAssembler::Options& options);
 
 /* Compute the block's merkle root, insert or replace the coinbase transaction and the merkle root into the block */
@@ -11,6 +11,10 @@
 #include <uint256.h>
 #include <util/time.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
  * requirements.  When they solve the proof-of-work, they broadcast the block
@@ -87,9 +91,28 @@ public:
         *(static_cast<CBlockHeader*>(this)) = header;
     }
 
-    SERIALIZE_METHODS(CBlock, obj)
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << AsBase<CBlockHeader>(*this) << vtx;
+    }
+
+    /** Same encoding as Serialize, but all transactions are read before any is
+     *  constructed, so that the segOP payloads of the block are hashed
+     *  together (MakeTransactionRefs). */
+    template <typename Stream>
+    void Unserialize(Stream& s)
     {
-        READWRITE(AsBase<CBlockHeader>(obj), obj.vtx);
+        s >> AsBase<CBlockHeader>(*this);
+        const TransactionSerParams& params{s.template GetParams<TransactionSerParams>()};
+        const uint64_t count{ReadCompactSize(s)};
+        std::vector<CMutableTransaction> txs;
+        // Like vector deserialization, only allocate as far as the data goes.
+        txs.reserve(std::min<uint64_t>(count, MAX_VECTOR_ALLOCATE / sizeof(CMutableTransaction)));
+        for (uint64_t i{0}; i < count; ++i) {
+            txs.emplace_back(deserialize, params, s);
+        }
+        vtx = MakeTransactionRefs(std::move(txs));
     }
 
     void SetNull()
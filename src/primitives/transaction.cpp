@@ -99,10 +99,8 @@ CMutableTransaction::CMutableTransaction(const CTransaction& tx)
 
 Txid CMutableTransaction::GetHash() const
 {
-    // Hash of the transaction without witness (and without segwit discount).
-    // This helper is used internally by the wallet; consensus txid is defined
-    // by CTransaction::ComputeHash().
-    return Txid::FromUint256((HashWriter{} << TX_NO_WITNESS(*this)).GetHash());
+    // Must match CTransaction::ComputeHash(): no witness and no segOP.
+    return Txid::FromUint256((HashWriter{} << TX_NO_WITNESS_NO_SEGOP(*this)).GetHash());
 }
 
 /** CTransaction (internal helpers) *******************************************/
@@ -114,50 +112,63 @@ bool CTransaction::ComputeHasWitness() const
     });
 }
 
-Txid CTransaction::ComputeHash() const
+/** A writer primed with the "segop:fullxid" tag. */
+static const HashWriter& FullxidWriter()
 {
-    // Spec §7.2.1: txid is the legacy non-witness serialization that ignores
-    // marker, flag, witness *and segOP*. To preserve that behaviour, hash a
-    // copy of the transaction with segOP stripped.
-    CMutableTransaction tx_legacy{*this};
-    tx_legacy.segop_payload.SetNull();
-
-    return Txid::FromUint256((HashWriter{} << TX_NO_WITNESS(tx_legacy)).GetHash());
+    static const HashWriter FULLXID_WRITER{TaggedHash("segop:fullxid")};
+    return FULLXID_WRITER;
 }
 
-Wtxid CTransaction::ComputeWitnessHash() const
+CTransaction::Hashes CTransaction::ComputeHashes(const SegopHashes* segop_hashes) const
 {
-    // Spec §7.2.2 and BIP141: if there is no witness, wtxid == txid.
-    if (!HasWitness()) {
-        return Wtxid::FromUint256(hash.ToUint256());
-    }
-
-    // With witness: wtxid is computed over the extended-with-witness
-    // serialization *excluding segOP*. So we hash a copy with segOP stripped.
-    CMutableTransaction tx_extended{*this};
-    tx_extended.segop_payload.SetNull();
-
-    return Wtxid::FromUint256((HashWriter{} << TX_WITH_WITNESS(tx_extended)).GetHash());
-}
-
-Fullxid CTransaction::ComputeFullxid() const
-{
-    // Spec §7.2.3: fullxid = TAGGED_HASH("segop:fullxid", extended_serialization)
-    // where extended_serialization is the full extended wire format:
+    // Spec §7.2: the three ids cover overlapping parts of the extended
+    // serialization (see SerializeTransaction), so walk it once and route
+    // each section to the ids that commit to it:
     //
-    //   nVersion || marker || flag || vin || vout ||
-    //   [witness data, if present] ||
-    //   [segOP section, if present] ||
-    //   nLockTime
+    //   txid    = HASH256(nVersion || vin || vout || nLockTime)
+    //   wtxid   = HASH256(nVersion || marker || flag || vin || vout || witness || nLockTime)
+    //   fullxid = TAGGED_HASH("segop:fullxid", nVersion || marker || flag || vin || vout ||
+    //                                          witness || segOP section || nLockTime)
     //
-    // TX_WITH_WITNESS(*this) is defined to emit exactly that extended
-    // serialization for segOP-aware nodes, so we feed it straight into
-    // a tagged HashWriter.
-
-    HashWriter hw = TaggedHash("segop:fullxid");
-    hw << TX_WITH_WITNESS(*this);
-
-    return Fullxid::FromUint256(hw.GetHash());
+    // Without witness data the wtxid equals the txid (BIP141), so that sink
+    // is left idle, as is the fullxid sink when it was computed ahead
+    // (MakeTransactionRefs).
+    static constexpr uint32_t TXID{1 << 0}, WTXID{1 << 1}, FULLXID{1 << 2};
+
+    const bool has_segop{!segop_payload.IsNull()};
+    const uint32_t wtxid{m_has_witness ? WTXID : 0};
+    const uint32_t fullxid{segop_hashes ? 0 : FULLXID};
+    MultiHashWriter<3> hw{{HashWriter{}, HashWriter{}, FullxidWriter()}};
+
+    hw.SetSinks(TXID | wtxid | fullxid) << version;
+    if (m_has_witness || has_segop) {
+        const uint8_t flags = uint8_t((m_has_witness ? 1 : 0) | (has_segop ? 2 : 0));
+        hw.SetSinks(wtxid | fullxid) << std::vector<CTxIn>{};
+        hw.SetSinks(wtxid) << uint8_t{1};
+        hw.SetSinks(fullxid) << flags;
+    }
+    hw.SetSinks(TXID | wtxid | fullxid) << vin << vout;
+    if (m_has_witness) {
+        hw.SetSinks(WTXID | fullxid);
+        for (const CTxIn& txin : vin) {
+            hw << txin.scriptWitness.stack;
+        }
+    }
+    if (has_segop && fullxid) {
+        hw.SetSinks(FULLXID) << uint8_t{0x53} << segop_payload;
+    }
+    hw.SetSinks(TXID | wtxid | fullxid) << nLockTime;
+
+    const Txid txid{Txid::FromUint256(hw.Sink(0).GetHash())};
+    const uint256 commitment{segop_hashes ? segop_hashes->commitment :
+                             has_segop    ? SegopCommitment(segop_payload.data) :
+                                            uint256{}};
+    return {
+        .txid = txid,
+        .wtxid = m_has_witness ? Wtxid::FromUint256(hw.Sink(1).GetHash()) : Wtxid::FromUint256(txid.ToUint256()),
+        .fullxid = segop_hashes ? segop_hashes->fullxid : Fullxid::FromUint256(hw.Sink(2).GetHash()),
+        .segop_commitment = commitment,
+    };
 }
 
 /** CTransaction (public) *****************************************************/
@@ -169,9 +180,7 @@ CTransaction::CTransaction(const CMutableTransaction& tx)
       nLockTime{tx.nLockTime},
       segop_payload(tx.segop_payload),
       m_has_witness{ComputeHasWitness()},
-      hash{ComputeHash()},
-      m_witness_hash{ComputeWitnessHash()},
-      m_full_hash{ComputeFullxid()}
+      m_hashes{ComputeHashes()}
 {
 }
 
@@ -182,12 +191,83 @@ CTransaction::CTransaction(CMutableTransaction&& tx)
       nLockTime{tx.nLockTime},
       segop_payload(std::move(tx.segop_payload)),
       m_has_witness{ComputeHasWitness()},
-      hash{ComputeHash()},
-      m_witness_hash{ComputeWitnessHash()},
-      m_full_hash{ComputeFullxid()}
+      m_hashes{ComputeHashes()}
+{
+}
+
+CTransaction::CTransaction(CMutableTransaction&& tx, const SegopHashes& segop_hashes)
+    : vin(std::move(tx.vin)),
+      vout(std::move(tx.vout)),
+      version{tx.version},
+      nLockTime{tx.nLockTime},
+      segop_payload(std::move(tx.segop_payload)),
+      m_has_witness{ComputeHasWitness()},
+      m_hashes{ComputeHashes(&segop_hashes)}
 {
 }
 
+std::vector<CTransactionRef> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs)
+{
+    std::vector<size_t> segop_txs;
+    for (size_t i{0}; i < txs.size(); ++i) {
+        if (!txs[i].segop_payload.IsNull()) segop_txs.push_back(i);
+    }
+
+    std::vector<CTransactionRef> ret;
+    ret.reserve(txs.size());
+    if (segop_txs.size() < 2) {
+        for (CMutableTransaction& tx : txs) ret.push_back(MakeTransactionRef(std::move(tx)));
+        return ret;
+    }
+
+    // Every payload is hashed twice: on its own into the commitment, and in
+    // place inside the fullxid preimage. Bring each fullxid writer up to the
+    // payload bytes here (the same serialization as ComputeHashes), then hash
+    // all payloads of the batch side by side.
+    std::vector<HashWriter> writers;
+    std::vector<std::span<const unsigned char>> payloads;
+    writers.reserve(2 * segop_txs.size());
+    payloads.reserve(2 * segop_txs.size());
+    for (const size_t i : segop_txs) {
+        const CMutableTransaction& tx{txs[i]};
+        const bool has_witness{tx.HasWitness()};
+        HashWriter fullxid{FullxidWriter()};
+        fullxid << tx.version << std::vector<CTxIn>{} << uint8_t(has_witness ? 3 : 2) << tx.vin << tx.vout;
+        if (has_witness) {
+            for (const CTxIn& txin : tx.vin) {
+                fullxid << txin.scriptWitness.stack;
+            }
+        }
+        fullxid << uint8_t{0x53} << tx.segop_payload.version;
+        WriteCompactSize(fullxid, tx.segop_payload.data.size());
+
+        writers.push_back(SegopCommitmentWriter());
+        payloads.emplace_back(tx.segop_payload.data);
+        writers.push_back(std::move(fullxid));
+        payloads.emplace_back(tx.segop_payload.data);
+    }
+    HashWriter::WriteMulti(writers, payloads);
+
+    size_t next{0};
+    for (size_t i{0}; i < txs.size(); ++i) {
+        if (next < segop_txs.size() && segop_txs[next] == i) {
+            HashWriter& commitment{writers[2 * next]};
+            HashWriter& fullxid{writers[2 * next + 1]};
+            fullxid << txs[i].nLockTime;
+            const CTransaction::SegopHashes segop_hashes{
+                .fullxid = Fullxid::FromUint256(fullxid.GetHash()),
+                .commitment = commitment.GetHash(),
+            };
+            // The constructor is private, so no make_shared.
+            ret.emplace_back(new CTransaction(std::move(txs[i]), segop_hashes));
+            ++next;
+        } else {
+            ret.push_back(MakeTransactionRef(std::move(txs[i])));
+        }
+    }
+    return ret;
+}
+
 CAmount CTransaction::GetValueOut() const
 {
     CAmount nValueOut = 0;
@@ -192,10 +192,16 @@ struct CMutableTransaction;
 
 struct TransactionSerParams {
     const bool allow_witness;
+    //! Emit the segOP section when serializing. It is always accepted when reading.
+    const bool allow_segop{true};
     SER_PARAMS_OPFUNC
 };
 static constexpr TransactionSerParams TX_WITH_WITNESS{.allow_witness = true};
 static constexpr TransactionSerParams TX_NO_WITNESS{.allow_witness = false};
+/** Extended serialization with the segOP section omitted (payload-stripped blk*.dat records, wtxid). */
+static constexpr TransactionSerParams TX_WITH_WITNESS_NO_SEGOP{.allow_witness = true, .allow_segop = false};
+/** Legacy serialization without witness or segOP, as committed to by the txid. */
+static constexpr TransactionSerParams TX_NO_WITNESS_NO_SEGOP{.allow_witness = false, .allow_segop = false};
 
 /**
  * Basic transaction serialization format:
@@ -304,7 +310,7 @@ void SerializeTransaction(const TxType& tx, Stream& s, const TransactionSerParam
         flags |= 1;
     }
     // segOP flag (bit 1)
-    if (!tx.segop_payload.IsNull()) {
+    if (params.allow_segop && !tx.segop_payload.IsNull()) {
         flags |= 2;
     }
 
@@ -364,15 +370,27 @@ public:
     const CSegopPayload segop_payload;
 
 private:
+    struct Hashes {
+        Txid txid;
+        Wtxid wtxid;
+        Fullxid fullxid; //!< Hash of full extended tx (incl. segOP)
+        uint256 segop_commitment; //!< SegopCommitment() of the payload, null without one
+    };
+
     /** Memory only. */
     const bool m_has_witness;
-    const Txid hash;
-    const Wtxid m_witness_hash;
-    const Fullxid m_full_hash; //!< Hash of full extended tx (incl. segOP)
+    const Hashes m_hashes;
+
+    /** segOP: the payload-dependent hashes, when computed ahead of
+     *  construction for a batch of transactions (MakeTransactionRefs). */
+    struct SegopHashes {
+        Fullxid fullxid;
+        uint256 commitment;
+    };
 
-    Txid ComputeHash() const;
-    Wtxid ComputeWitnessHash() const;
-    Fullxid ComputeFullxid() const; //segOP
+    /** Compute txid, wtxid and fullxid in one pass over the extended serialization,
+     *  and the P2SOP commitment to the segOP payload. */
+    Hashes ComputeHashes(const SegopHashes* segop_hashes = nullptr) const;
 
     bool ComputeHasWitness() const;
 
@@ -381,6 +399,12 @@ public:
     explicit CTransaction(const CMutableTransaction& tx);
     explicit CTransaction(CMutableTransaction&& tx);
 
+private:
+    CTransaction(CMutableTransaction&& tx, const SegopHashes& segop_hashes);
+    friend std::vector<std::shared_ptr<const CTransaction>> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs);
+
+public:
+
     template <typename Stream>
     inline void Serialize(Stream& s) const {
         SerializeTransaction(*this, s, s.template GetParams<TransactionSerParams>());
@@ -397,9 +421,11 @@ public:
         return vin.empty() && vout.empty();
     }
 
-    const Txid& GetHash() const LIFETIMEBOUND { return hash; }
-    const Wtxid& GetWitnessHash() const LIFETIMEBOUND { return m_witness_hash; };
-    const Fullxid& GetFullxid() const LIFETIMEBOUND { return m_full_hash; } //segOP
+    const Txid& GetHash() const LIFETIMEBOUND { return m_hashes.txid; }
+    const Wtxid& GetWitnessHash() const LIFETIMEBOUND { return m_hashes.wtxid; };
+    const Fullxid& GetFullxid() const LIFETIMEBOUND { return m_hashes.fullxid; } //segOP
+    /** The commitment a P2SOP output must carry for this payload (null if there is no payload). */
+    const uint256& GetSegopCommitment() const LIFETIMEBOUND { return m_hashes.segop_commitment; }
 
     // Return sum of txouts.
     CAmount GetValueOut() const;
@@ -484,4 +510,9 @@ struct CMutableTransaction
 typedef std::shared_ptr<const CTransaction> CTransactionRef;
 template <typename Tx> static inline CTransactionRef MakeTransactionRef(Tx&& txIn) { return std::make_shared<const CTransaction>(std::forward<Tx>(txIn)); }
 
+/** Construct a batch of transactions, e.g. those of a block. The segOP
+ *  commitments and fullxids of all payloads are hashed together in parallel
+ *  SHA256 lanes (see SHA256WriteMulti) rather than one transaction at a time. */
+std::vector<CTransactionRef> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs);
+
 #endif // BITCOIN_PRIMITIVES_TRANSACTION_H
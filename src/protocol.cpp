@@ -60,6 +60,8 @@ std::string CInv::GetMessageType() const
     std::string cmd;
     if (type & MSG_WITNESS_FLAG)
         cmd.append("witness-");
+    if (type & MSG_SEGOP_STRIPPED_FLAG)
+        cmd.append("nosegop-");
     int masked = type & MSG_TYPE_MASK;
     switch (masked)
     {
@@ -69,6 +71,7 @@ std::string CInv::GetMessageType() const
     case MSG_BLOCK:          return cmd.append(NetMsgType::BLOCK);
     case MSG_FILTERED_BLOCK: return cmd.append(NetMsgType::MERKLEBLOCK);
     case MSG_CMPCT_BLOCK:    return cmd.append(NetMsgType::CMPCTBLOCK);
+    case MSG_SOPDATA:        return cmd.append(NetMsgType::SEGOPDATA);
     default:
         throw std::out_of_range(strprintf("CInv::GetMessageType(): type=%d unknown type", type));
     }
@@ -99,6 +102,8 @@ static std::string serviceFlagToStr(size_t bit)
     case NODE_COMPACT_FILTERS: return "COMPACT_FILTERS";
     case NODE_NETWORK_LIMITED: return "NETWORK_LIMITED";
     case NODE_P2P_V2:          return "P2P_V2";
+    case NODE_SOP_RECENT:      return "SOP_RECENT";
+    case NODE_SOP_ARCHIVE:     return "SOP_ARCHIVE";
     // Not using default, so we get warned when a case is missing
     }
 
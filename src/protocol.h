@@ -264,6 +264,18 @@ inline constexpr const char* WTXIDRELAY{"wtxidrelay"};
  * txreconciliation, as described by BIP 330.
  */
 inline constexpr const char* SENDTXRCNCL{"sendtxrcncl"};
+/**
+ * Requests the segOP payloads of up to MAX_SEGOPDATA_REQUEST_SIZE
+ * transactions, identified by txid (segOP spec §11.4.1).
+ * Only sent to peers advertising NODE_SOP_RECENT or NODE_SOP_ARCHIVE.
+ */
+inline constexpr const char* GETSEGOPDATA{"getsegopdata"};
+/**
+ * Contains a batch of (txid, segOP payload) entries in response to a
+ * getsegopdata message (segOP spec §11.4.2). Payloads that cannot be served
+ * are reported with a notfound message using MSG_SOPDATA.
+ */
+inline constexpr const char* SEGOPDATA{"segopdata"};
 }; // namespace NetMsgType
 
 /** All known message types (see above). Keep this in the same order as the list of messages above. */
@@ -303,6 +315,8 @@ inline const std::array ALL_NET_MESSAGE_TYPES{std::to_array<std::string>({
     NetMsgType::CFCHECKPT,
     NetMsgType::WTXIDRELAY,
     NetMsgType::SENDTXRCNCL,
+    NetMsgType::GETSEGOPDATA,
+    NetMsgType::SEGOPDATA,
 })};
 
 /** nServices flags */
@@ -329,6 +343,14 @@ enum ServiceFlags : uint64_t {
     // NODE_P2P_V2 means the node supports BIP324 transport
     NODE_P2P_V2 = (1 << 11),
 
+    // NODE_SOP_RECENT means the node can serve segOP payloads (getsegopdata)
+    // for at least the most recent validation window of blocks.
+    // See segOP spec §11.2.1.
+    NODE_SOP_RECENT = (1 << 24),
+    // NODE_SOP_ARCHIVE means the node retains and serves segOP payloads for
+    // every block from genesis to its tip. See segOP spec §11.2.2.
+    NODE_SOP_ARCHIVE = (1 << 25),
+
     // Bits 24-31 are reserved for temporary experiments. Just pick a bit that
     // isn't getting used, or one not being used much, and notify the
     // bitcoin-development mailing list. Remember that service bits are just
@@ -468,7 +490,9 @@ public:
 
 /** getdata message type flags */
 const uint32_t MSG_WITNESS_FLAG = 1 << 30;
-const uint32_t MSG_TYPE_MASK = 0xffffffff >> 2;
+//! Requests a block without its segOP payloads (segOP light IBD).
+const uint32_t MSG_SEGOP_STRIPPED_FLAG = 1 << 29;
+const uint32_t MSG_TYPE_MASK = 0xffffffff >> 3;
 
 /** getdata / inv message types.
  * These numbers are defined by the protocol. When adding a new value, be sure
@@ -482,8 +506,12 @@ enum GetDataMsg : uint32_t {
     // The following can only occur in getdata. Invs always use TX/WTX or BLOCK.
     MSG_FILTERED_BLOCK = 3,                           //!< Defined in BIP37
     MSG_CMPCT_BLOCK = 4,                              //!< Defined in BIP152
+    MSG_SOPDATA = 0x53,                               //!< segOP payload, only in notfound (segOP spec §11.3)
     MSG_WITNESS_BLOCK = MSG_BLOCK | MSG_WITNESS_FLAG, //!< Defined in BIP144
     MSG_WITNESS_TX = MSG_TX | MSG_WITNESS_FLAG,       //!< Defined in BIP144
+    //! A witness block with segOP payloads left out. Only sent to peers
+    //! advertising NODE_SOP_RECENT or NODE_SOP_ARCHIVE.
+    MSG_WITNESS_BLOCK_NO_SEGOP = MSG_WITNESS_BLOCK | MSG_SEGOP_STRIPPED_FLAG,
     // MSG_FILTERED_WITNESS_BLOCK is defined in BIP144 as reserved for future
     // use and remains unused.
     // MSG_FILTERED_WITNESS_BLOCK = MSG_FILTERED_BLOCK | MSG_WITNESS_FLAG,
@@ -510,6 +538,8 @@ public:
     bool IsMsgFilteredBlk() const { return type == MSG_FILTERED_BLOCK; }
     bool IsMsgCmpctBlk() const { return type == MSG_CMPCT_BLOCK; }
     bool IsMsgWitnessBlk() const { return type == MSG_WITNESS_BLOCK; }
+    bool IsMsgSegopStrippedBlk() const { return type == MSG_WITNESS_BLOCK_NO_SEGOP; }
+    bool IsMsgSopData() const { return type == MSG_SOPDATA; }
 
     // Combined-message helper methods
     bool IsGenTxMsg() const
@@ -518,7 +548,8 @@ public:
     }
     bool IsGenBlkMsg() const
     {
-        return type == MSG_BLOCK || type == MSG_FILTERED_BLOCK || type == MSG_CMPCT_BLOCK || type == MSG_WITNESS_BLOCK;
+        return type == MSG_BLOCK || type == MSG_FILTERED_BLOCK || type == MSG_CMPCT_BLOCK || type == MSG_WITNESS_BLOCK ||
+               type == MSG_WITNESS_BLOCK_NO_SEGOP;
     }
 
     uint32_t type;
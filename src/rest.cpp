@@ -24,6 +24,9 @@
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
+#include <segop/buds.h>
+#include <segop/segop.h>
+#include <segop/segop_store.h>
 #include <streams.h>
 #include <sync.h>
 #include <txmempool.h>
@@ -869,6 +872,164 @@ static bool rest_tx(const std::any& context, HTTPRequest* req, const std::string
     }
 }
 
+/**
+ * Append the segOP record of `tx` to `stream`: the txid followed by the
+ * serialized payload. A pruned payload is written as the null payload
+ * (version 0, no data), which marks it as pruned.
+ */
+static void SerializeSegopRecord(DataStream& stream, const CTransaction& tx)
+{
+    stream << tx.GetHash() << tx.segop_payload;
+}
+
+static UniValue SegopRecordToJSON(const CTransaction& tx)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("txid", tx.GetHash().GetHex());
+    if (tx.segop_payload.IsNull()) {
+        obj.pushKV("pruned", true);
+        return obj;
+    }
+    const SegopBUDSInfo info{SegopExtractBUDSInfo(tx.segop_payload.data)};
+    obj.pushKV("fullxid", tx.GetFullxid().GetHex());
+    obj.pushKV("version", static_cast<int>(tx.segop_payload.version));
+    obj.pushKV("size", static_cast<uint64_t>(tx.segop_payload.data.size()));
+    obj.pushKV("buds_tier", segop::ToString(info.tier));
+    obj.pushKV("buds_type", segop::ToString(info.type));
+    obj.pushKV("hex", HexStr(tx.segop_payload.data));
+    return obj;
+}
+
+static bool rest_segop(const std::any& context, HTTPRequest* req, const std::string& uri_part)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RESTResponseFormat rf = ParseDataFormat(hashStr, uri_part);
+
+    auto hash{Txid::FromHex(hashStr)};
+    if (!hash) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+    }
+
+    if (g_txindex) {
+        g_txindex->BlockUntilSyncedToCurrentChain();
+    }
+
+    const NodeContext* const node = GetNodeContext(context, req);
+    if (!node) return false;
+    uint256 hashBlock = uint256();
+    const CTransactionRef tx{GetTransaction(/*block_index=*/nullptr, node->mempool.get(), *hash, hashBlock, node->chainman->m_blockman)};
+    if (!tx) {
+        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+    }
+    if (tx->segop_payload.IsNull() && !segop::IsPayloadStripped(*tx)) {
+        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " has no segOP payload");
+    }
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY: {
+        DataStream ssSegop;
+        SerializeSegopRecord(ssSegop, *tx);
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, ssSegop);
+        return true;
+    }
+
+    case RESTResponseFormat::HEX: {
+        DataStream ssSegop;
+        SerializeSegopRecord(ssSegop, *tx);
+        std::string strHex = HexStr(ssSegop) + "\n";
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, strHex);
+        return true;
+    }
+
+    case RESTResponseFormat::JSON: {
+        std::string strJSON = SegopRecordToJSON(*tx).write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
+static bool rest_block_segop(const std::any& context, HTTPRequest* req, const std::string& uri_part)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RESTResponseFormat rf = ParseDataFormat(hashStr, uri_part);
+
+    auto hash{uint256::FromHex(hashStr)};
+    if (!hash) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+    }
+
+    FlatFilePos pos{};
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
+    {
+        LOCK(cs_main);
+        const CBlockIndex* pblockindex = chainman.m_blockman.LookupBlockIndex(*hash);
+        if (!pblockindex) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        }
+        if (!(pblockindex->nStatus & BLOCK_HAVE_DATA)) {
+            if (chainman.m_blockman.IsBlockPruned(*pblockindex)) {
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
+            }
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (not fully downloaded)");
+        }
+        pos = pblockindex->GetBlockPos();
+    }
+
+    CBlock block;
+    if (!chainman.m_blockman.ReadBlock(block, pos, *hash)) {
+        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+    }
+
+    switch (rf) {
+    case RESTResponseFormat::BINARY:
+    case RESTResponseFormat::HEX: {
+        // One record per segOP transaction in block order, with no count
+        // prefix. The whole body is built before the reply is sent.
+        DataStream ssSegop;
+        for (const CTransactionRef& tx : block.vtx) {
+            if (!tx->segop_payload.IsNull() || segop::IsPayloadStripped(*tx)) SerializeSegopRecord(ssSegop, *tx);
+        }
+        if (rf == RESTResponseFormat::BINARY) {
+            req->WriteHeader("Content-Type", "application/octet-stream");
+            req->WriteReply(HTTP_OK, ssSegop);
+        } else {
+            req->WriteHeader("Content-Type", "text/plain");
+            req->WriteReply(HTTP_OK, HexStr(ssSegop) + "\n");
+        }
+        return true;
+    }
+
+    case RESTResponseFormat::JSON: {
+        UniValue records(UniValue::VARR);
+        for (const CTransactionRef& tx : block.vtx) {
+            if (!tx->segop_payload.IsNull() || segop::IsPayloadStripped(*tx)) records.push_back(SegopRecordToJSON(*tx));
+        }
+        std::string strJSON = records.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
 static bool rest_getutxos(const std::any& context, HTTPRequest* req, const std::string& uri_part)
 {
     if (!CheckWarmup(req))
@@ -1130,6 +1291,8 @@ static const struct {
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
       {"/rest/spenttxouts/", rest_spent_txouts},
+      {"/rest/segop/", rest_segop},
+      {"/rest/blocksegop/", rest_block_segop},
 };
 
 void StartREST(const std::any& context)
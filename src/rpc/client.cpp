@@ -188,6 +188,7 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "gettxout", 1, "n" },
     { "gettxout", 2, "include_mempool" },
     { "gettxoutproof", 0, "txids" },
+    { "getsegopproof", 0, "txids" },
     { "gettxoutsetinfo", 1, "hash_or_height" },
     { "gettxoutsetinfo", 2, "use_index"},
     { "dumptxoutset", 2, "options" },
@@ -196,6 +197,12 @@ static const CRPCConvertParam vRPCConvertParams[] =
     { "lockunspent", 1, "transactions" },
     { "lockunspent", 2, "persistent" },
     { "segopsend", 3, "options" },// segOP
+    { "segopsendmany", 0, "payloads" },
+    { "segopsendmany", 1, "options" },
+    { "listsegop", 0, "start_height" },
+    { "listsegop", 1, "end_height" },
+    { "listsegop", 4, "count" },
+    { "listsegop", 5, "include_payload" },
     { "send", 0, "outputs" },
     { "send", 1, "conf_target" },
     { "send", 3, "fee_rate"},
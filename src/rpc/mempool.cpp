@@ -20,6 +20,8 @@
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
+#include <segop/buds.h>
+#include <segop/segop.h>
 #include <txmempool.h>
 #include <univalue.h>
 #include <util/fs.h>
@@ -283,6 +285,15 @@ static std::vector<RPCResult> MempoolEntryDescription()
             {RPCResult{RPCResult::Type::STR_HEX, "transactionid", "child transaction id"}}},
         RPCResult{RPCResult::Type::BOOL, "bip125-replaceable", "Whether this transaction signals BIP125 replaceability or has an unconfirmed ancestor signaling BIP125 replaceability. (DEPRECATED)\n"},
         RPCResult{RPCResult::Type::BOOL, "unbroadcast", "Whether this transaction is currently unbroadcast (initial broadcast not yet acknowledged by any peers)"},
+        RPCResult{RPCResult::Type::OBJ, "segop", /*optional=*/true, "BUDS classification of the segOP payload (only for transactions carrying one)",
+            {
+                RPCResult{RPCResult::Type::NUM, "size", "segOP payload size in bytes"},
+                RPCResult{RPCResult::Type::STR, "buds_tier_code", "raw BUDS tier code, 0xff if absent"},
+                RPCResult{RPCResult::Type::STR, "buds_tier", "BUDS tier"},
+                RPCResult{RPCResult::Type::STR, "buds_type_code", "raw BUDS data type code, 0xff if absent"},
+                RPCResult{RPCResult::Type::STR, "buds_type", "BUDS data type"},
+                RPCResult{RPCResult::Type::STR, "arbda_tier", "ARBDA tier of the transaction"},
+            }},
     };
 }
 
@@ -341,6 +352,18 @@ static void entryToJSON(const CTxMemPool& pool, UniValue& info, const CTxMemPool
 
     info.pushKV("bip125-replaceable", rbfStatus);
     info.pushKV("unbroadcast", pool.IsUnbroadcastTx(tx.GetHash()));
+
+    if (!tx.segop_payload.IsNull()) {
+        const SegopPackedBUDSInfo& buds{e.GetBUDSInfo()};
+        UniValue segop_info(UniValue::VOBJ);
+        segop_info.pushKV("size", e.GetSegopSize());
+        segop_info.pushKV("buds_tier_code", strprintf("0x%02x", buds.TierCode()));
+        segop_info.pushKV("buds_tier", segop::ToString(buds.Tier()));
+        segop_info.pushKV("buds_type_code", strprintf("0x%02x", buds.TypeCode()));
+        segop_info.pushKV("buds_type", segop::ToString(buds.Type()));
+        segop_info.pushKV("arbda_tier", segop::ToString(buds.ARBDA()));
+        info.pushKV("segop", std::move(segop_info));
+    }
 }
 
 UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempool_sequence)
@@ -684,6 +707,8 @@ UniValue MempoolInfoToJSON(const CTxMemPool& pool)
     ret.pushKV("usage", (int64_t)pool.DynamicMemoryUsage());
     ret.pushKV("total_fee", ValueFromAmount(pool.GetTotalFee()));
     ret.pushKV("maxmempool", pool.m_opts.max_size_bytes);
+    ret.pushKV("segopbytes", pool.GetTotalSegopSize());
+    ret.pushKV("maxsegopmempool", pool.m_opts.max_segop_size_bytes);
     ret.pushKV("mempoolminfee", ValueFromAmount(std::max(pool.GetMinFee(), pool.m_opts.min_relay_feerate).GetFeePerK()));
     ret.pushKV("minrelaytxfee", ValueFromAmount(pool.m_opts.min_relay_feerate.GetFeePerK()));
     ret.pushKV("incrementalrelayfee", ValueFromAmount(pool.m_opts.incremental_relay_feerate.GetFeePerK()));
@@ -708,6 +733,8 @@ static RPCHelpMan getmempoolinfo()
                 {RPCResult::Type::NUM, "usage", "Total memory usage for the mempool"},
                 {RPCResult::Type::STR_AMOUNT, "total_fee", "Total fees for the mempool in " + CURRENCY_UNIT + ", ignoring modified fees through prioritisetransaction"},
                 {RPCResult::Type::NUM, "maxmempool", "Maximum memory usage for the mempool"},
+                {RPCResult::Type::NUM, "segopbytes", "Sum of the segOP payload sizes of all transactions in the mempool"},
+                {RPCResult::Type::NUM, "maxsegopmempool", "Maximum segOP payload bytes in the mempool"},
                 {RPCResult::Type::STR_AMOUNT, "mempoolminfee", "Minimum fee rate in " + CURRENCY_UNIT + "/kvB for tx to be accepted. Is the maximum of minrelaytxfee and minimum mempool fee"},
                 {RPCResult::Type::STR_AMOUNT, "minrelaytxfee", "Current minimum relay fee for transactions"},
                 {RPCResult::Type::NUM, "incrementalrelayfee", "minimum fee rate increment for mempool limiting or replacement in " + CURRENCY_UNIT + "/kvB"},
@@ -10,6 +10,7 @@
 #include <consensus/amount.h>
 #include <consensus/validation.h>
 #include <core_io.h>
+#include <index/segopindex.h>
 #include <index/txindex.h>
 #include <key_io.h>
 #include <node/blockstorage.h>
@@ -46,6 +47,7 @@
 #include <validationinterface.h>
 
 #include <cstdint>
+#include <limits>
 #include <numeric>
 
 #include <univalue.h>
@@ -538,55 +540,34 @@ static UniValue DecodeSegopTlv(const CSegopPayload& segop)
 {
     UniValue out(UniValue::VARR);
 
-    const std::vector<unsigned char>& d = segop.data;
-    const size_t n = d.size();
-    size_t i = 0;
-
-    while (i < n) {
-        // Need at least a type byte
-        if (n - i < 1) break;
-
-        const uint8_t t = d[i++];
-
-        // Read CompactSize length (same rules as SegopIsValidTLV)
-        uint64_t len64 = 0;
-        if (!SegopReadCompactSize(d, i, len64)) {
-            // Malformed length – consensus would have rejected already.
-            // For RPC, stop decoding gracefully.
-            break;
-        }
-
-        // Bounds check: not enough bytes for the value
-        if (len64 > (n - i)) {
-            break;
-        }
-        const size_t len = static_cast<size_t>(len64);
+    // A malformed record stops decoding gracefully; consensus would have
+    // rejected such a payload already.
+    SegopTlvIterator it{segop.data};
+    while (const auto record{it.Next()}) {
+        const uint8_t t = record->type;
+        const std::span<const unsigned char> value{record->value};
 
         // Base record
         UniValue rec(UniValue::VOBJ);
         rec.pushKV("type", strprintf("0x%02x", t));
-        rec.pushKV("length", static_cast<uint64_t>(len));
+        rec.pushKV("length", static_cast<uint64_t>(value.size()));
 
         // Raw value in hex for all types.
-        auto span_val = MakeUCharSpan(d).subspan(i, len);
-        rec.pushKV("value_hex", HexStr(span_val));
+        rec.pushKV("value_hex", HexStr(value));
 
         // Default kind is "unknown" – overridden for known types below.
         std::string kind = "unknown";
 
         // 0x01 = TEXT_UTF8
-        if (t == SegopTlvType::TEXT_UTF8 || t == 0x01) {
+        if (t == SegopTlvType::TEXT_UTF8) {
             kind = "text";
-            std::string text(reinterpret_cast<const char*>(&d[i]),
-                             reinterpret_cast<const char*>(&d[i]) + len);
-            rec.pushKV("text", text);
+            rec.pushKV("text", std::string(value.begin(), value.end()));
         }
 
         // 0x02 = JSON_UTF8
-        if (t == SegopTlvType::JSON_UTF8 || t == 0x02) {
+        if (t == SegopTlvType::JSON_UTF8) {
             kind = "json";
-            std::string json_str(reinterpret_cast<const char*>(&d[i]),
-                                 reinterpret_cast<const char*>(&d[i]) + len);
+            std::string json_str(value.begin(), value.end());
 
             // Always expose the raw JSON string as "text"
             rec.pushKV("text", json_str);
@@ -602,7 +583,7 @@ static UniValue DecodeSegopTlv(const CSegopPayload& segop)
         }
 
         // 0x03 = BINARY_BLOB: we don't add text, just mark kind=blob.
-        if (t == SegopTlvType::BINARY_BLOB || t == 0x03) {
+        if (t == SegopTlvType::BINARY_BLOB) {
             kind = "blob";
         }
 
@@ -619,9 +600,6 @@ static UniValue DecodeSegopTlv(const CSegopPayload& segop)
         rec.pushKV("kind", kind);
 
         out.push_back(std::move(rec));
-
-        // Advance over the value bytes to the next TLV record
-        i += len;
     }
 
     return out;
@@ -716,6 +694,116 @@ RPCHelpMan decodesegop()
     };
 }
 
+static RPCHelpMan listsegop()
+{
+    return RPCHelpMan{
+        "listsegop",
+        "List segOP transactions in the active chain, in block order, optionally\n"
+        "restricted to one BUDS tier and/or data type.\n"
+        "Requires -segopindex.\n",
+        {
+            {"start_height", RPCArg::Type::NUM, RPCArg::Default{0}, "The first block height to include."},
+            {"end_height", RPCArg::Type::NUM, RPCArg::DefaultHint{"the current tip"}, "The last block height to include."},
+            {"tier", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Only list payloads of this BUDS tier (e.g. \"T2_OPERATIONAL\")."},
+            {"type", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Only list payloads of this BUDS data type (e.g. \"L2_STATE_ANCHOR\")."},
+            {"count", RPCArg::Type::NUM, RPCArg::Default{1000}, "The maximum number of transactions to list."},
+            {"include_payload", RPCArg::Type::BOOL, RPCArg::Default{false}, "Include the payload bytes, read from disk."},
+        },
+        RPCResult{
+            RPCResult::Type::ARR, "", "",
+            {
+                {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR_HEX, "txid", "The transaction id."},
+                        {RPCResult::Type::NUM, "height", "The height of the block containing the transaction."},
+                        {RPCResult::Type::STR_HEX, "blockhash", /*optional=*/true, "The hash of that block (omitted if it was disconnected during the call)."},
+                        {RPCResult::Type::NUM, "size", "segOP payload size in bytes."},
+                        {RPCResult::Type::STR, "buds_tier", "BUDS tier of the payload."},
+                        {RPCResult::Type::STR, "buds_type", "BUDS data type of the payload."},
+                        {RPCResult::Type::STR, "arbda_tier", "ARBDA tier of the payload."},
+                        {RPCResult::Type::STR_HEX, "hex", /*optional=*/true, "segOP payload bytes (with include_payload, if still stored)."},
+                        {RPCResult::Type::BOOL, "pruned", /*optional=*/true, "Whether the payload has been pruned from disk (with include_payload)."},
+                    }
+                },
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("listsegop", "800000") +
+            HelpExampleCliNamed("listsegop", {{"start_height", 800000}, {"type", "L2_STATE_ANCHOR"}}) +
+            HelpExampleRpc("listsegop", "800000, 800100, \"T2_OPERATIONAL\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            if (!g_segopindex) {
+                throw JSONRPCError(RPC_MISC_ERROR, "The segOP index is not enabled. Start the node with -segopindex");
+            }
+            ChainstateManager& chainman = EnsureAnyChainman(request.context);
+
+            const int start_height{request.params[0].isNull() ? 0 : request.params[0].getInt<int>()};
+            const int end_height{request.params[1].isNull() ? std::numeric_limits<int>::max() : request.params[1].getInt<int>()};
+            if (start_height < 0 || end_height < start_height) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid height range");
+            }
+            SegopIndexFilter filter;
+            if (!request.params[2].isNull()) {
+                filter.tier = segop::BUDSTierFromString(request.params[2].get_str());
+                if (!filter.tier) throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown BUDS tier: " + request.params[2].get_str());
+            }
+            if (!request.params[3].isNull()) {
+                filter.type = segop::BUDSDataTypeFromString(request.params[3].get_str());
+                if (!filter.type) throw JSONRPCError(RPC_INVALID_PARAMETER, "Unknown BUDS data type: " + request.params[3].get_str());
+            }
+            const int count{request.params[4].isNull() ? 1000 : request.params[4].getInt<int>()};
+            if (count < 0) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+            }
+            const bool include_payload{request.params[5].isNull() ? false : request.params[5].get_bool()};
+
+            g_segopindex->BlockUntilSyncedToCurrentChain();
+            std::vector<SegopIndexEntry> entries;
+            if (!g_segopindex->FindSegopTxs(start_height, end_height, filter, count, entries)) {
+                throw JSONRPCError(RPC_DATABASE_ERROR, "Failed to read the segOP index");
+            }
+
+            // The chain may have moved on since the entries were read, so
+            // only report the blocks they were indexed from that are still
+            // in it, rather than whatever block is now at their height.
+            std::vector<bool> in_active_chain;
+            in_active_chain.reserve(entries.size());
+            {
+                LOCK(cs_main);
+                const CChain& active_chain{chainman.ActiveChain()};
+                for (const SegopIndexEntry& entry : entries) {
+                    const CBlockIndex* pindex{chainman.m_blockman.LookupBlockIndex(entry.block_hash)};
+                    in_active_chain.push_back(pindex && active_chain.Contains(pindex));
+                }
+            }
+
+            UniValue result(UniValue::VARR);
+            for (size_t i = 0; i < entries.size(); ++i) {
+                const SegopIndexEntry& entry{entries[i]};
+                UniValue obj(UniValue::VOBJ);
+                obj.pushKV("txid", entry.txid.GetHex());
+                obj.pushKV("height", entry.height);
+                if (in_active_chain[i]) obj.pushKV("blockhash", entry.block_hash.GetHex());
+                obj.pushKV("size", (uint64_t)entry.payload_size);
+                obj.pushKV("buds_tier", segop::ToString(entry.tier));
+                obj.pushKV("buds_type", segop::ToString(entry.type));
+                obj.pushKV("arbda_tier", segop::ToString(entry.arbda));
+                if (include_payload) {
+                    CTransactionRef tx;
+                    if (!g_segopindex->ReadTx(entry, tx)) {
+                        throw JSONRPCError(RPC_MISC_ERROR, "Failed to read transaction " + entry.txid.GetHex() + " from disk");
+                    }
+                    obj.pushKV("pruned", tx->segop_payload.IsNull());
+                    if (!tx->segop_payload.IsNull()) obj.pushKV("hex", HexStr(tx->segop_payload.data));
+                }
+                result.push_back(std::move(obj));
+            }
+            return result;
+        }
+    };
+}
 
 static RPCHelpMan createsegoptx()
 {
@@ -2465,6 +2553,7 @@ void RegisterRawTransactionRPCCommands(CRPCTable& t)
         { "rawtransactions", &decodesegop}, //segOP
         {"rawtransactions", &createsegoptx},  //segOP
         {"rawtransactions", &segopbuildp2sop}, //segOP
+        {"rawtransactions", &listsegop}, //segOP
         {"rawtransactions", &decodescript},
         {"rawtransactions", &combinerawtransaction},
         {"rawtransactions", &signrawtransactionwithkey},
@@ -6,6 +6,7 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <coins.h>
+#include <index/segopindex.h>
 #include <index/txindex.h>
 #include <merkleblock.h>
 #include <node/blockstorage.h>
@@ -20,6 +21,73 @@
 
 using node::GetTransaction;
 
+/** The txids argument of gettxoutproof and getsegopproof. */
+static std::set<Txid> ParseProofTxids(const UniValue& param)
+{
+    std::set<Txid> setTxids;
+    UniValue txids = param.get_array();
+    if (txids.empty()) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Parameter 'txids' cannot be empty");
+    }
+    for (unsigned int idx = 0; idx < txids.size(); idx++) {
+        auto ret{setTxids.insert(Txid::FromUint256(ParseHashV(txids[idx], "txid")))};
+        if (!ret.second) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, std::string("Invalid parameter, duplicated txid: ") + txids[idx].get_str());
+        }
+    }
+    return setTxids;
+}
+
+/**
+ * The block to prove the inclusion of `setTxids` in: the one given by
+ * `blockhash_param`, or else one found through the UTXO set or the txindex.
+ */
+static const CBlockIndex* FindProofBlock(ChainstateManager& chainman, const std::set<Txid>& setTxids, const UniValue& blockhash_param)
+{
+    const CBlockIndex* pblockindex = nullptr;
+    uint256 hashBlock;
+    if (!blockhash_param.isNull()) {
+        LOCK(cs_main);
+        hashBlock = ParseHashV(blockhash_param, "blockhash");
+        pblockindex = chainman.m_blockman.LookupBlockIndex(hashBlock);
+        if (!pblockindex) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+        }
+    } else {
+        LOCK(cs_main);
+        Chainstate& active_chainstate = chainman.ActiveChainstate();
+
+        // Loop through txids and try to find which block they're in. Exit loop once a block is found.
+        for (const auto& tx : setTxids) {
+            const Coin& coin{AccessByTxid(active_chainstate.CoinsTip(), tx)};
+            if (!coin.IsSpent()) {
+                pblockindex = active_chainstate.m_chain[coin.nHeight];
+                break;
+            }
+        }
+    }
+
+
+    // Allow txindex to catch up if we need to query it and before we acquire cs_main.
+    if (g_txindex && !pblockindex) {
+        g_txindex->BlockUntilSyncedToCurrentChain();
+    }
+
+    if (pblockindex == nullptr) {
+        const CTransactionRef tx = GetTransaction(/*block_index=*/nullptr, /*mempool=*/nullptr, *setTxids.begin(), hashBlock, chainman.m_blockman);
+        if (!tx || hashBlock.IsNull()) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction not yet in block");
+        }
+
+        LOCK(cs_main);
+        pblockindex = chainman.m_blockman.LookupBlockIndex(hashBlock);
+        if (!pblockindex) {
+            throw JSONRPCError(RPC_INTERNAL_ERROR, "Transaction index corrupt");
+        }
+    }
+    return pblockindex;
+}
+
 static RPCHelpMan gettxoutproof()
 {
     return RPCHelpMan{
@@ -43,60 +111,9 @@ static RPCHelpMan gettxoutproof()
         RPCExamples{""},
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
         {
-            std::set<Txid> setTxids;
-            UniValue txids = request.params[0].get_array();
-            if (txids.empty()) {
-                throw JSONRPCError(RPC_INVALID_PARAMETER, "Parameter 'txids' cannot be empty");
-            }
-            for (unsigned int idx = 0; idx < txids.size(); idx++) {
-                auto ret{setTxids.insert(Txid::FromUint256(ParseHashV(txids[idx], "txid")))};
-                if (!ret.second) {
-                    throw JSONRPCError(RPC_INVALID_PARAMETER, std::string("Invalid parameter, duplicated txid: ") + txids[idx].get_str());
-                }
-            }
-
-            const CBlockIndex* pblockindex = nullptr;
-            uint256 hashBlock;
+            const std::set<Txid> setTxids{ParseProofTxids(request.params[0])};
             ChainstateManager& chainman = EnsureAnyChainman(request.context);
-            if (!request.params[1].isNull()) {
-                LOCK(cs_main);
-                hashBlock = ParseHashV(request.params[1], "blockhash");
-                pblockindex = chainman.m_blockman.LookupBlockIndex(hashBlock);
-                if (!pblockindex) {
-                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
-                }
-            } else {
-                LOCK(cs_main);
-                Chainstate& active_chainstate = chainman.ActiveChainstate();
-
-                // Loop through txids and try to find which block they're in. Exit loop once a block is found.
-                for (const auto& tx : setTxids) {
-                    const Coin& coin{AccessByTxid(active_chainstate.CoinsTip(), tx)};
-                    if (!coin.IsSpent()) {
-                        pblockindex = active_chainstate.m_chain[coin.nHeight];
-                        break;
-                    }
-                }
-            }
-
-
-            // Allow txindex to catch up if we need to query it and before we acquire cs_main.
-            if (g_txindex && !pblockindex) {
-                g_txindex->BlockUntilSyncedToCurrentChain();
-            }
-
-            if (pblockindex == nullptr) {
-                const CTransactionRef tx = GetTransaction(/*block_index=*/nullptr, /*mempool=*/nullptr, *setTxids.begin(), hashBlock, chainman.m_blockman);
-                if (!tx || hashBlock.IsNull()) {
-                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Transaction not yet in block");
-                }
-
-                LOCK(cs_main);
-                pblockindex = chainman.m_blockman.LookupBlockIndex(hashBlock);
-                if (!pblockindex) {
-                    throw JSONRPCError(RPC_INTERNAL_ERROR, "Transaction index corrupt");
-                }
-            }
+            const CBlockIndex* pblockindex{FindProofBlock(chainman, setTxids, request.params[1])};
 
             {
                 LOCK(cs_main);
@@ -175,11 +192,146 @@ static RPCHelpMan verifytxoutproof()
     };
 }
 
+static RPCHelpMan getsegopproof()
+{
+    return RPCHelpMan{
+        "getsegopproof",
+        "Returns a hex-encoded proof that the segOP payload commitments of \"txids\" were included in a block.\n"
+        "\nThe proof is a partial merkle tree over the block's segOP transactions only, so it is usually much\n"
+        "smaller than a gettxoutproof proof. The block header does not commit to the segOP tree; the proof is\n"
+        "checked against the root a node computes for the block, see verifysegopproof.\n"
+        "\nThe block is found as by gettxoutproof.\n",
+        {
+            {"txids", RPCArg::Type::ARR, RPCArg::Optional::NO, "The txids of segOP transactions to prove",
+                {
+                    {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "A transaction hash"},
+                },
+            },
+            {"blockhash", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "If specified, looks for txid in the block with this hash"},
+        },
+        RPCResult{
+            RPCResult::Type::STR, "data", "A string that is a serialized, hex-encoded data for the proof."
+        },
+        RPCExamples{
+            HelpExampleCli("getsegopproof", "'[\"mytxid\"]'")
+            + HelpExampleRpc("getsegopproof", "[\"mytxid\"]")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            const std::set<Txid> txids{ParseProofTxids(request.params[0])};
+            ChainstateManager& chainman = EnsureAnyChainman(request.context);
+            const CBlockIndex* pblockindex{FindProofBlock(chainman, txids, request.params[1])};
+
+            {
+                LOCK(cs_main);
+                CheckBlockDataAvailability(chainman.m_blockman, *pblockindex, /*check_for_undo=*/false);
+            }
+            CBlock block;
+            if (!chainman.m_blockman.ReadBlock(block, *pblockindex)) {
+                throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
+            }
+
+            // Payloads pruned from the store are not needed: the leaves are
+            // the txids and P2SOP commitments, which stay in the block.
+            const auto leaves{GetSegopLeaves(block)};
+            if (leaves.empty()) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block has no segOP transactions to prove");
+            }
+            const auto found{std::ranges::count_if(leaves, [&](const auto& leaf) { return txids.contains(leaf.first); })};
+            if (static_cast<size_t>(found) != txids.size()) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Not all segOP transactions found in specified or retrieved block");
+            }
+
+            DataStream ssMB{};
+            ssMB << CSegopMerkleBlock{block, txids};
+            return HexStr(ssMB);
+        },
+    };
+}
+
+static RPCHelpMan verifysegopproof()
+{
+    return RPCHelpMan{
+        "verifysegopproof",
+        "Verifies that a proof points to segOP commitments in a block, returning the transactions and commitments\n"
+        "it proves and throwing an RPC error if the block is not in our best chain.\n"
+        "\nThe proof is checked against the segOP merkle root of the block, which is read from the segOP index\n"
+        "when -segopindex is enabled, and otherwise computed from the block on disk.\n",
+        {
+            {"proof", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The hex-encoded proof generated by getsegopproof"},
+        },
+        RPCResult{
+            RPCResult::Type::ARR, "", "The leaves the proof commits to, or empty array if the proof cannot be validated.",
+            {
+                {RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::STR_HEX, "txid", "The transaction id"},
+                    {RPCResult::Type::STR_HEX, "commitment", "The P2SOP commitment to its segOP payload"},
+                }},
+            }
+        },
+        RPCExamples{
+            HelpExampleCli("verifysegopproof", "\"proof\"")
+            + HelpExampleRpc("verifysegopproof", "\"proof\"")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            DataStream ssMB{ParseHexV(request.params[0], "proof")};
+            CSegopMerkleBlock merkleBlock;
+            ssMB >> merkleBlock;
+
+            UniValue res(UniValue::VARR);
+
+            const uint256 root{merkleBlock.ExtractMatches()};
+            if (root.IsNull()) return res;
+
+            ChainstateManager& chainman = EnsureAnyChainman(request.context);
+            const uint256 block_hash{merkleBlock.header.GetHash()};
+            const CBlockIndex* pindex;
+            {
+                LOCK(cs_main);
+                pindex = chainman.m_blockman.LookupBlockIndex(block_hash);
+                if (!pindex || !chainman.ActiveChain().Contains(pindex) || pindex->nTx == 0) {
+                    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found in chain");
+                }
+            }
+
+            SegopBlockRoot expected;
+            if (!g_segopindex || !g_segopindex->FindBlockRoot(block_hash, expected)) {
+                {
+                    LOCK(cs_main);
+                    CheckBlockDataAvailability(chainman.m_blockman, *pindex, /*check_for_undo=*/false);
+                }
+                CBlock block;
+                if (!chainman.m_blockman.ReadBlock(block, *pindex)) {
+                    throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
+                }
+                const auto leaves{GetSegopLeaves(block)};
+                expected = SegopBlockRoot{.root = ComputeSegopMerkleRoot(leaves), .leaves = static_cast<uint32_t>(leaves.size())};
+            }
+
+            // Check if proof is valid, only add results if so
+            if (root == expected.root && merkleBlock.GetNumLeaves() == expected.leaves) {
+                for (const auto& [txid, commitment] : merkleBlock.matched) {
+                    UniValue leaf(UniValue::VOBJ);
+                    leaf.pushKV("txid", txid.GetHex());
+                    leaf.pushKV("commitment", commitment.GetHex());
+                    res.push_back(std::move(leaf));
+                }
+            }
+
+            return res;
+        },
+    };
+}
+
 void RegisterTxoutProofRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
         {"blockchain", &gettxoutproof},
         {"blockchain", &verifytxoutproof},
+        {"blockchain", &getsegopproof},
+        {"blockchain", &verifysegopproof},
     };
     for (const auto& c : commands) {
         t.appendCommand(c.name, &c);
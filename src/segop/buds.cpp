@@ -1,6 +1,8 @@
 // src/segop/buds.cpp
 #include <segop/buds.h>
 
+#include <array>
+
 namespace segop {
 
 // -----------------------------------------------------------------------------
@@ -53,6 +55,43 @@ const char* ToString(ARBDATier tier)
     return "UNKNOWN_ARBDA";
 }
 
+std::optional<BUDSTier> BUDSTierFromString(std::string_view name)
+{
+    static constexpr std::array TIERS{
+        BUDSTier::T0_MONETARY, BUDSTier::T1_METADATA, BUDSTier::T2_OPERATIONAL, BUDSTier::T3_ARBITRARY,
+        BUDSTier::UNSPECIFIED, BUDSTier::AMBIGUOUS,
+    };
+    for (const BUDSTier tier : TIERS) {
+        if (name == ToString(tier)) return tier;
+    }
+    return std::nullopt;
+}
+
+std::optional<BUDSDataType> BUDSDataTypeFromString(std::string_view name)
+{
+    static constexpr std::array TYPES{
+        BUDSDataType::UNSPECIFIED,
+        BUDSDataType::TEXT_NOTE, BUDSDataType::JSON_METADATA, BUDSDataType::RECEIPT, BUDSDataType::INVOICE,
+        BUDSDataType::L2_STATE_ANCHOR, BUDSDataType::ROLLUP_BATCH_REF, BUDSDataType::PROOF_REF,
+        BUDSDataType::VAULT_METADATA, BUDSDataType::PEG_REF,
+        BUDSDataType::ARBITRARY_NAMESPACE,
+        BUDSDataType::UNKNOWN,
+    };
+    for (const BUDSDataType type : TYPES) {
+        if (name == ToString(type)) return type;
+    }
+    return std::nullopt;
+}
+
+std::optional<ARBDATier> ARBDATierFromString(std::string_view name)
+{
+    static constexpr std::array TIERS{ARBDATier::T0, ARBDATier::T1, ARBDATier::T2, ARBDATier::T3};
+    for (const ARBDATier tier : TIERS) {
+        if (name == ToString(tier)) return tier;
+    }
+    return std::nullopt;
+}
+
 // -----------------------------------------------------------------------------
 // Decode tier/type codes
 // -----------------------------------------------------------------------------
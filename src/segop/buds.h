@@ -5,6 +5,8 @@
 #define BITCOIN_SEGOP_BUDS_H
 
 #include <cstdint>
+#include <optional>
+#include <string_view>
 
 namespace segop {
 
@@ -71,6 +73,11 @@ const char* ToString(BUDSTier tier);
 const char* ToString(BUDSDataType type);
 const char* ToString(ARBDATier tier);
 
+// Inverse of ToString() (for RPC arguments); nullopt for unknown names
+std::optional<BUDSTier> BUDSTierFromString(std::string_view name);
+std::optional<BUDSDataType> BUDSDataTypeFromString(std::string_view name);
+std::optional<ARBDATier> ARBDATierFromString(std::string_view name);
+
 // Map raw tier byte -> enum (T0/T1/T2/T3/UNSPECIFIED)
 BUDSTier DecodeTierCode(uint8_t raw_code);
 
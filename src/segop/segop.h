@@ -10,7 +10,10 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <ios>
 #include <limits>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -21,6 +24,75 @@
 
 #include <segop/buds.h>
 
+/**
+ * Immutable, reference-counted segOP payload bytes.
+ *
+ * Payloads are up to 64 kB and a transaction is copied around a lot
+ * (CMutableTransaction -> CTransaction, mempool, compact block and getdata
+ * relay, RPC encoding), so copies share a single buffer instead of
+ * duplicating it. The bytes are never modified in place; assigning new
+ * contents replaces the buffer.
+ *
+ * Reads as a `const std::vector<unsigned char>&`, so existing helpers that
+ * take the payload bytes work unchanged.
+ */
+class SegopBytes
+{
+private:
+    std::shared_ptr<const std::vector<unsigned char>> m_bytes;
+
+    static const std::vector<unsigned char>& Empty()
+    {
+        static const std::vector<unsigned char> empty;
+        return empty;
+    }
+
+public:
+    SegopBytes() = default;
+    SegopBytes(std::vector<unsigned char> bytes)
+    {
+        if (!bytes.empty()) m_bytes = std::make_shared<const std::vector<unsigned char>>(std::move(bytes));
+    }
+
+    const std::vector<unsigned char>& get() const { return m_bytes ? *m_bytes : Empty(); }
+    operator const std::vector<unsigned char>&() const { return get(); }
+    operator std::span<const unsigned char>() const { return get(); }
+
+    size_t size() const { return get().size(); }
+    bool empty() const { return get().empty(); }
+    const unsigned char* data() const { return get().data(); }
+    std::vector<unsigned char>::const_iterator begin() const { return get().begin(); }
+    std::vector<unsigned char>::const_iterator end() const { return get().end(); }
+    unsigned char operator[](size_t pos) const { return get()[pos]; }
+
+    void clear() { m_bytes.reset(); }
+
+    /** Number of payloads sharing this buffer (0 if empty). */
+    long use_count() const { return m_bytes.use_count(); }
+
+    friend bool operator==(const SegopBytes& a, const SegopBytes& b)
+    {
+        return a.m_bytes == b.m_bytes || a.get() == b.get();
+    }
+    friend bool operator==(const SegopBytes& a, const std::vector<unsigned char>& b) { return a.get() == b; }
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << get();
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        std::vector<unsigned char> bytes;
+        s >> bytes;
+        *this = SegopBytes{std::move(bytes)};
+    }
+};
+
+inline bool SegopReadCompactSize(std::span<const unsigned char> bytes, size_t& i, uint64_t& size_out);
+
 /**
  * SegOP payload carried in the extended transaction serialization.
  *
@@ -45,7 +117,7 @@ struct CSegopPayload
     static constexpr std::size_t MAX_SEGOP_PAYLOAD_SIZE = 64'000;
 
     uint8_t version;
-    std::vector<unsigned char> data;
+    SegopBytes data;
 
     CSegopPayload() { SetNull(); }
 
@@ -66,15 +138,60 @@ struct CSegopPayload
         return data.size() > MAX_SEGOP_PAYLOAD_SIZE;
     }
 
-    SERIALIZE_METHODS(CSegopPayload, obj)
+    // NOTE:
+    //  - The 0x53 marker byte is *not* handled here; it is emitted/checked
+    //    by the transaction serializer when the segOP flag bit is set.
+    //  - SegopBytes serializes as std::vector<unsigned char>, i.e. with
+    //    CompactSize length encoding: [segop_len][segop_payload bytes].
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << version << data;
+    }
+
+    /**
+     * Reads the same layout, but never buffers more than the payload cap: a
+     * longer segop_len fails as soon as it is read. For v1 payloads the TLV
+     * framing (see SegopParseTLV()) is checked record by record as the bytes
+     * arrive, so a record with a non-canonical length or running past
+     * segop_len fails before the rest of the payload is read.
+     */
+    template <typename Stream>
+    void Unserialize(Stream& s)
     {
-        // NOTE:
-        //  - The 0x53 marker byte is *not* handled here; it is emitted/checked
-        //    by the transaction serializer when the segOP flag bit is set.
-        //  - std::vector<unsigned char> uses CompactSize/varint length encoding
-        //    automatically, so this matches: [segop_len][segop_payload bytes].
-        READWRITE(obj.version);
-        READWRITE(obj.data);
+        s >> version;
+        const uint64_t len{ReadCompactSize(s)};
+        if (len > MAX_SEGOP_PAYLOAD_SIZE) {
+            throw std::ios_base::failure("segOP payload exceeds size limit");
+        }
+        std::vector<unsigned char> bytes(len);
+        const auto read_bytes{[&](size_t pos, size_t count) {
+            s.read(std::as_writable_bytes(std::span{bytes}.subspan(pos, count)));
+        }};
+        if (version != SEGOP_VERSION) {
+            read_bytes(0, len);
+            data = SegopBytes{std::move(bytes)};
+            return;
+        }
+        size_t pos{0};
+        while (pos < len) {
+            // [type(1)][CompactSize prefix(1)]
+            if (len - pos < 2) throw std::ios_base::failure("segOP TLV record truncated");
+            read_bytes(pos, 2);
+            const uint8_t prefix{bytes[pos + 1]};
+            const size_t header{prefix < 253 ? 2U : prefix == 253 ? 4U : prefix == 254 ? 6U : 10U};
+            if (len - pos < header) throw std::ios_base::failure("segOP TLV record truncated");
+            read_bytes(pos + 2, header - 2);
+            uint64_t value_len{0};
+            size_t value_pos{pos + 1};
+            if (!SegopReadCompactSize(std::span{bytes}.first(pos + header), value_pos, value_len)) {
+                throw std::ios_base::failure("segOP TLV record has a non-canonical length");
+            }
+            if (value_len > len - value_pos) throw std::ios_base::failure("segOP TLV record truncated");
+            read_bytes(value_pos, value_len);
+            pos = value_pos + value_len;
+        }
+        data = SegopBytes{std::move(bytes)};
     }
 };
 
@@ -113,7 +230,7 @@ namespace SegopTlvType {
  */
 
 /**
- * segOP TLV helper: read a Bitcoin CompactSize (varint) from a byte vector.
+ * segOP TLV helper: read a Bitcoin CompactSize (varint) from a byte span.
  *
  * Returns false on overrun or non-canonical encoding.
  *
@@ -123,9 +240,9 @@ namespace SegopTlvType {
  *  - 254         : 0xfe + uint32 (little endian, >= 0x10000)
  *  - 255         : 0xff + uint64 (little endian, >= 0x100000000)
  */
-inline bool SegopReadCompactSize(const std::vector<unsigned char>& bytes,
-                                 size_t&                           i,
-                                 uint64_t&                         size_out)
+inline bool SegopReadCompactSize(std::span<const unsigned char> bytes,
+                                 size_t&                        i,
+                                 uint64_t&                      size_out)
 {
     const size_t n = bytes.size();
     if (i >= n) return false;
@@ -247,49 +364,57 @@ inline std::vector<unsigned char> BuildSegopTlvSequence(const std::vector<SegopT
     return out;
 }
 
+/** One TLV record of a segOP payload, viewing the payload bytes. */
+struct SegopTlvRecord
+{
+    uint8_t type;
+    std::span<const unsigned char> value;
+};
+
 /**
- * Validate that a raw segOP payload is a sequence of well-formed TLV
- * records with 1-byte type, CompactSize length and len bytes of data,
- * and that we end exactly at the boundary (no trailing slack).
+ * Forward iterator over the TLV records of a segOP payload.
  *
- * This enforces canonical CompactSize encoding, so malformed or
- * non-canonical encodings are rejected at consensus with
- * bad-txns-segop-tlv.
+ * Records are returned as views into the payload, so nothing is copied.
+ * Iteration stops at the end of the payload or at the first malformed
+ * record (non-canonical CompactSize length, or a value running past the
+ * end), after which Error() is true. Callers can stop early at any point.
+ *
+ *   SegopTlvIterator it{payload};
+ *   while (const auto record{it.Next()}) { ... }
+ *   if (!it.Done()) { malformed }
  */
-inline bool SegopIsValidTLV(const std::vector<unsigned char>& bytes)
+class SegopTlvIterator
 {
-    size_t i = 0;
-    const size_t n = bytes.size();
+private:
+    std::span<const unsigned char> m_bytes;
+    size_t m_pos{0};
+    bool m_error{false};
 
-    while (i < n) {
-        // Need at least a type byte
-        if (n - i < 1) return false;
+public:
+    explicit SegopTlvIterator(std::span<const unsigned char> bytes) : m_bytes{bytes} {}
 
-        uint8_t t = bytes[i++];
-        (void)t;
+    /** The next record, or std::nullopt at the end of the payload or on a malformed record. */
+    std::optional<SegopTlvRecord> Next()
+    {
+        if (m_error || m_pos >= m_bytes.size()) return std::nullopt;
 
-        // Read CompactSize length
+        const uint8_t type = m_bytes[m_pos++];
         uint64_t len = 0;
-        if (!SegopReadCompactSize(bytes, i, len)) {
-            return false;
-        }
-
-        // Guard against insane lengths / overflow
-        if (len > static_cast<uint64_t>(std::numeric_limits<size_t>::max())) {
-            return false;
-        }
-
-        if (n - i < static_cast<size_t>(len)) {
-            return false; // overrun
+        if (!SegopReadCompactSize(m_bytes, m_pos, len) || len > m_bytes.size() - m_pos) {
+            m_error = true;
+            return std::nullopt;
         }
-
-        // Skip value
-        i += static_cast<size_t>(len);
+        SegopTlvRecord record{type, m_bytes.subspan(m_pos, static_cast<size_t>(len))};
+        m_pos += static_cast<size_t>(len);
+        return record;
     }
 
-    // Must end exactly at boundary, no slack
-    return i == n;
-}
+    /** A malformed record was encountered. */
+    bool Error() const { return m_error; }
+
+    /** Every record was read, ending exactly at the payload boundary. */
+    bool Done() const { return !m_error && m_pos == m_bytes.size(); }
+};
 
 /**
  * Build a basic TLV payload for a UTF-8 text string.
@@ -388,6 +513,15 @@ inline std::vector<unsigned char> BuildSegopBlobTlv(const std::vector<unsigned c
     return BuildSegopTlvSequence(items);
 }
 
+/** A writer primed with the "segop:commitment" tag, to copy and feed a payload. */
+inline const HashWriter& SegopCommitmentWriter()
+{
+    // BIP340-style tagged hash writer seeded with "segop:commitment". The
+    // tag prefix is hashed once and its midstate copied for each payload.
+    static const HashWriter COMMITMENT_WRITER{TaggedHash("segop:commitment")};
+    return COMMITMENT_WRITER;
+}
+
 /**
  * Build the P2SOP blob used by the segOP commitment output.
  *
@@ -400,16 +534,19 @@ inline std::vector<unsigned char> BuildSegopBlobTlv(const std::vector<unsigned c
  *
  *   scriptPubKey = OP_RETURN <len = P2SOP_blob.size()> <P2SOP_blob bytes>
  */
-inline std::vector<unsigned char> BuildSegopCommitmentBlob(const std::vector<unsigned char>& segop_payload)
+inline uint256 SegopCommitment(std::span<const unsigned char> segop_payload)
 {
-    // BIP340-style tagged hash writer seeded with "segop:commitment".
-    HashWriter hw = TaggedHash("segop:commitment");
+    HashWriter hw{SegopCommitmentWriter()};
 
     // HashWriter::write expects std::span<const std::byte>.
-    // Convert the vector<unsigned char> to that via MakeUCharSpan + std::as_bytes.
-    hw.write(std::as_bytes(MakeUCharSpan(segop_payload)));
+    hw.write(std::as_bytes(segop_payload));
 
-    const uint256 segop_commitment = hw.GetHash();
+    return hw.GetHash();
+}
+
+inline std::vector<unsigned char> BuildSegopCommitmentBlob(const std::vector<unsigned char>& segop_payload)
+{
+    const uint256 segop_commitment = SegopCommitment(segop_payload);
 
     // Assemble "P2SOP" || segop_commitment
     std::vector<unsigned char> blob;
@@ -428,6 +565,42 @@ inline std::vector<unsigned char> BuildSegopCommitmentBlob(const std::vector<uns
     return blob;
 }
 
+/**
+ * Return true if `script` looks like *any* P2SOP output, regardless of which
+ * commitment it carries:
+ *
+ *   OP_RETURN <push_len >= 5> "P2SOP" ...
+ *
+ * Used by consensus to forbid stray P2SOP outputs, and by the payload store
+ * to recognise transactions whose segOP section was stripped on disk.
+ */
+inline bool SegopIsP2SOPScript(std::span<const unsigned char> script)
+{
+    // Need: OP_RETURN + 1-byte push opcode + at least 5 bytes of data.
+    if (script.size() < 1 + 1 + 5) return false;
+
+    if (script[0] != 0x6a /* OP_RETURN */) return false;
+
+    // Need at least 5 bytes of pushed data for "P2SOP".
+    if (script[1] < 5) return false;
+
+    return script[2] == 'P' && script[3] == '2' && script[4] == 'S' &&
+           script[5] == 'O' && script[6] == 'P';
+}
+
+/**
+ * Extract the 32-byte segop_commitment from a canonical v1 P2SOP script
+ * (OP_RETURN <0x25> "P2SOP" <commitment>). Returns std::nullopt for any
+ * other script.
+ */
+inline std::optional<uint256> SegopGetCommitment(std::span<const unsigned char> script)
+{
+    static constexpr size_t BLOB_SIZE{5 + uint256::size()};
+    if (script.size() != 2 + BLOB_SIZE || script[1] != BLOB_SIZE) return std::nullopt;
+    if (!SegopIsP2SOPScript(script)) return std::nullopt;
+    return uint256{script.subspan(2 + 5)};
+}
+
 // ---------------------------------------------------------------------------
 // BUDS + ARBDA helpers on top of segOP TLV
 // ---------------------------------------------------------------------------
@@ -453,10 +626,54 @@ struct SegopBUDSInfo
     bool ambiguous{false};
 };
 
+/** Fold the BUDS markers of one TLV record into `info` (see SegopParseTLV()). */
+inline void SegopBUDSAddRecord(SegopBUDSInfo& info, const SegopTlvRecord& record)
+{
+    // 0xF0 = Tier marker
+    if (record.type == 0xF0 && !record.value.empty()) {
+        uint8_t raw_tier = record.value[0];
+        segop::BUDSTier this_tier = segop::DecodeTierCode(raw_tier);
+
+        // Update presence bitmap
+        switch (this_tier) {
+        case segop::BUDSTier::T0_MONETARY:    info.presence.has_t0 = true; break;
+        case segop::BUDSTier::T1_METADATA:    info.presence.has_t1 = true; break;
+        case segop::BUDSTier::T2_OPERATIONAL: info.presence.has_t2 = true; break;
+        case segop::BUDSTier::T3_ARBITRARY:   info.presence.has_t3 = true; break;
+        case segop::BUDSTier::UNSPECIFIED:
+        case segop::BUDSTier::AMBIGUOUS:
+            break;
+        }
+
+        if (!info.has_tier) {
+            info.has_tier = true;
+            info.tier_code = raw_tier;
+            info.tier = this_tier;
+        } else if (this_tier != info.tier) {
+            info.ambiguous = true;
+        }
+    }
+
+    // 0xF1 = Data-type marker
+    if (record.type == 0xF1 && !record.value.empty() && !info.has_type) {
+        uint8_t raw_type = record.value[0];
+        info.type_code = raw_type;
+        info.type = segop::DecodeDataTypeCode(info.tier, raw_type);
+        info.has_type = true;
+    }
+}
+
 /**
- * Extract BUDS tier/type info and ARBDA tier from a segOP TLV payload.
+ * Validate a raw segOP payload as a sequence of well-formed TLV records
+ * with 1-byte type, CompactSize length and len bytes of data, ending
+ * exactly at the boundary (no trailing slack), and optionally extract its
+ * BUDS info in the same pass.
+ *
+ * This enforces canonical CompactSize encoding, so malformed or
+ * non-canonical encodings are rejected at consensus with
+ * bad-txns-segop-tlv.
  *
- * Convention:
+ * BUDS convention:
  *   - TLV type 0xF0, len=1 => Tier marker (value[0] = raw tier code).
  *   - TLV type 0xF1, len=1 => Data-type marker (value[0] = raw type code).
  *
@@ -464,93 +681,110 @@ struct SegopBUDSInfo
  * `tier = AMBIGUOUS`, but ARBDA still applies the conservative rule:
  * any T3 present anywhere => ARBDA = T3, else T2, else T1, else T0.
  *
- * If there are no 0xF0/0xF1 markers, tier/type remain UNSPECIFIED and ARBDA
- * falls back to T0 (no structured metadata observed in this payload).
+ * A non-empty payload without 0xF0/0xF1 markers is unlabelled arbitrary
+ * data (ARBDA T3); an empty one leaves ARBDA at T0.
+ *
+ * @param[out] info  if not null, the BUDS info of the records up to the
+ *                   first malformed one
+ * @returns whether the payload is a valid TLV sequence
  */
-inline SegopBUDSInfo SegopExtractBUDSInfo(const std::vector<unsigned char>& bytes)
+inline bool SegopParseTLV(std::span<const unsigned char> bytes, SegopBUDSInfo* info = nullptr)
 {
-    SegopBUDSInfo info;
-
-    // No segOP payload at all -> ARBDA sees no metadata, stays at T0.
-    if (bytes.empty()) {
-        info.arbda = segop::ComputeARBDATier(info.presence);
-        return info;
+    SegopTlvIterator it{bytes};
+    while (const auto record{it.Next()}) {
+        if (info) SegopBUDSAddRecord(*info, *record);
     }
 
-    size_t i = 0;
-    const size_t n = bytes.size();
-
-    while (i < n) {
-        if (n - i < 1) {
-            break; // truncated
+    if (info) {
+        if (info->ambiguous) {
+            info->tier = segop::BUDSTier::AMBIGUOUS;
         }
-
-        uint8_t tlv_type = bytes[i++];
-
-        uint64_t len = 0;
-        if (!SegopReadCompactSize(bytes, i, len)) {
-            break; // malformed CompactSize -> stop decoding
-        }
-
-        if (n - i < static_cast<size_t>(len)) {
-            break; // overrun -> stop
-        }
-
-        const unsigned char* value_ptr = (len > 0) ? &bytes[i] : nullptr;
-
-        // 0xF0 = Tier marker
-        if (tlv_type == 0xF0 && len >= 1) {
-            uint8_t raw_tier = value_ptr[0];
-            segop::BUDSTier this_tier = segop::DecodeTierCode(raw_tier);
-
-            // Update presence bitmap
-            switch (this_tier) {
-            case segop::BUDSTier::T0_MONETARY:    info.presence.has_t0 = true; break;
-            case segop::BUDSTier::T1_METADATA:    info.presence.has_t1 = true; break;
-            case segop::BUDSTier::T2_OPERATIONAL: info.presence.has_t2 = true; break;
-            case segop::BUDSTier::T3_ARBITRARY:   info.presence.has_t3 = true; break;
-            case segop::BUDSTier::UNSPECIFIED:
-            case segop::BUDSTier::AMBIGUOUS:
-                break;
-            }
-
-            if (!info.has_tier) {
-                info.has_tier = true;
-                info.tier_code = raw_tier;
-                info.tier = this_tier;
-            } else if (this_tier != info.tier) {
-                info.ambiguous = true;
-            }
-        }
-
-        // 0xF1 = Data-type marker
-        if (tlv_type == 0xF1 && len >= 1 && !info.has_type) {
-            uint8_t raw_type = value_ptr[0];
-            info.type_code = raw_type;
-            info.type = segop::DecodeDataTypeCode(info.tier, raw_type);
-            info.has_type = true;
+        // IMPORTANT: segOP payload exists but no tier markers at all
+        // => treat as "unlabelled arbitrary data" for ARBDA purposes.
+        if (!info->has_tier && !bytes.empty()) {
+            info->presence.has_t3 = true;
         }
-
-        // Advance to next TLV
-        i += static_cast<size_t>(len);
+        // Apply ARBDA rule using the presence bitmap.
+        info->arbda = segop::ComputeARBDATier(info->presence);
     }
 
-    if (info.ambiguous) {
-        info.tier = segop::BUDSTier::AMBIGUOUS;
-    }
-
-    // IMPORTANT: segOP payload exists but no tier markers at all
-    // => treat as "unlabelled arbitrary data" for ARBDA purposes.
-    if (!info.has_tier && !bytes.empty()) {
-        info.presence.has_t3 = true;
-    }
+    return it.Done();
+}
 
-    // Apply ARBDA rule using the presence bitmap.
-    info.arbda = segop::ComputeARBDATier(info.presence);
+/** Consensus TLV validation; see SegopParseTLV(). */
+inline bool SegopIsValidTLV(std::span<const unsigned char> bytes)
+{
+    return SegopParseTLV(bytes);
+}
 
+/**
+ * Extract BUDS tier/type info and ARBDA tier from a segOP TLV payload.
+ * Decoding stops at the first malformed record; see SegopParseTLV().
+ */
+inline SegopBUDSInfo SegopExtractBUDSInfo(std::span<const unsigned char> bytes)
+{
+    SegopBUDSInfo info;
+    SegopParseTLV(bytes, &info);
     return info;
 }
 
+/**
+ * SegopBUDSInfo without the presence bitmap, in five bytes, for caching
+ * alongside each mempool transaction. The presence bitmap is only needed to
+ * compute the ARBDA tier, which is kept.
+ */
+class SegopPackedBUDSInfo
+{
+    static constexpr uint8_t ARBDA_MASK{0x03};
+    static constexpr uint8_t HAS_TIER{0x04};
+    static constexpr uint8_t HAS_TYPE{0x08};
+    static constexpr uint8_t AMBIGUOUS{0x10};
+
+    uint8_t m_tier_code{0xff};
+    uint8_t m_type_code{0xff};
+    segop::BUDSTier m_tier{segop::BUDSTier::UNSPECIFIED};
+    segop::BUDSDataType m_type{segop::BUDSDataType::UNSPECIFIED};
+    //! ARBDA tier in the low two bits, then HAS_TIER, HAS_TYPE and AMBIGUOUS
+    uint8_t m_flags{0};
+
+public:
+    SegopPackedBUDSInfo() = default;
+    explicit SegopPackedBUDSInfo(const SegopBUDSInfo& info)
+        : m_tier_code{info.tier_code},
+          m_type_code{info.type_code},
+          m_tier{info.tier},
+          m_type{info.type},
+          m_flags{static_cast<uint8_t>((static_cast<uint8_t>(info.arbda) & ARBDA_MASK) |
+                                       (info.has_tier ? HAS_TIER : 0) |
+                                       (info.has_type ? HAS_TYPE : 0) |
+                                       (info.ambiguous ? AMBIGUOUS : 0))} {}
+
+    uint8_t TierCode() const { return m_tier_code; }
+    uint8_t TypeCode() const { return m_type_code; }
+    segop::BUDSTier Tier() const { return m_tier; }
+    segop::BUDSDataType Type() const { return m_type; }
+    segop::ARBDATier ARBDA() const { return static_cast<segop::ARBDATier>(m_flags & ARBDA_MASK); }
+    bool HasTier() const { return m_flags & HAS_TIER; }
+    bool HasType() const { return m_flags & HAS_TYPE; }
+    bool IsAmbiguous() const { return m_flags & AMBIGUOUS; }
+
+    /** The unpacked info, with an empty presence bitmap. */
+    SegopBUDSInfo Unpack() const
+    {
+        SegopBUDSInfo info;
+        info.tier_code = m_tier_code;
+        info.type_code = m_type_code;
+        info.tier = m_tier;
+        info.type = m_type;
+        info.arbda = ARBDA();
+        info.has_tier = HasTier();
+        info.has_type = HasType();
+        info.ambiguous = IsAmbiguous();
+        return info;
+    }
+};
+static_assert(sizeof(SegopPackedBUDSInfo) == 5);
+
 inline std::vector<unsigned char> BuildSegopBUDSTextPayload(uint8_t raw_tier_code,
                                                             uint8_t raw_type_code,
                                                             const std::string& text)
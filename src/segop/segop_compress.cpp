@@ -0,0 +1,146 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <segop/segop_compress.h>
+
+#include <segop/segop.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace segop {
+
+namespace {
+
+constexpr size_t MIN_MATCH{4};
+constexpr size_t MAX_OFFSET{0xffff};
+//! Token nibble value meaning "length continues in the following bytes".
+constexpr size_t RUN_MASK{15};
+//! The last bytes of the input are always emitted as literals.
+constexpr size_t END_LITERALS{5};
+constexpr int HASH_BITS{12};
+
+uint32_t Load32(const unsigned char* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+uint32_t Hash(uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - HASH_BITS);
+}
+
+void WriteLength(std::vector<unsigned char>& out, size_t len)
+{
+    for (len -= RUN_MASK; len >= 255; len -= 255) out.push_back(255);
+    out.push_back(static_cast<unsigned char>(len));
+}
+
+/** Emit one sequence; `match_len` 0 is the final, literals-only one. */
+void WriteSequence(std::vector<unsigned char>& out, std::span<const unsigned char> literals, size_t offset, size_t match_len)
+{
+    const size_t extra{match_len > 0 ? match_len - MIN_MATCH : 0};
+    out.push_back(static_cast<unsigned char>(std::min(literals.size(), RUN_MASK) << 4 | std::min(extra, RUN_MASK)));
+    if (literals.size() >= RUN_MASK) WriteLength(out, literals.size());
+    out.insert(out.end(), literals.begin(), literals.end());
+    if (match_len == 0) return;
+    out.push_back(static_cast<unsigned char>(offset & 0xff));
+    out.push_back(static_cast<unsigned char>(offset >> 8));
+    if (extra >= RUN_MASK) WriteLength(out, extra);
+}
+
+} // namespace
+
+bool CompressionOptions::ShouldCompress(const CSegopPayload& payload) const
+{
+    if (!Enabled() || payload.data.size() < min_size) return false;
+    // A payload is usually one bulk record plus a few small labels (BUDS
+    // tags); what the bulk record holds decides whether compression pays.
+    SegopTlvIterator it{payload.data};
+    std::optional<SegopTlvRecord> largest;
+    while (const auto record{it.Next()}) {
+        if (!largest || record->value.size() > largest->value.size()) largest = record;
+    }
+    return largest && tlv_types.contains(largest->type);
+}
+
+std::vector<unsigned char> LZCompress(std::span<const unsigned char> in)
+{
+    std::vector<unsigned char> out;
+    out.reserve(in.size() + in.size() / 255 + 16);
+    // Most recent position (plus one; 0 is empty) of each hashed 4-byte sequence.
+    std::vector<uint32_t> table(size_t{1} << HASH_BITS, 0);
+
+    const size_t end{in.size()};
+    size_t anchor{0};
+    size_t pos{0};
+    if (end > MIN_MATCH + END_LITERALS) {
+        const size_t match_end{end - END_LITERALS};
+        while (pos + MIN_MATCH <= match_end) {
+            const uint32_t seq{Load32(&in[pos])};
+            uint32_t& slot{table[Hash(seq)]};
+            const size_t candidate{slot};
+            slot = static_cast<uint32_t>(pos + 1);
+            if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || Load32(&in[candidate - 1]) != seq) {
+                ++pos;
+                continue;
+            }
+            size_t match{candidate - 1};
+            size_t len{MIN_MATCH};
+            while (pos + len < match_end && in[match + len] == in[pos + len]) ++len;
+            while (pos > anchor && match > 0 && in[pos - 1] == in[match - 1]) {
+                --pos;
+                --match;
+                ++len;
+            }
+            WriteSequence(out, in.subspan(anchor, pos - anchor), pos - match, len);
+            pos += len;
+            anchor = pos;
+        }
+    }
+    WriteSequence(out, in.subspan(anchor), 0, 0);
+    return out;
+}
+
+std::optional<std::vector<unsigned char>> LZDecompress(std::span<const unsigned char> in, size_t size)
+{
+    std::vector<unsigned char> out;
+    out.reserve(size);
+    size_t pos{0};
+    const auto read_length{[&](size_t& len) {
+        if (len < RUN_MASK) return true;
+        unsigned char byte;
+        do {
+            if (pos >= in.size()) return false;
+            byte = in[pos++];
+            len += byte;
+        } while (byte == 255);
+        return true;
+    }};
+
+    while (pos < in.size()) {
+        const unsigned char token{in[pos++]};
+        size_t literals{size_t{token} >> 4};
+        if (!read_length(literals) || literals > in.size() - pos || literals > size - out.size()) return std::nullopt;
+        out.insert(out.end(), in.begin() + pos, in.begin() + pos + literals);
+        pos += literals;
+        if (pos == in.size()) break;
+
+        if (in.size() - pos < 2) return std::nullopt;
+        const size_t offset{in[pos] | size_t{in[pos + 1]} << 8};
+        pos += 2;
+        size_t len{size_t{token} & RUN_MASK};
+        if (!read_length(len)) return std::nullopt;
+        len += MIN_MATCH;
+        if (offset == 0 || offset > out.size() || len > size - out.size()) return std::nullopt;
+        // Byte by byte: the match may overlap the bytes it produces.
+        for (size_t from{out.size() - offset}; len > 0; --len) out.push_back(out[from++]);
+    }
+    if (out.size() != size) return std::nullopt;
+    return out;
+}
+
+} // namespace segop
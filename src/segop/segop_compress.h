@@ -0,0 +1,54 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SEGOP_SEGOP_COMPRESS_H
+#define BITCOIN_SEGOP_SEGOP_COMPRESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <span>
+#include <vector>
+
+struct CSegopPayload;
+
+namespace segop {
+
+/** Payloads smaller than this are not worth compressing by default. */
+static constexpr size_t DEFAULT_SEGOP_COMPRESS_MIN_SIZE{512};
+
+/**
+ * Which payloads the lane store keeps compressed on disk (non-consensus,
+ * local storage only). A payload qualifies if it is at least `min_size`
+ * bytes and its largest TLV record is of one of `tlv_types`. Text and JSON
+ * compress well; opaque blobs and hashes mostly do not.
+ */
+struct CompressionOptions {
+    std::set<uint8_t> tlv_types{};
+    size_t min_size{DEFAULT_SEGOP_COMPRESS_MIN_SIZE};
+
+    bool Enabled() const { return !tlv_types.empty(); }
+    bool ShouldCompress(const CSegopPayload& payload) const;
+};
+
+/**
+ * Compress `in` with a small LZ77 codec, using the LZ4 block format:
+ * sequences of [token][literal length][literals][offset (2, LE)][match length],
+ * the token holding 4 bits of each length, with at least 4 bytes per match.
+ * The final sequence has literals only. Single pass, no entropy coding, so
+ * decompression is about as fast as a copy.
+ */
+std::vector<unsigned char> LZCompress(std::span<const unsigned char> in);
+
+/**
+ * Decompress the output of LZCompress(). Every length and offset is checked
+ * against the input and against `size`, the exact decompressed size, so a
+ * corrupted input fails instead of reading or writing out of bounds.
+ */
+std::optional<std::vector<unsigned char>> LZDecompress(std::span<const unsigned char> in, size_t size);
+
+} // namespace segop
+
+#endif // BITCOIN_SEGOP_SEGOP_COMPRESS_H
@@ -69,10 +69,7 @@ bool IsPrunedHeight(int tip_height, int block_height)
         return false;
     }
 
-    // Effective retention window: E = max(W, R)
-    const int validation = policy.validation_window;
-    const int operator_w = policy.operator_window;
-    const int E = std::max(validation, operator_w);
+    const int E = GetEffectiveWindow();
 
     // If misconfigured, keep everything.
     if (E <= 0) {
@@ -83,4 +80,44 @@ bool IsPrunedHeight(int tip_height, int block_height)
     return depth >= E;
 }
 
+int GetEffectiveWindow()
+{
+    // Effective retention window: E = max(W, R)
+    return std::max(g_prune_policy.validation_window, g_prune_policy.operator_window);
+}
+
+int FirstRetainedHeight(int tip_height)
+{
+    if (!g_prune_policy.enabled || tip_height < 0) {
+        return 0;
+    }
+
+    const int E = GetEffectiveWindow();
+    if (E <= 0) {
+        return 0;
+    }
+
+    // Heights [tip - E + 1 .. tip] are retained; consistent with IsPrunedHeight().
+    return std::max(0, tip_height - E + 1);
+}
+
+int FirstArchivedHeight(int tip_height)
+{
+    if (g_prune_policy.archive_window <= 0 || tip_height < 0) {
+        return 0;
+    }
+    return std::max(0, tip_height - g_prune_policy.archive_window + 1);
+}
+
+bool IsInValidationWindow(int tip_height, int block_height)
+{
+    return block_height > tip_height - std::max(g_prune_policy.validation_window, 1);
+}
+
+bool CoversValidationWindow(int min_retained_height, int tip_height)
+{
+    const int W = std::max(g_prune_policy.validation_window, 1);
+    return min_retained_height <= std::max(0, tip_height - W + 1);
+}
+
 } // namespace segop
@@ -61,12 +61,46 @@ void InitPrunePolicy(int validation_window,
  * Return true if a block at `block_height` should be treated as
  * "segOP-pruned" when the active chain tip is `tip_height`.
  *
- * This does NOT affect consensus or disk layout; it is used by
- * RPC / REST / UI layers to decide whether to expose segOP hex/TLV.
+ * This does NOT affect consensus; it is used by RPC / REST / UI layers to
+ * decide whether to expose segOP hex/TLV. The payload store applies the
+ * same boundary on disk (see FirstRetainedHeight()).
  */
 bool IsPrunedHeight(int tip_height, int block_height);
 // Returns true if segOP pruning is globally enabled (view-layer policy).
 bool IsPruneEnabled();
+
+// Effective retention window E = max(W, R) in blocks (spec §10.4).
+int GetEffectiveWindow();
+
+/**
+ * Lowest block height whose segOP payloads must still be retained when the
+ * active chain tip is `tip_height`, i.e. tip - E + 1. Everything below may
+ * be deleted from the payload store. Returns 0 (keep everything) when
+ * pruning is disabled or misconfigured.
+ */
+int FirstRetainedHeight(int tip_height);
+
+/**
+ * Lowest block height still inside the archive window A when the active
+ * chain tip is `tip_height`, i.e. tip - A + 1. Payload files wholly below
+ * it are compacted, whether or not pruning is enabled. Returns 0 (compact
+ * nothing) when A is not set.
+ */
+int FirstArchivedHeight(int tip_height);
+
+/**
+ * True if `block_height` lies within the validation window W at
+ * `tip_height`, i.e. its payload can be expected from any
+ * NODE_SOP_RECENT peer.
+ */
+bool IsInValidationWindow(int tip_height, int block_height);
+
+/**
+ * True if a node that retains payloads from `min_retained_height` on covers
+ * the whole validation window at `tip_height` and may therefore signal
+ * NODE_SOP_RECENT (spec §11.2.1: min_retained_height <= tip_height - W + 1).
+ */
+bool CoversValidationWindow(int min_retained_height, int tip_height);
 } // namespace segop
 
 #endif // BITCOIN_SEGOP_SEGOP_PRUNE_H
@@ -0,0 +1,93 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <segop/segop_request.h>
+
+#include <util/check.h>
+
+namespace segop {
+
+void SegopRequestTracker::ClearInFlight(Entry& entry)
+{
+    if (!entry.in_flight) return;
+    const auto it{m_in_flight_count.find(*entry.in_flight)};
+    if (Assume(it != m_in_flight_count.end()) && --it->second == 0) {
+        m_in_flight_count.erase(it);
+    }
+    entry.in_flight.reset();
+}
+
+bool SegopRequestTracker::Want(const Txid& txid, const Wanted& wanted)
+{
+    if (m_entries.size() >= MAX_SEGOP_WANTED) return false;
+    const auto [it, inserted]{m_entries.try_emplace(txid)};
+    if (inserted) it->second.wanted = wanted;
+    return inserted;
+}
+
+void SegopRequestTracker::ForgetTxid(const Txid& txid)
+{
+    const auto it{m_entries.find(txid)};
+    if (it == m_entries.end()) return;
+    ClearInFlight(it->second);
+    m_entries.erase(it);
+}
+
+void SegopRequestTracker::DisconnectedPeer(NodeId peer)
+{
+    if (!m_in_flight_count.contains(peer)) return;
+    for (auto& [txid, entry] : m_entries) {
+        if (entry.in_flight == peer) {
+            entry.tried.insert(peer);
+            ClearInFlight(entry);
+        }
+    }
+    Assume(!m_in_flight_count.contains(peer));
+}
+
+std::vector<Txid> SegopRequestTracker::GetRequestable(NodeId peer, bool is_archive, std::chrono::microseconds now)
+{
+    std::vector<Txid> selected;
+    size_t budget{MAX_GETSEGOPDATA_SIZE - std::min(MAX_GETSEGOPDATA_SIZE, CountInFlight(peer))};
+
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        Entry& entry{it->second};
+        if (entry.in_flight && entry.expiry <= now) {
+            entry.tried.insert(*entry.in_flight);
+            ClearInFlight(entry);
+        }
+        if (!entry.in_flight && entry.tried.size() >= MAX_SEGOP_REQUEST_ATTEMPTS) {
+            it = m_entries.erase(it);
+            continue;
+        }
+        if (budget > 0 && !entry.in_flight && !entry.tried.contains(peer) &&
+            (is_archive || !entry.wanted.archive_only)) {
+            entry.in_flight = peer;
+            entry.expiry = now + SEGOPDATA_REQUEST_TIMEOUT;
+            ++m_in_flight_count[peer];
+            selected.push_back(it->first);
+            --budget;
+        }
+        ++it;
+    }
+    return selected;
+}
+
+std::optional<SegopRequestTracker::Wanted> SegopRequestTracker::ReceivedResponse(NodeId peer, const Txid& txid)
+{
+    const auto it{m_entries.find(txid)};
+    if (it == m_entries.end() || it->second.in_flight != peer) return std::nullopt;
+    Entry& entry{it->second};
+    entry.tried.insert(peer);
+    ClearInFlight(entry);
+    return entry.wanted;
+}
+
+size_t SegopRequestTracker::CountInFlight(NodeId peer) const
+{
+    const auto it{m_in_flight_count.find(peer)};
+    return it == m_in_flight_count.end() ? 0 : it->second;
+}
+
+} // namespace segop
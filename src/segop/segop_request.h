@@ -0,0 +1,117 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SEGOP_SEGOP_REQUEST_H
+#define BITCOIN_SEGOP_SEGOP_REQUEST_H
+
+#include <net.h>
+#include <primitives/transaction.h>
+#include <segop/segop.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace segop {
+
+/** Maximum number of txids in one getsegopdata message (spec §11.9.1). */
+static constexpr size_t MAX_GETSEGOPDATA_SIZE{64};
+/** Maximum number of entries in one segopdata message (spec §11.9.1). */
+static constexpr size_t MAX_SEGOPDATA_ENTRIES{16};
+/** Soft cap on the serialized size of one segopdata message (spec §11.9.1). A single entry may exceed it. */
+static constexpr size_t MAX_SEGOPDATA_MSG_BYTES{128 * 1000};
+/** How long to wait for a segopdata or notfound reply before asking another peer. */
+static constexpr auto SEGOPDATA_REQUEST_TIMEOUT{std::chrono::seconds{20}};
+/** Maximum number of payloads tracked at once. Further Want() calls are ignored. */
+static constexpr size_t MAX_SEGOP_WANTED{4096};
+/** Number of peers asked for a payload before giving up on it. */
+static constexpr size_t MAX_SEGOP_REQUEST_ATTEMPTS{8};
+
+/** One entry of a segopdata message: the txid followed by sopver, soplen and the payload bytes. */
+struct SegopDataEntry {
+    Txid txid;
+    CSegopPayload payload;
+
+    SERIALIZE_METHODS(SegopDataEntry, obj) { READWRITE(obj.txid, obj.payload); }
+};
+
+/**
+ * Schedules getsegopdata requests, modeled on TxRequestTracker but much
+ * simpler since there are no announcements: the caller decides which
+ * payloads it wants, together with the P2SOP commitment each must match,
+ * and every peer advertising NODE_SOP_RECENT or NODE_SOP_ARCHIVE is a
+ * candidate to serve them.
+ *
+ * - A payload is requested from at most one peer at a time.
+ * - A payload is never requested twice from the same peer; a timeout,
+ *   notfound or bad response counts as a failed attempt for that peer.
+ * - Payloads older than the validation window (`archive_only`) are only
+ *   requested from NODE_SOP_ARCHIVE peers (spec §11.8, §11.9.8).
+ * - After MAX_SEGOP_REQUEST_ATTEMPTS failed attempts the payload is dropped.
+ *
+ * Not thread-safe; callers must provide their own locking.
+ */
+class SegopRequestTracker
+{
+public:
+    struct Wanted {
+        uint256 commitment{};
+        int height{0};
+        bool archive_only{false};
+    };
+
+private:
+    struct Entry {
+        Wanted wanted;
+        std::optional<NodeId> in_flight;
+        std::chrono::microseconds expiry{0};
+        std::set<NodeId> tried;
+    };
+
+    std::map<Txid, Entry> m_entries;
+    std::map<NodeId, size_t> m_in_flight_count;
+
+    void ClearInFlight(Entry& entry);
+
+public:
+    /** Start tracking a payload. Returns false if it is already tracked or the tracker is full. */
+    bool Want(const Txid& txid, const Wanted& wanted);
+
+    /** Stop tracking a payload (received, or no longer needed). */
+    void ForgetTxid(const Txid& txid);
+
+    /** Forget a peer; payloads in flight to it become requestable again. */
+    void DisconnectedPeer(NodeId peer);
+
+    /**
+     * Expire timed out requests, then pick up to MAX_GETSEGOPDATA_SIZE
+     * payloads to request from `peer` and mark them in flight until
+     * `now + SEGOPDATA_REQUEST_TIMEOUT`.
+     */
+    std::vector<Txid> GetRequestable(NodeId peer, bool is_archive, std::chrono::microseconds now);
+
+    /**
+     * A segopdata entry or notfound for `txid` was received from `peer`.
+     * Returns what was wanted if it was in flight to that peer, and
+     * std::nullopt for unsolicited responses. Either way the attempt on
+     * `peer` is over: the caller calls ForgetTxid() once a valid payload is
+     * in hand, otherwise the payload becomes requestable from other peers.
+     */
+    std::optional<Wanted> ReceivedResponse(NodeId peer, const Txid& txid);
+
+    /** Number of requests currently in flight to `peer`. */
+    size_t CountInFlight(NodeId peer) const;
+
+    /** Number of payloads tracked. */
+    size_t Size() const { return m_entries.size(); }
+};
+
+} // namespace segop
+
+#endif // BITCOIN_SEGOP_SEGOP_REQUEST_H
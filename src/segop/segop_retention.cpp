@@ -0,0 +1,43 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <segop/segop_retention.h>
+
+#include <chain.h>
+#include <kernel/chain.h>
+#include <logging.h>
+#include <segop/segop_prune.h>
+#include <segop/segop_store.h>
+
+#include <algorithm>
+
+namespace segop {
+
+RetentionManager::RetentionManager(PayloadStore& store, int prune_batch, uint64_t compact_bytes)
+    : m_store{store}, m_prune_batch{std::max(prune_batch, 1)}, m_compact_bytes{std::max<uint64_t>(compact_bytes, 1)}
+{}
+
+bool RetentionManager::Step(int tip_height)
+{
+    if (IsPruneEnabled()) {
+        const auto progress{m_store.PruneStep(FirstRetainedHeight(tip_height), m_prune_batch)};
+        if (!progress.done) {
+            LogDebug(BCLog::PRUNE, "segOP: erased %d payload(s) at tip height %d, more left to prune\n", progress.records, tip_height);
+            return true;
+        }
+    }
+    const int archived_height{FirstArchivedHeight(tip_height)};
+    if (archived_height <= 0) return false;
+    const auto progress{m_store.CompactStep(archived_height, m_compact_bytes)};
+    return progress && (!progress->done || progress->reclaimed > 0);
+}
+
+void RetentionManager::BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    // The background chainstate trails the tip the windows are measured from.
+    if (role == ChainstateRole::BACKGROUND) return;
+    Step(pindex->nHeight);
+}
+
+} // namespace segop
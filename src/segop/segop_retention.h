@@ -0,0 +1,63 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SEGOP_SEGOP_RETENTION_H
+#define BITCOIN_SEGOP_SEGOP_RETENTION_H
+
+#include <validationinterface.h>
+
+#include <cstdint>
+#include <memory>
+
+class CBlock;
+class CBlockIndex;
+
+namespace segop {
+
+class PayloadStore;
+
+/** Default number of payload index entries erased per connected block (-segopprunebatch). */
+static constexpr int DEFAULT_SEGOP_PRUNE_BATCH{10'000};
+/** Default number of sop file bytes copied per connected block while compacting (-segopcompactbytes). */
+static constexpr uint64_t DEFAULT_SEGOP_COMPACT_BYTES{16 << 20};
+
+/**
+ * Applies the segOP retention policy to the payload store as the chain
+ * advances, one bounded step per connected block:
+ *
+ *  - payloads below tip - E + 1 are deleted, at most `prune_batch` index
+ *    entries per step, so that a backlog (pruning newly enabled, or E
+ *    lowered) is spread over many blocks instead of stalling one;
+ *  - once nothing is left to prune, files below the archive window A
+ *    (tip - A + 1) are compacted one at a time, copying at most
+ *    `compact_bytes` per step.
+ *
+ * Steps run on the validation interface queue, off the block connection
+ * path. Progress is durable in the store, so a restart simply resumes.
+ */
+class RetentionManager final : public CValidationInterface
+{
+private:
+    PayloadStore& m_store;
+    const int m_prune_batch;
+    const uint64_t m_compact_bytes;
+
+public:
+    explicit RetentionManager(PayloadStore& store, int prune_batch = DEFAULT_SEGOP_PRUNE_BATCH,
+                              uint64_t compact_bytes = DEFAULT_SEGOP_COMPACT_BYTES);
+
+    /**
+     * Do one step of retention work for a chain tip at `tip_height`.
+     *
+     * @returns true if work is left for later steps
+     */
+    bool Step(int tip_height);
+
+protected:
+    void BlockConnected(ChainstateRole role, const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+};
+
+} // namespace segop
+
+#endif // BITCOIN_SEGOP_SEGOP_RETENTION_H
@@ -0,0 +1,749 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <segop/segop_store.h>
+
+#include <logging.h>
+#include <segop/segop.h>
+#include <segop/segop_compress.h>
+#include <streams.h>
+#include <util/fs_helpers.h>
+#include <util/syserror.h>
+
+#include <algorithm>
+#include <ios>
+#include <limits>
+#include <set>
+
+namespace segop {
+
+constexpr uint8_t DB_PAYLOAD{'t'};
+constexpr uint8_t DB_FILE_PAYLOAD{'p'};
+constexpr uint8_t DB_FILE_INFO{'f'};
+constexpr uint8_t DB_FILE_DEAD{'d'};
+constexpr uint8_t DB_STRIPPED_BLOCK{'b'};
+constexpr uint8_t DB_LAST_FILE{'l'};
+constexpr uint8_t DB_PRUNE_HEIGHT{'h'};
+constexpr uint8_t DB_FIRST_HEIGHT{'g'};
+constexpr uint8_t DB_COMPACTING{'c'};
+constexpr uint8_t DB_CONTENT{'s'};
+constexpr uint8_t DB_FILE_CONTENT{'q'};
+constexpr uint8_t DB_ALIAS{'a'};
+
+namespace {
+
+/**
+ * Per-file listing keys [DB_FILE_PAYLOAD, file (BE), txid] and
+ * [DB_FILE_CONTENT, file (BE), commitment]. The file number is big-endian so
+ * that all entries of one file are contiguous in the index and can be erased
+ * with a single range scan when the file is pruned.
+ */
+struct DBFilePayloadKey {
+    uint8_t prefix;
+    int file;
+    uint256 hash;
+
+    explicit DBFilePayloadKey(int file_in = 0, const uint256& hash_in = uint256{}, uint8_t prefix_in = DB_FILE_PAYLOAD)
+        : prefix(prefix_in), file(file_in), hash(hash_in) {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, prefix);
+        ser_writedata32be(s, file);
+        s << hash;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        prefix = ser_readdata8(s);
+        if (prefix != DB_FILE_PAYLOAD && prefix != DB_FILE_CONTENT) {
+            throw std::ios_base::failure("Invalid format for segOP store file key");
+        }
+        file = ser_readdata32be(s);
+        s >> hash;
+    }
+};
+
+/**
+ * One record of a sop file: [txid][CSegopPayload], or, for a payload stored
+ * compressed, [txid][0x00][version][uncompressed size (CompactSize)]
+ * [compressed bytes]. Consensus only accepts non-zero payload versions, so
+ * the 0x00 marker never begins a plain record, and plain records are
+ * exactly what the store wrote before compression existed.
+ *
+ * Records are copied as they are by compaction; the payload is only
+ * decompressed when it is read.
+ */
+struct SopRecord {
+    uint256 txid;
+    uint8_t version{0};
+    //! Uncompressed size, or 0 if `bytes` are the payload itself.
+    uint64_t raw_size{0};
+    SegopBytes bytes;
+
+    SopRecord() = default;
+    SopRecord(const Txid& txid_in, const CSegopPayload& payload, const CompressionOptions& compression)
+        : txid{txid_in.ToUint256()}, version{payload.version}, bytes{payload.data}
+    {
+        if (!compression.ShouldCompress(payload)) return;
+        auto compressed{LZCompress(payload.data)};
+        if (compressed.size() < payload.data.size()) {
+            raw_size = payload.data.size();
+            bytes = SegopBytes{std::move(compressed)};
+        }
+    }
+
+    /** The payload as committed to, decompressed if need be. */
+    std::optional<CSegopPayload> GetPayload() const
+    {
+        CSegopPayload payload;
+        payload.version = version;
+        if (raw_size == 0) {
+            payload.data = bytes;
+            return payload;
+        }
+        auto raw{LZDecompress(bytes, raw_size)};
+        if (!raw) return std::nullopt;
+        payload.data = SegopBytes{std::move(*raw)};
+        return payload;
+    }
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << txid;
+        if (raw_size > 0) {
+            s << uint8_t{0} << version;
+            WriteCompactSize(s, raw_size);
+        } else {
+            s << version;
+        }
+        s << bytes;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        s >> txid;
+        uint8_t marker;
+        s >> marker;
+        raw_size = 0;
+        if (marker == 0) {
+            s >> version;
+            raw_size = ReadCompactSize(s);
+            if (raw_size == 0 || raw_size > CSegopPayload::MAX_SEGOP_PAYLOAD_SIZE) {
+                throw std::ios_base::failure("Invalid size of compressed segOP payload record");
+            }
+        } else {
+            version = marker;
+        }
+        std::vector<unsigned char> data(ReadCompactSize(s));
+        if (data.size() > CSegopPayload::MAX_SEGOP_PAYLOAD_SIZE) {
+            throw std::ios_base::failure("segOP payload record exceeds size limit");
+        }
+        s.read(MakeWritableByteSpan(data));
+        bytes = SegopBytes{std::move(data)};
+    }
+};
+
+} // namespace
+
+bool IsPayloadStripped(const CTransaction& tx)
+{
+    if (!tx.segop_payload.IsNull()) return false;
+    return std::any_of(tx.vout.begin(), tx.vout.end(), [](const CTxOut& txout) {
+        return SegopIsP2SOPScript(txout.scriptPubKey);
+    });
+}
+
+std::optional<uint256> GetPayloadCommitment(const CTransaction& tx)
+{
+    for (const CTxOut& txout : tx.vout) {
+        if (const auto commitment{SegopGetCommitment(txout.scriptPubKey)}) return commitment;
+    }
+    return std::nullopt;
+}
+
+std::vector<std::pair<Txid, uint256>> GetStrippedPayloads(const CBlock& block)
+{
+    std::vector<std::pair<Txid, uint256>> stripped;
+    for (const auto& tx : block.vtx) {
+        if (!IsPayloadStripped(*tx)) continue;
+        if (const auto commitment{GetPayloadCommitment(*tx)}) {
+            stripped.emplace_back(tx->GetHash(), *commitment);
+        }
+    }
+    return stripped;
+}
+
+PayloadStore::PayloadStore(const fs::path& blocks_dir, DBParams db_params, const Obfuscation& obfuscation, bool fast_prune,
+                           CompressionOptions compression)
+    : m_file_seq{blocks_dir, "sop", fast_prune ? 0x4000 /* 16kB */ : SOPFILE_CHUNK_SIZE},
+      m_max_file_size{fast_prune ? 0x10000 /* 64kiB */ : MAX_SOPFILE_SIZE},
+      m_obfuscation{obfuscation},
+      m_compression{std::move(compression)},
+      m_db{std::make_unique<CDBWrapper>(std::move(db_params))}
+{
+    LOCK(m_mutex);
+    m_db->Read(DB_LAST_FILE, m_last_file);
+    m_db->Read(DB_PRUNE_HEIGHT, m_prune_height);
+    m_db->Read(DB_FIRST_HEIGHT, m_first_height);
+    m_file_info.resize(m_last_file + 1);
+    m_file_dead.resize(m_last_file + 1);
+    for (int n = 0; n <= m_last_file; ++n) {
+        m_db->Read(std::make_pair(DB_FILE_INFO, n), m_file_info[n]);
+        m_db->Read(std::make_pair(DB_FILE_DEAD, n), m_file_dead[n]);
+    }
+    RecoverCompaction();
+    LogInfo("Opened segOP payload store: last file %05u, retaining payloads from height %d", m_last_file, m_prune_height);
+}
+
+PayloadStore::~PayloadStore() = default;
+
+bool PayloadStore::FlushFile(int file, bool finalize) const
+{
+    const FlatFilePos pos{file, m_file_info[file].size};
+    if (!m_file_seq.Flush(pos, finalize)) {
+        LogError("Failed to flush segOP payload file %05u", file);
+        return false;
+    }
+    return true;
+}
+
+bool PayloadStore::WritePending(DataStream& pending, FlatFilePos& pending_pos)
+{
+    if (pending.empty()) return true;
+    bool out_of_space;
+    m_file_seq.Allocate(pending_pos, pending.size(), out_of_space);
+    if (out_of_space) {
+        LogError("Out of disk space while writing segOP payloads");
+        return false;
+    }
+    AutoFile file{m_file_seq.Open(pending_pos), m_obfuscation};
+    if (file.IsNull()) {
+        LogError("Failed to open segOP payload file %s", pending_pos.ToString());
+        return false;
+    }
+    file.write({pending.data(), pending.size()});
+    if (file.fclose() != 0) {
+        LogError("Failed to close segOP payload file %s: %s", pending_pos.ToString(), SysErrorString(errno));
+        return false;
+    }
+    pending_pos.nPos += pending.size();
+    pending.clear();
+    return true;
+}
+
+bool PayloadStore::AppendRecord(CDBBatch& batch, DataStream& pending, FlatFilePos& pending_pos, std::set<int>& dirty_files,
+                                std::map<uint256, SopContentPos>& written_content,
+                                const Txid& txid, const CSegopPayload& payload, const uint256& commitment, int height)
+{
+    std::optional<SopContentPos> content;
+    if (const auto it{written_content.find(commitment)}; it != written_content.end()) {
+        content = it->second;
+    } else if (SopContentPos stored; m_db->Read(std::make_pair(DB_CONTENT, commitment), stored)) {
+        content = stored;
+    }
+    SopPayloadPos prev;
+    const bool has_record{m_db->Read(std::make_pair(DB_PAYLOAD, txid.ToUint256()), prev)};
+
+    // The same bytes already stored in the file being appended to are shared
+    // rather than written again. Older copies are not: referring back to them
+    // would keep their files from ever being pruned.
+    if (content && content->pos.nFile == m_last_file && content->version == payload.version &&
+        !has_record && !m_db->Exists(std::make_pair(DB_ALIAS, txid.ToUint256()))) {
+        batch.Write(std::make_pair(DB_ALIAS, txid.ToUint256()), commitment);
+        batch.Write(DBFilePayloadKey{m_last_file, txid.ToUint256()}, uint8_t{0});
+        m_file_info[m_last_file].AddPayload(height, 0);
+        dirty_files.insert(m_last_file);
+        return true;
+    }
+
+    // The commitment is over the payload as received; only the bytes on
+    // disk are compressed.
+    const SopRecord record{txid, payload, m_compression};
+    const unsigned int record_size{static_cast<unsigned int>(GetSerializeSize(record))};
+    if (m_file_info[m_last_file].size > 0 &&
+        m_file_info[m_last_file].size + record_size > m_max_file_size) {
+        if (!WritePending(pending, pending_pos) || !FlushFile(m_last_file, /*finalize=*/true)) return false;
+        ++m_last_file;
+        m_file_info.resize(m_last_file + 1);
+        m_file_dead.resize(m_last_file + 1);
+        pending_pos = FlatFilePos{m_last_file, 0};
+    }
+
+    // A txid written again (its block reorged out and back in) leaves the
+    // earlier record behind for compaction. That record may differ in size,
+    // e.g. if -segopcompress changed since.
+    if (has_record && prev.pos.nFile <= m_last_file) {
+        if (const auto prev_size{ReadRecordSize(prev.pos)}) {
+            m_file_dead[prev.pos.nFile] += *prev_size;
+            dirty_files.insert(prev.pos.nFile);
+        }
+    }
+
+    const FlatFilePos pos{m_last_file, m_file_info[m_last_file].size};
+    pending << record;
+    m_file_info[m_last_file].AddPayload(height, record_size);
+    dirty_files.insert(m_last_file);
+
+    batch.Write(std::make_pair(DB_PAYLOAD, txid.ToUint256()), SopPayloadPos{pos, height});
+    batch.Write(DBFilePayloadKey{pos.nFile, txid.ToUint256()}, uint8_t{0});
+
+    // The newest copy is the one later duplicates share, and the one aliases
+    // of older copies resolve to once those are pruned.
+    if (!content || content->version == payload.version) {
+        const SopContentPos entry{pos, txid, payload.version};
+        written_content[commitment] = entry;
+        batch.Write(std::make_pair(DB_CONTENT, commitment), entry);
+        batch.Write(DBFilePayloadKey{pos.nFile, commitment, DB_FILE_CONTENT}, uint8_t{0});
+    }
+    return true;
+}
+
+std::optional<uint32_t> PayloadStore::WriteBlockPayloads(const CBlock& block, int height)
+{
+    LOCK(m_mutex);
+
+    CDBBatch batch(*m_db);
+    std::set<int> dirty_files;
+    // Records destined for the same file are buffered and written with a
+    // single open/seek, since a segOP-heavy block can carry thousands of them.
+    DataStream pending;
+    FlatFilePos pending_pos{m_last_file, m_file_info[m_last_file].size};
+    std::map<uint256, SopContentPos> written_content;
+    uint32_t count{0};
+    uint32_t missing{0};
+
+    for (const auto& tx : block.vtx) {
+        if (tx->segop_payload.IsNull()) {
+            if (IsPayloadStripped(*tx)) ++missing;
+            continue;
+        }
+        // Consensus has checked the P2SOP commitment against the payload.
+        const auto commitment{GetPayloadCommitment(*tx)};
+        if (!AppendRecord(batch, pending, pending_pos, dirty_files, written_content, tx->GetHash(), tx->segop_payload,
+                          commitment ? *commitment : SegopCommitment(tx->segop_payload.data), height)) {
+            return std::nullopt;
+        }
+        ++count;
+    }
+
+    const bool first_height_changed{m_first_height < 0 || height < m_first_height};
+    // Payloads up to this height are not all held, as if they had been pruned.
+    const bool prune_height_changed{missing > 0 && height >= m_prune_height};
+    if (count == 0 && !first_height_changed && !prune_height_changed) return missing;
+    if (!WritePending(pending, pending_pos)) return std::nullopt;
+
+    for (const int n : dirty_files) {
+        batch.Write(std::make_pair(DB_FILE_INFO, n), m_file_info[n]);
+        if (m_file_dead[n] > 0) batch.Write(std::make_pair(DB_FILE_DEAD, n), m_file_dead[n]);
+    }
+    batch.Write(DB_LAST_FILE, m_last_file);
+    if (first_height_changed) batch.Write(DB_FIRST_HEIGHT, height);
+    if (prune_height_changed) batch.Write(DB_PRUNE_HEIGHT, height + 1);
+    if (!m_db->WriteBatch(batch)) {
+        LogError("Failed to write segOP payload index for block %s", block.GetHash().ToString());
+        return std::nullopt;
+    }
+    if (first_height_changed) m_first_height = height;
+    if (prune_height_changed) m_prune_height = height + 1;
+    return count + missing;
+}
+
+bool PayloadStore::MarkStrippedBlock(const FlatFilePos& pos, uint32_t count)
+{
+    // Synced: once the block index refers to the block, validation relies on
+    // the marker to tell a block stored without its payloads from an invalid
+    // one. This also syncs the retained range WriteBlockPayloads() recorded
+    // for it, which went to the same log just before.
+    return m_db->Write(std::make_pair(DB_STRIPPED_BLOCK, pos), count, /*fSync=*/true);
+}
+
+bool PayloadStore::IsStrippedBlock(const FlatFilePos& pos) const
+{
+    return m_db->Exists(std::make_pair(DB_STRIPPED_BLOCK, pos));
+}
+
+bool PayloadStore::ReadRecord(const SopPayloadPos& pos, const Txid& txid, CSegopPayload& payload) const
+{
+    AutoFile file{m_file_seq.Open(pos.pos, /*read_only=*/true), m_obfuscation};
+    if (file.IsNull()) {
+        // Expected once the file has been pruned.
+        return false;
+    }
+    try {
+        SopRecord record;
+        file >> record;
+        if (record.txid != txid.ToUint256()) {
+            LogError("segOP payload record at %s belongs to %s, expected %s",
+                     pos.pos.ToString(), record.txid.ToString(), txid.ToString());
+            return false;
+        }
+        auto stored{record.GetPayload()};
+        if (!stored) {
+            LogError("Corrupt compressed segOP payload record at %s", pos.pos.ToString());
+            return false;
+        }
+        payload = std::move(*stored);
+    } catch (const std::exception& e) {
+        LogError("Deserialize or I/O error - %s at %s while reading segOP payload", e.what(), pos.pos.ToString());
+        return false;
+    }
+    return true;
+}
+
+std::optional<CSegopPayload> PayloadStore::ReadPayload(const Txid& txid) const
+{
+    std::shared_lock lock{m_file_swap_mutex};
+    SopPayloadPos pos;
+    if (!m_db->Read(std::make_pair(DB_PAYLOAD, txid.ToUint256()), pos)) {
+        uint256 commitment;
+        if (m_db->Read(std::make_pair(DB_ALIAS, txid.ToUint256()), commitment)) {
+            return ReadContent(commitment);
+        }
+        return std::nullopt;
+    }
+    CSegopPayload payload;
+    if (!ReadRecord(pos, txid, payload)) {
+        return std::nullopt;
+    }
+    return payload;
+}
+
+std::optional<CSegopPayload> PayloadStore::ReadPayloadByCommitment(const uint256& commitment) const
+{
+    std::shared_lock lock{m_file_swap_mutex};
+    return ReadContent(commitment);
+}
+
+std::optional<uint32_t> PayloadStore::ReadRecordSize(const FlatFilePos& pos) const
+{
+    AutoFile file{m_file_seq.Open(pos, /*read_only=*/true), m_obfuscation};
+    if (file.IsNull()) return std::nullopt;
+    try {
+        SopRecord record;
+        file >> record;
+        return static_cast<uint32_t>(GetSerializeSize(record));
+    } catch (const std::exception& e) {
+        LogError("Deserialize or I/O error - %s at %s while reading segOP payload", e.what(), pos.ToString());
+        return std::nullopt;
+    }
+}
+
+std::optional<CSegopPayload> PayloadStore::ReadContent(const uint256& commitment) const
+{
+    SopContentPos content;
+    if (!m_db->Read(std::make_pair(DB_CONTENT, commitment), content)) {
+        return std::nullopt;
+    }
+    CSegopPayload payload;
+    if (!ReadRecord(SopPayloadPos{content.pos, 0}, content.owner, payload)) {
+        return std::nullopt;
+    }
+    return payload;
+}
+
+bool PayloadStore::AttachPayload(CTransactionRef& tx) const
+{
+    if (!IsPayloadStripped(*tx)) return true;
+
+    auto payload{ReadPayload(tx->GetHash())};
+    if (!payload) return false;
+
+    CMutableTransaction mtx{*tx};
+    mtx.segop_payload = std::move(*payload);
+    tx = MakeTransactionRef(std::move(mtx));
+    return true;
+}
+
+bool PayloadStore::AttachPayloads(CBlock& block) const
+{
+    bool complete{true};
+    for (auto& tx : block.vtx) {
+        complete &= AttachPayload(tx);
+    }
+    return complete;
+}
+
+PayloadStore::PruneProgress PayloadStore::PruneStep(int height, int max_records)
+{
+    LOCK(m_mutex);
+    PruneProgress progress;
+    if (height <= m_prune_height) return progress;
+
+    // Never prune the file currently being appended to.
+    for (int n = 0; n < m_last_file; ++n) {
+        SopFileInfo& info{m_file_info[n]};
+        if (info.payloads == 0 || info.height_last >= height) continue;
+        if (progress.records >= max_records) {
+            progress.done = false;
+            break;
+        }
+
+        // Stop claiming these heights before any of their payloads go.
+        if (info.height_last >= m_prune_height) {
+            if (!m_db->Write(DB_PRUNE_HEIGHT, info.height_last + 1, /*fSync=*/true)) {
+                LogError("Failed to update segOP payload index while pruning");
+                progress.done = false;
+                break;
+            }
+            m_prune_height = info.height_last + 1;
+        }
+
+        CDBBatch batch(*m_db);
+        bool file_done{true};
+        std::unique_ptr<CDBIterator> it{m_db->NewIterator()};
+        for (const uint8_t prefix : {DB_FILE_PAYLOAD, DB_FILE_CONTENT}) {
+            for (it->Seek(DBFilePayloadKey{n, uint256{}, prefix}); file_done && it->Valid(); it->Next()) {
+                DBFilePayloadKey key;
+                if (!it->GetKey(key) || key.prefix != prefix || key.file != n) break;
+                // Only payload records count toward the budget; a file's
+                // content entries never outnumber them.
+                if (prefix == DB_FILE_PAYLOAD && progress.records >= max_records) {
+                    file_done = false;
+                    break;
+                }
+                if (prefix == DB_FILE_PAYLOAD) {
+                    // The txid may have been re-written to a newer file after a reorg.
+                    SopPayloadPos pos;
+                    if (m_db->Read(std::make_pair(DB_PAYLOAD, key.hash), pos) && pos.pos.nFile == n) {
+                        batch.Erase(std::make_pair(DB_PAYLOAD, key.hash));
+                    }
+                    // Aliases only ever share a record in the file they are listed in.
+                    batch.Erase(std::make_pair(DB_ALIAS, key.hash));
+                } else {
+                    // A newer copy may have taken over the content entry.
+                    SopContentPos content;
+                    if (m_db->Read(std::make_pair(DB_CONTENT, key.hash), content) && content.pos.nFile == n) {
+                        batch.Erase(std::make_pair(DB_CONTENT, key.hash));
+                    }
+                }
+                batch.Erase(key);
+                if (prefix == DB_FILE_PAYLOAD) ++progress.records;
+            }
+        }
+        if (file_done) {
+            batch.Erase(std::make_pair(DB_FILE_INFO, n));
+            batch.Erase(std::make_pair(DB_FILE_DEAD, n));
+        }
+        if (!m_db->WriteBatch(batch, /*fSync=*/file_done)) {
+            LogError("Failed to update segOP payload index while pruning");
+            progress.done = false;
+            break;
+        }
+        if (!file_done) {
+            progress.done = false;
+            break;
+        }
+
+        info = SopFileInfo{};
+        m_file_dead[n] = 0;
+        std::error_code ec;
+        if (fs::remove(m_file_seq.FileName(FlatFilePos{n, 0}), ec)) {
+            LogDebug(BCLog::PRUNE, "segOP: deleted sop%05u.dat\n", n);
+        }
+        ++progress.files;
+    }
+
+    if (progress.files > 0) {
+        LogInfo("segOP: pruned %u payload file(s), retaining payloads from height %d", progress.files, m_prune_height);
+    }
+    return progress;
+}
+
+int PayloadStore::PruneBelow(int height)
+{
+    return PruneStep(height, std::numeric_limits<int>::max()).files;
+}
+
+fs::path PayloadStore::CompactedFileName(int file) const
+{
+    return m_file_seq.FileName(FlatFilePos{file, 0}) + ".compact";
+}
+
+void PayloadStore::RecoverCompaction()
+{
+    int file;
+    if (m_db->Read(DB_COMPACTING, file)) {
+        // The index was already moved over to the compacted copy.
+        const fs::path compacted{CompactedFileName(file)};
+        if (fs::exists(compacted) && !RenameOver(compacted, m_file_seq.FileName(FlatFilePos{file, 0}))) {
+            LogError("Failed to finish compacting sop%05u.dat", file);
+            return;
+        }
+        if (!m_db->Erase(DB_COMPACTING, /*fSync=*/true)) return;
+    }
+    // Any other copy was never referenced by the index.
+    std::error_code ec;
+    for (int n = 0; n < m_last_file; ++n) {
+        fs::remove(CompactedFileName(n), ec);
+    }
+}
+
+std::optional<PayloadStore::CompactProgress> PayloadStore::CompactStep(int height, uint64_t max_bytes)
+{
+    LOCK(m_compaction_mutex);
+    if (!m_compaction) {
+        LOCK(m_mutex);
+        for (int n = 0; n < m_last_file; ++n) {
+            const SopFileInfo& info{m_file_info[n]};
+            if (info.payloads == 0 || info.height_last >= height) continue;
+            if (uint64_t{m_file_dead[n]} * 4 >= info.size) {
+                m_compaction = Compaction{.file = n, .size = info.size};
+                break;
+            }
+        }
+        if (!m_compaction) return CompactProgress{};
+    }
+    Compaction& compaction{*m_compaction};
+    const int file{compaction.file};
+    const fs::path compacted{CompactedFileName(file)};
+    const auto abandon{[&] {
+        m_compaction.reset();
+        std::error_code ec;
+        fs::remove(compacted, ec);
+    }};
+    if (WITH_LOCK(m_mutex, return m_file_info[file].payloads) == 0) {
+        // Pruned since the previous step.
+        abandon();
+        return CompactProgress{};
+    }
+
+    // Files other than the last one are never appended to, so the copy is
+    // made without holding the lock. Index entries that change meanwhile
+    // are checked again below.
+    {
+        AutoFile in{m_file_seq.Open(FlatFilePos{file, compaction.read_pos}, /*read_only=*/true), m_obfuscation};
+        AutoFile out{fsbridge::fopen(compacted, compaction.read_pos == 0 ? "wb" : "rb+"), m_obfuscation};
+        if (in.IsNull() || out.IsNull()) {
+            LogError("Failed to open sop%05u.dat for compaction", file);
+            if (!out.IsNull()) (void)out.fclose();
+            abandon();
+            return std::nullopt;
+        }
+        try {
+            out.seek(compaction.compacted_size, SEEK_SET);
+            const uint32_t start{compaction.read_pos};
+            while (compaction.read_pos < compaction.size && (compaction.read_pos == start || compaction.read_pos - start < max_bytes)) {
+                const uint32_t pos{compaction.read_pos};
+                SopRecord record;
+                in >> record;
+                const uint32_t record_size{static_cast<uint32_t>(GetSerializeSize(record))};
+                if (SopPayloadPos index_pos; m_db->Read(std::make_pair(DB_PAYLOAD, record.txid), index_pos) && index_pos.pos == FlatFilePos{file, pos}) {
+                    const auto payload{record.GetPayload()};
+                    if (!payload) throw std::ios_base::failure("corrupt compressed record");
+                    out << record;
+                    compaction.moved.push_back({record.txid, SegopCommitment(payload->data), pos, compaction.compacted_size});
+                    compaction.compacted_size += record_size;
+                }
+                compaction.read_pos += record_size;
+            }
+            if (!out.Commit()) throw std::ios_base::failure("failed to commit");
+        } catch (const std::exception& e) {
+            LogError("Error compacting sop%05u.dat: %s", file, e.what());
+            (void)out.fclose();
+            abandon();
+            return std::nullopt;
+        }
+        if (out.fclose() != 0) {
+            LogError("Failed to close %s: %s", fs::PathToString(compacted), SysErrorString(errno));
+            abandon();
+            return std::nullopt;
+        }
+    }
+
+    LOCK(m_mutex);
+    if (m_file_info[file].payloads == 0) {
+        // Pruned meanwhile.
+        abandon();
+        return CompactProgress{};
+    }
+    if (compaction.read_pos < compaction.size) {
+        LogDebug(BCLog::PRUNE, "segOP: compacting sop%05u.dat, copied %u of %u bytes\n", file, compaction.read_pos, compaction.size);
+        return CompactProgress{.done = false};
+    }
+    const auto reclaimed{FinishCompaction(compaction)};
+    m_compaction.reset();
+    if (!reclaimed) return std::nullopt;
+    return CompactProgress{.reclaimed = *reclaimed};
+}
+
+std::optional<uint32_t> PayloadStore::FinishCompaction(const Compaction& compaction)
+{
+    AssertLockHeld(m_mutex);
+    const int file{compaction.file};
+    const std::vector<CompactedRecord>& moved{compaction.moved};
+    CDBBatch batch(*m_db);
+    uint32_t dead{0};
+    for (size_t i = 0; i < moved.size(); ++i) {
+        const CompactedRecord& record{moved[i]};
+        SopPayloadPos index_pos;
+        if (m_db->Read(std::make_pair(DB_PAYLOAD, record.txid), index_pos) && index_pos.pos == FlatFilePos{file, record.from}) {
+            batch.Write(std::make_pair(DB_PAYLOAD, record.txid), SopPayloadPos{FlatFilePos{file, record.to}, index_pos.height});
+            if (SopContentPos content; m_db->Read(std::make_pair(DB_CONTENT, record.commitment), content) && content.pos == FlatFilePos{file, record.from}) {
+                content.pos = FlatFilePos{file, record.to};
+                batch.Write(std::make_pair(DB_CONTENT, record.commitment), content);
+            }
+        } else {
+            // Written again since it was copied.
+            dead += (i + 1 < moved.size() ? moved[i + 1].to : compaction.compacted_size) - record.to;
+        }
+    }
+    m_file_info[file].size = compaction.compacted_size;
+    m_file_dead[file] = dead;
+    batch.Write(std::make_pair(DB_FILE_INFO, file), m_file_info[file]);
+    if (dead > 0) {
+        batch.Write(std::make_pair(DB_FILE_DEAD, file), dead);
+    } else {
+        batch.Erase(std::make_pair(DB_FILE_DEAD, file));
+    }
+    batch.Write(DB_COMPACTING, file);
+    {
+        // Between the index update and the rename, records would be looked
+        // up at their new offsets in the old file; readers wait instead.
+        std::unique_lock lock{m_file_swap_mutex};
+        if (!m_db->WriteBatch(batch, /*fSync=*/true)) {
+            LogError("Failed to update segOP payload index while compacting");
+            return std::nullopt;
+        }
+        RecoverCompaction();
+    }
+    LogDebug(BCLog::PRUNE, "segOP: compacted sop%05u.dat from %u to %u bytes\n", file, compaction.size, compaction.compacted_size);
+    return compaction.size - compaction.compacted_size;
+}
+
+int PayloadStore::MinRetainedHeight() const
+{
+    LOCK(m_mutex);
+    if (m_first_height < 0) return std::numeric_limits<int>::max();
+    return std::max(m_first_height, m_prune_height);
+}
+
+bool PayloadStore::HavePruned() const
+{
+    LOCK(m_mutex);
+    return m_prune_height > 0;
+}
+
+uint64_t PayloadStore::CalculateCurrentUsage() const
+{
+    LOCK(m_mutex);
+    uint64_t usage{0};
+    for (const SopFileInfo& info : m_file_info) {
+        usage += info.size;
+    }
+    return usage;
+}
+
+bool PayloadStore::Flush(bool finalize)
+{
+    LOCK(m_mutex);
+    if (!FlushFile(m_last_file, finalize)) return false;
+    return m_db->Write(DB_LAST_FILE, m_last_file, /*fSync=*/true);
+}
+
+} // namespace segop
@@ -0,0 +1,338 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SEGOP_SEGOP_STORE_H
+#define BITCOIN_SEGOP_SEGOP_STORE_H
+
+#include <dbwrapper.h>
+#include <flatfile.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <segop/segop_compress.h>
+#include <serialize.h>
+#include <streams.h>
+#include <sync.h>
+#include <util/fs.h>
+#include <util/obfuscation.h>
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+namespace segop {
+
+/** The pre-allocation chunk size for sop?????.dat files */
+static constexpr unsigned int SOPFILE_CHUNK_SIZE{0x100000}; // 1 MiB
+/** The maximum size of a sop?????.dat file */
+static constexpr unsigned int MAX_SOPFILE_SIZE{0x8000000}; // 128 MiB
+
+/**
+ * Per-file statistics for sop?????.dat, the segOP counterpart of
+ * CBlockFileInfo. The height range is what retention pruning works on:
+ * a file can only be deleted once every payload in it is older than E.
+ */
+struct SopFileInfo {
+    uint32_t size{0};         //!< number of used bytes in the file
+    uint32_t payloads{0};     //!< number of payload records stored in the file
+    int height_first{std::numeric_limits<int>::max()}; //!< lowest block height in the file
+    int height_last{0};       //!< highest block height in the file
+
+    SERIALIZE_METHODS(SopFileInfo, obj)
+    {
+        READWRITE(VARINT(obj.size), VARINT(obj.payloads),
+                  VARINT_MODE(obj.height_first, VarIntMode::NONNEGATIVE_SIGNED),
+                  VARINT_MODE(obj.height_last, VarIntMode::NONNEGATIVE_SIGNED));
+    }
+
+    void AddPayload(int height, unsigned int bytes)
+    {
+        payloads++;
+        size += bytes;
+        height_first = std::min(height_first, height);
+        height_last = std::max(height_last, height);
+    }
+};
+
+/** Location of one stored payload record, indexed by txid. */
+struct SopPayloadPos {
+    FlatFilePos pos;
+    int height{0};
+
+    SERIALIZE_METHODS(SopPayloadPos, obj)
+    {
+        READWRITE(obj.pos, VARINT_MODE(obj.height, VarIntMode::NONNEGATIVE_SIGNED));
+    }
+};
+
+/**
+ * Where the bytes committed to by one P2SOP commitment are stored: the
+ * newest record of that payload, which later duplicates written to the same
+ * file share instead of being stored again.
+ */
+struct SopContentPos {
+    FlatFilePos pos;
+    Txid owner;          //!< the txid the record was written for
+    uint8_t version{0};  //!< segOP version of the record; duplicates must match it
+
+    SERIALIZE_METHODS(SopContentPos, obj) { READWRITE(obj.pos, obj.owner, obj.version); }
+};
+
+/** The P2SOP commitment of `tx`, if it has a P2SOP output. */
+std::optional<uint256> GetPayloadCommitment(const CTransaction& tx);
+
+/**
+ * True if `tx` commits to a segOP payload through its P2SOP output but the
+ * payload bytes themselves are not attached, i.e. the transaction was read
+ * back from a payload-stripped block record.
+ *
+ * Consensus forbids P2SOP without segOP, so this cannot be confused with a
+ * transaction that was valid as received.
+ */
+bool IsPayloadStripped(const CTransaction& tx);
+
+/**
+ * The txid and P2SOP commitment of every payload-stripped transaction in
+ * `block`, i.e. the payloads that must be fetched (getsegopdata) before the
+ * block can be validated.
+ */
+std::vector<std::pair<Txid, uint256>> GetStrippedPayloads(const CBlock& block);
+
+/**
+ * segOP lane store.
+ *
+ * Keeps segOP payload bytes out of blk?????.dat so that retention pruning
+ * (spec §10.4) can reclaim disk space without touching block data:
+ *
+ *  - blocks/sop?????.dat : append-only records of [txid][CSegopPayload],
+ *                          the payload optionally LZ-compressed (see
+ *                          CompressionOptions)
+ *  - blocks/segop/       : LevelDB index
+ *
+ * Blocks are written to blk?????.dat with the segOP section omitted
+ * (TX_WITH_WITNESS_NO_SEGOP) and re-hydrated from this store on read.
+ * Whole sop files are deleted once all of their payloads fall outside the
+ * effective retention window E; the txids, P2SOP outputs and commitments
+ * stay in the block files, so later reads simply come back stripped.
+ * Payloads are also content-addressed by their P2SOP commitment: a payload
+ * whose bytes are already in the file being appended to (repeated metadata,
+ * a rebroadcast under another txid) is recorded as an alias of that record
+ * instead of being written again. Dedup is limited to that file on purpose:
+ * a payload whose only copy is in an older file is written once more, as
+ * an alias into that file would keep it from ever being pruned.
+ * Files that have left the archive window A but not yet E are compacted:
+ * rewritten without the records that were superseded by a later write of
+ * the same txid. Both are done a bounded step at a time (PruneStep(),
+ * CompactStep()) so that a backlog never stalls block writes. Readers never
+ * see a payload go missing while a compacted file replaces the original.
+ *
+ * Index layout:
+ *   [DB_PAYLOAD, txid]                -> SopPayloadPos
+ *   [DB_ALIAS, txid]                  -> commitment   txid sharing another txid's record
+ *   [DB_CONTENT, commitment]          -> SopContentPos
+ *   [DB_FILE_PAYLOAD, file (BE), txid] -> (empty)  per-file listing used to prune
+ *   [DB_FILE_CONTENT, file (BE), commitment] -> (empty)  likewise, for content entries
+ *   [DB_FILE_INFO, file]              -> SopFileInfo
+ *   [DB_FILE_DEAD, file]              -> bytes of superseded records in that file
+ *   [DB_STRIPPED_BLOCK, FlatFilePos]  -> number of payloads stripped from that blk record
+ *   DB_LAST_FILE                      -> current write file
+ *   DB_PRUNE_HEIGHT                   -> lowest height whose payloads are still retained
+ *   DB_FIRST_HEIGHT                   -> lowest block height written through the store
+ *   DB_COMPACTING                     -> file whose compacted copy awaits its rename
+ */
+class PayloadStore
+{
+private:
+    const FlatFileSeq m_file_seq;
+    const unsigned int m_max_file_size;
+    const Obfuscation m_obfuscation;
+    //! Which newly written payloads are stored compressed. Records of
+    //! either form are always readable.
+    const CompressionOptions m_compression;
+    std::unique_ptr<CDBWrapper> m_db;
+
+    mutable Mutex m_mutex;
+    std::vector<SopFileInfo> m_file_info GUARDED_BY(m_mutex);
+    //! Bytes of superseded records per file, parallel to m_file_info.
+    std::vector<uint32_t> m_file_dead GUARDED_BY(m_mutex);
+    int m_last_file GUARDED_BY(m_mutex){0};
+    //! Everything below this height may have been pruned (0: nothing pruned yet).
+    int m_prune_height GUARDED_BY(m_mutex){0};
+    //! Lowest block height ever written through the store (-1: none yet).
+    //! Blocks below it were stored before the store existed and keep their
+    //! payloads inline in blk?????.dat.
+    int m_first_height GUARDED_BY(m_mutex){-1};
+
+    //! Held shared by readers from looking a record up in the index until it
+    //! has been read, and exclusively while compaction moves index entries
+    //! over to a compacted file and renames that file into place.
+    mutable std::shared_mutex m_file_swap_mutex;
+
+    /** A record copied to the compacted file, from and to its offset. */
+    struct CompactedRecord {
+        uint256 txid;
+        uint256 commitment;
+        uint32_t from;
+        uint32_t to;
+    };
+    /** A compaction in progress, carried over between CompactStep() calls. */
+    struct Compaction {
+        int file;
+        uint32_t size;                //!< size of the file being compacted
+        uint32_t read_pos{0};         //!< offset of the next record to copy
+        uint32_t compacted_size{0};   //!< bytes written to the compacted copy so far
+        std::vector<CompactedRecord> moved{};
+    };
+    Mutex m_compaction_mutex;
+    std::optional<Compaction> m_compaction GUARDED_BY(m_compaction_mutex);
+
+    bool FlushFile(int file, bool finalize) const EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    /** Append one record to the write buffer, rolling over to a new file if needed. */
+    bool AppendRecord(CDBBatch& batch, DataStream& pending, FlatFilePos& pending_pos, std::set<int>& dirty_files,
+                      std::map<uint256, SopContentPos>& written_content,
+                      const Txid& txid, const CSegopPayload& payload, const uint256& commitment, int height) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    bool WritePending(DataStream& pending, FlatFilePos& pending_pos) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    bool ReadRecord(const SopPayloadPos& pos, const Txid& txid, CSegopPayload& payload) const;
+    /** Size on disk of the record at `pos`, or std::nullopt if it can't be read. */
+    std::optional<uint32_t> ReadRecordSize(const FlatFilePos& pos) const;
+    /** ReadPayloadByCommitment(), with m_file_swap_mutex held. */
+    std::optional<CSegopPayload> ReadContent(const uint256& commitment) const;
+    /** Point the index at the compacted copy of `compaction.file` and rename it into place. */
+    std::optional<uint32_t> FinishCompaction(const Compaction& compaction) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    /** Path of the compacted copy of sop file `file` while it is being written. */
+    fs::path CompactedFileName(int file) const;
+    /** Finish or discard a compaction that was interrupted by a crash. */
+    void RecoverCompaction() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+public:
+    /**
+     * @param[in] blocks_dir   directory holding blk?????.dat; sop files live beside them
+     * @param[in] db_params    parameters for the blocks/segop/ index
+     * @param[in] obfuscation  the blocksdir XOR key, applied to sop files as well
+     * @param[in] fast_prune   use small sop files, as with -fastprune (test only)
+     * @param[in] compression  which payloads to store compressed (-segopcompress)
+     */
+    PayloadStore(const fs::path& blocks_dir, DBParams db_params, const Obfuscation& obfuscation, bool fast_prune = false,
+                 CompressionOptions compression = {});
+    ~PayloadStore();
+
+    PayloadStore(const PayloadStore&) = delete;
+    PayloadStore& operator=(const PayloadStore&) = delete;
+
+    /**
+     * Append the payloads of every segOP transaction in `block` to the lane
+     * store and index them by txid.
+     *
+     * A block that arrived with payloads already stripped (-segoplightibd)
+     * has nothing to store for those; the store then no longer claims to
+     * hold every payload up to `height` (see MinRetainedHeight()).
+     *
+     * @returns the number of payloads kept out of the block record (written
+     *          here or missing to begin with), or std::nullopt on I/O error
+     */
+    std::optional<uint32_t> WriteBlockPayloads(const CBlock& block, int height);
+
+    /**
+     * Record that the blk record at `pos` was written with `count` payloads
+     * stripped. The record is synced to disk before this returns, i.e. before
+     * the block file is flushed and the block index entry written.
+     */
+    bool MarkStrippedBlock(const FlatFilePos& pos, uint32_t count);
+    /** True if the blk record at `pos` was written with payloads stripped. */
+    bool IsStrippedBlock(const FlatFilePos& pos) const;
+
+    /** Read the payload stored for `txid`. Returns std::nullopt if unknown or pruned. */
+    std::optional<CSegopPayload> ReadPayload(const Txid& txid) const;
+
+    /**
+     * Read a stored payload by its P2SOP commitment, whichever transaction it
+     * was stored for. Returns std::nullopt if no such payload is held.
+     */
+    std::optional<CSegopPayload> ReadPayloadByCommitment(const uint256& commitment) const;
+
+    /**
+     * Re-attach the stored payload to a transaction read from a stripped
+     * record. Returns false if the transaction is stripped and its payload
+     * is no longer available.
+     */
+    bool AttachPayload(CTransactionRef& tx) const;
+
+    /**
+     * Re-attach all stored payloads to a block read from a stripped record.
+     * Returns false if at least one payload is no longer available.
+     */
+    bool AttachPayloads(CBlock& block) const;
+
+    /** Work done by one PruneStep() call. */
+    struct PruneProgress {
+        int records{0}; //!< payload index entries erased
+        int files{0};   //!< sop files deleted
+        bool done{true}; //!< false if payloads below the target height remain
+    };
+
+    /**
+     * Delete the payloads of sop files that lie wholly below `height` (the
+     * first height that must be retained, tip - E + 1), erasing at most
+     * `max_records` index entries. A file is deleted once its last entry is
+     * gone, so a large file is pruned over several calls.
+     *
+     * The durable pruning height (see MinRetainedHeight()) is raised before
+     * the first payload of a file becomes unavailable, and is what a restart
+     * resumes from.
+     */
+    PruneProgress PruneStep(int height, int max_records);
+
+    /**
+     * Delete every sop file whose payloads all lie below `height`.
+     *
+     * @returns the number of files removed
+     */
+    int PruneBelow(int height);
+
+    /** Work done by one CompactStep() call. */
+    struct CompactProgress {
+        uint32_t reclaimed{0}; //!< bytes freed by a compaction that completed
+        bool done{true};       //!< false if a file is only partly copied
+    };
+
+    /**
+     * Rewrite the oldest sop file that lies wholly below `height` (the first
+     * height in the archive window, tip - A + 1) and of which at least a
+     * quarter is superseded records, keeping only the live records. The
+     * file keeps its number and height range.
+     *
+     * At most `max_bytes` of the file are copied per call (but at least one
+     * record); a larger file is compacted over several calls, the first of
+     * which picks it. Progress is not durable: after a restart the file is
+     * copied again from the start.
+     *
+     * @returns the work done, or std::nullopt on I/O error
+     */
+    std::optional<CompactProgress> CompactStep(int height, uint64_t max_bytes = std::numeric_limits<uint64_t>::max());
+
+    /**
+     * Lowest block height from which on the store holds every payload
+     * (spec §11.2 min_retained_height): the first height written through the
+     * store, raised by pruning. INT_MAX until a block has been written.
+     */
+    int MinRetainedHeight() const;
+
+    /** Whether any payload has ever been pruned from the store. */
+    bool HavePruned() const;
+
+    /** Total bytes currently held in sop files. */
+    uint64_t CalculateCurrentUsage() const;
+
+    /** Commit the current sop file and the index to disk. */
+    bool Flush(bool finalize = false);
+};
+
+} // namespace segop
+
+#endif // BITCOIN_SEGOP_SEGOP_STORE_H
@@ -6,8 +6,11 @@
 #include <chainparams.h>
 #include <consensus/merkle.h>
 #include <pow.h>
+#include <segop/segop.h>
+#include <segop/segop_store.h>
 #include <streams.h>
 #include <test/util/random.h>
+#include <test/util/transaction_utils.h>
 #include <test/util/txmempool.h>
 
 #include <test/util/setup_common.h>
@@ -354,6 +357,73 @@ BOOST_AUTO_TEST_CASE(ReceiveWithExtraTransactions) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(SegopPrefilledRTTest)
+{
+    CTxMemPool& pool = *Assert(m_node.mempool);
+    TestMemPoolEntryHelper entry;
+    auto rand_ctx(FastRandomContext(uint256{42}));
+    CBlock block(BuildBlockTestCase(rand_ctx));
+
+    // Give tx 1 a large segOP payload.
+    CMutableTransaction mtx{*block.vtx[1]};
+    AddSegopPayload(mtx, BuildSegopTextTlv(std::string(10000, 'x')));
+    block.vtx[1] = MakeTransactionRef(std::move(mtx));
+    bool mutated;
+    block.hashMerkleRoot = BlockMerkleRoot(block, &mutated);
+    const uint256 commitment{SegopCommitment(block.vtx[1]->segop_payload.data)};
+
+    TestHeaderAndShortIDs shortIDs(block, rand_ctx);
+    shortIDs.prefilledtxn.resize(2);
+    shortIDs.prefilledtxn[0] = {0, block.vtx[0]};
+    shortIDs.prefilledtxn[1] = {0, block.vtx[1]};
+    shortIDs.shorttxids.resize(1);
+    shortIDs.shorttxids[0] = shortIDs.GetShortID(block.vtx[2]->GetWitnessHash());
+
+    // By default prefilled transactions keep their payload on the wire.
+    DataStream stream{};
+    stream << shortIDs;
+    BOOST_CHECK_GT(stream.size(), 10000U);
+
+    // Peers that can fetch segOP payloads are sent them stripped.
+    CMutableTransaction stripped_tx{*block.vtx[1]};
+    stripped_tx.segop_payload.SetNull();
+    shortIDs.prefilledtxn[1] = {0, MakeTransactionRef(std::move(stripped_tx))};
+    stream.clear();
+    stream << shortIDs;
+    BOOST_CHECK_LT(stream.size(), 1000U);
+    CBlockHeaderAndShortTxIDs shortIDs2;
+    stream >> shortIDs2;
+
+    LOCK2(cs_main, pool.cs);
+    AddToMempool(pool, entry.FromTx(block.vtx[2]));
+
+    // Not in the mempool: the block is filled with tx 1 stripped, to be
+    // completed through getsegopdata.
+    {
+        PartiallyDownloadedBlock partialBlock(&pool);
+        BOOST_CHECK(partialBlock.InitData(shortIDs2, empty_extra_txn) == READ_STATUS_OK);
+        CBlock block2;
+        BOOST_CHECK(partialBlock.FillBlock(block2, {}, /*segwit_active=*/true) == READ_STATUS_OK);
+        BOOST_CHECK_EQUAL(block.GetHash().ToString(), block2.GetHash().ToString());
+        BOOST_CHECK(segop::IsPayloadStripped(*block2.vtx[1]));
+        const auto stripped{segop::GetStrippedPayloads(block2)};
+        BOOST_REQUIRE_EQUAL(stripped.size(), 1U);
+        BOOST_CHECK_EQUAL(stripped[0].first, block.vtx[1]->GetHash());
+        BOOST_CHECK_EQUAL(stripped[0].second, commitment);
+    }
+
+    // In the mempool: the full transaction is taken from there.
+    AddToMempool(pool, entry.FromTx(block.vtx[1]));
+    {
+        PartiallyDownloadedBlock partialBlock(&pool);
+        BOOST_CHECK(partialBlock.InitData(shortIDs2, empty_extra_txn) == READ_STATUS_OK);
+        CBlock block2;
+        BOOST_CHECK(partialBlock.FillBlock(block2, {}, /*segwit_active=*/true) == READ_STATUS_OK);
+        BOOST_CHECK(segop::GetStrippedPayloads(block2).empty());
+        BOOST_CHECK(block2.vtx[1]->segop_payload.data == block.vtx[1]->segop_payload.data);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = m_rng.rand256();
@@ -5,11 +5,14 @@
 #include <chain.h>
 #include <chainparams.h>
 #include <clientversion.h>
+#include <common/args.h>
+#include <node/blockmanager_args.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <node/kernel_notifications.h>
 #include <script/solver.h>
 #include <primitives/block.h>
+#include <segop/segop.h>
 #include <util/chaintype.h>
 #include <validation.h>
 
@@ -222,4 +225,42 @@ BOOST_AUTO_TEST_CASE(blockmanager_flush_block_file)
     BOOST_CHECK_EQUAL(read_block.nVersion, 2);
 }
 
+BOOST_AUTO_TEST_CASE(blockmanager_segop_compress_args)
+{
+    const auto params{CreateChainParams(ArgsManager{}, ChainType::REGTEST)};
+    KernelNotifications notifications{Assert(m_node.shutdown_request), m_node.exit_status, *Assert(m_node.warnings)};
+    std::set<uint8_t> tlv_types;
+    const auto apply{[&](std::vector<const char*> argv) {
+        ArgsManager args;
+        for (const char* name : {"-segopcompress", "-segopprune", "-segoplightibd"}) {
+            args.AddArg(name, "", ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+        }
+        argv.insert(argv.begin(), "ignored");
+        std::string error;
+        BOOST_REQUIRE(args.ParseParameters(argv.size(), argv.data(), error));
+        BlockManager::Options opts{
+            .chainparams = *params,
+            .blocks_dir = m_args.GetBlocksDirPath(),
+            .notifications = notifications,
+            .block_tree_db_params = DBParams{.path = m_args.GetDataDirNet() / "blocks" / "index", .cache_bytes = 0},
+        };
+        const auto result{node::ApplyArgsManOptions(args, opts)};
+        tlv_types = opts.segop_compression.tlv_types;
+        return bool{result};
+    }};
+
+    // "0" disables compression rather than naming TLV type 0, and needs no store.
+    BOOST_CHECK(apply({"-segopcompress=0"}));
+    BOOST_CHECK(tlv_types.empty());
+    BOOST_CHECK(apply({"-segopprune", "-segopcompress=text", "-segopcompress=7"}));
+    BOOST_CHECK(tlv_types == std::set<uint8_t>({SegopTlvType::TEXT_UTF8, 7}));
+    BOOST_CHECK(apply({"-segoplightibd", "-segopcompress"}));
+    BOOST_CHECK(tlv_types == std::set<uint8_t>({SegopTlvType::TEXT_UTF8, SegopTlvType::JSON_UTF8}));
+
+    // Without a payload store there is nothing to compress.
+    BOOST_CHECK(!apply({"-segopcompress=text"}));
+    BOOST_CHECK(!apply({"-segopprune", "-segopcompress=bogus"}));
+    BOOST_CHECK(!apply({"-segopprune", "-segopcompress=256"}));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1086,6 +1086,43 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha256_write_multi)
+{
+    for (auto impl : {sha256_implementation::STANDARD, sha256_implementation::USE_SSE4_AND_AVX2, sha256_implementation::USE_SSE4_AND_SHANI}) {
+        SHA256AutoDetect(impl);
+        for (int iter = 0; iter < 20; ++iter) {
+            // Messages of mixed lengths, each after a random prefix, so lanes
+            // start mid-block and finish at different times.
+            const size_t count{m_rng.randrange<size_t>(12)};
+            std::vector<CSHA256> multi(count), serial(count);
+            std::vector<std::vector<unsigned char>> messages(count);
+            for (size_t i = 0; i < count; ++i) {
+                const auto prefix{m_rng.randbytes(m_rng.randrange(100))};
+                multi[i].Write(prefix.data(), prefix.size());
+                serial[i].Write(prefix.data(), prefix.size());
+                messages[i] = m_rng.randbytes(m_rng.randrange(2000));
+            }
+            std::vector<CSHA256*> hashers;
+            std::vector<const unsigned char*> data;
+            std::vector<size_t> lengths;
+            for (size_t i = 0; i < count; ++i) {
+                hashers.push_back(&multi[i]);
+                data.push_back(messages[i].data());
+                lengths.push_back(messages[i].size());
+                serial[i].Write(messages[i].data(), messages[i].size());
+            }
+            SHA256WriteMulti(hashers.data(), data.data(), lengths.data(), count);
+            for (size_t i = 0; i < count; ++i) {
+                unsigned char out1[CSHA256::OUTPUT_SIZE], out2[CSHA256::OUTPUT_SIZE];
+                multi[i].Write(messages[i].data(), 3).Finalize(out1);
+                serial[i].Write(messages[i].data(), 3).Finalize(out2);
+                BOOST_CHECK(memcmp(out1, out2, sizeof(out1)) == 0);
+            }
+        }
+    }
+    SHA256AutoDetect();
+}
+
 void CryptoTest::TestSHA3_256(const std::string& input, const std::string& output)
 {
     const auto in_bytes = ParseHex(input);
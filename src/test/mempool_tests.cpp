@@ -4,6 +4,8 @@
 
 #include <common/system.h>
 #include <policy/policy.h>
+#include <segop/segop.h>
+#include <test/util/transaction_utils.h>
 #include <test/util/txmempool.h>
 #include <txmempool.h>
 #include <util/time.h>
@@ -583,6 +585,71 @@ BOOST_AUTO_TEST_CASE(MempoolSizeLimitTest)
     // ... unless it has gone all the way to 0 (after getting past DEFAULT_INCREMENTAL_RELAY_FEE/2)
 }
 
+BOOST_AUTO_TEST_CASE(MempoolSegopLaneLimitTest)
+{
+    const auto make_segop_tx{[](int n, size_t payload_size) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].scriptSig = CScript() << n;
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = CScript() << OP_1 << OP_EQUAL;
+        tx.vout[0].nValue = 10 * COIN;
+        if (payload_size > 0) AddSegopPayload(tx, BuildSegopTextTlv(std::string(payload_size, 'x')));
+        return tx;
+    }};
+    const CMutableTransaction tx1{make_segop_tx(1, 1000)};
+    const CMutableTransaction tx2{make_segop_tx(2, 1000)};
+    const CMutableTransaction tx3{make_segop_tx(3, 0)};
+    const CMutableTransaction tx4{make_segop_tx(4, 1000)};
+    const uint64_t payload_size{tx1.segop_payload.data.size()};
+
+    // Room for two payloads in the segOP lane.
+    CTxMemPool::Options opts{MemPoolOptionsForTest(m_node)};
+    opts.max_segop_size_bytes = 2 * payload_size + 10;
+    bilingual_str error;
+    CTxMemPool segop_pool{opts, error};
+    BOOST_REQUIRE(error.empty());
+    auto& pool = static_cast<MemPoolTest&>(segop_pool);
+    LOCK2(cs_main, pool.cs);
+    TestMemPoolEntryHelper entry;
+
+    AddToMempool(pool, entry.Fee(5000LL).FromTx(tx1));
+    AddToMempool(pool, entry.Fee(1000LL).FromTx(tx2));
+    AddToMempool(pool, entry.Fee(100LL).FromTx(tx3));
+    BOOST_CHECK_EQUAL(pool.GetTotalSegopSize(), 2 * payload_size);
+    BOOST_CHECK_EQUAL(pool.GetSegopMinFee(10).GetFeePerK(), 0);
+
+    // A third payload must outbid the lowest-feerate one, regardless of tx3's lower feerate.
+    const CFeeRate lowest_segop_fee(1000, GetVirtualTransactionSize(CTransaction(tx2)));
+    BOOST_CHECK_EQUAL(pool.GetSegopMinFee(payload_size).GetFeePerK(), lowest_segop_fee.GetFeePerK() + DEFAULT_INCREMENTAL_RELAY_FEE);
+
+    AddToMempool(pool, entry.Fee(3000LL).FromTx(tx4));
+    pool.TrimToSize(pool.DynamicMemoryUsage());
+    BOOST_CHECK(pool.exists(tx1.GetHash()));
+    BOOST_CHECK(!pool.exists(tx2.GetHash()));
+    BOOST_CHECK(pool.exists(tx3.GetHash()));
+    BOOST_CHECK(pool.exists(tx4.GetHash()));
+    BOOST_CHECK_EQUAL(pool.GetTotalSegopSize(), 2 * payload_size);
+    // Lane evictions leave the rolling minimum fee of other transactions alone.
+    BOOST_CHECK_EQUAL(pool.GetMinFee(1).GetFeePerK(), 0);
+
+    // The overall limit still applies to all transactions.
+    pool.TrimToSize(pool.DynamicMemoryUsage() - 1);
+    BOOST_CHECK(!pool.exists(tx3.GetHash()));
+    BOOST_CHECK(pool.exists(tx1.GetHash()));
+
+    // tx1 and tx4 carry the same payload. The pool keeps one buffer for
+    // both, available by its commitment for as long as either is in the pool.
+    BOOST_CHECK(pool.get(tx1.GetHash())->segop_payload.data.data() == pool.get(tx4.GetHash())->segop_payload.data.data());
+    BOOST_CHECK(pool.get(tx4.GetHash())->segop_payload.data.data() != tx4.segop_payload.data.data());
+    const uint256 commitment{SegopCommitment(tx1.segop_payload.data)};
+    BOOST_CHECK(pool.GetSegopPayload(commitment)->data == tx1.segop_payload.data);
+    pool.removeRecursive(CTransaction{tx4}, MemPoolRemovalReason::REPLACED);
+    BOOST_CHECK(pool.GetSegopPayload(commitment));
+    pool.removeRecursive(CTransaction{tx1}, MemPoolRemovalReason::REPLACED);
+    BOOST_CHECK(!pool.GetSegopPayload(commitment));
+}
+
 inline CTransactionRef make_tx(std::vector<CAmount>&& output_values, std::vector<CTransactionRef>&& inputs=std::vector<CTransactionRef>(), std::vector<uint32_t>&& input_indices=std::vector<uint32_t>())
 {
     CMutableTransaction tx = CMutableTransaction();
@@ -3,8 +3,13 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <merkleblock.h>
+#include <script/script.h>
+#include <segop/segop.h>
+#include <streams.h>
 #include <test/util/setup_common.h>
+#include <test/util/transaction_utils.h>
 #include <uint256.h>
+#include <util/string.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -77,4 +82,49 @@ BOOST_AUTO_TEST_CASE(merkleblock_construct_from_txids_not_found)
     BOOST_CHECK_EQUAL(vIndex.size(), 0U);
 }
 
+BOOST_AUTO_TEST_CASE(segop_merkleblock)
+{
+    // A coinbase, three segOP transactions and one without a payload.
+    CBlock block;
+    for (uint32_t i = 0; i < 5; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout = COutPoint{Txid{}, i};
+        mtx.vout.emplace_back(1, CScript() << OP_TRUE);
+        if (i > 0 && i < 4) AddSegopPayload(mtx, BuildSegopTextTlv("payload " + util::ToString(i)));
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+
+    const auto leaves{GetSegopLeaves(block)};
+    BOOST_REQUIRE_EQUAL(leaves.size(), 3U);
+    for (size_t i = 0; i < leaves.size(); ++i) {
+        BOOST_CHECK_EQUAL(leaves[i].first, block.vtx[i + 1]->GetHash());
+        BOOST_CHECK(leaves[i].second == SegopCommitment(block.vtx[i + 1]->segop_payload.data));
+    }
+    const uint256 root{ComputeSegopMerkleRoot(leaves)};
+
+    // Stripping the payloads leaves the tree unchanged.
+    CBlock stripped{block};
+    for (auto& tx : stripped.vtx) {
+        CMutableTransaction mtx{*tx};
+        mtx.segop_payload.SetNull();
+        tx = MakeTransactionRef(std::move(mtx));
+    }
+    BOOST_CHECK(ComputeSegopMerkleRoot(GetSegopLeaves(stripped)) == root);
+
+    DataStream stream;
+    stream << CSegopMerkleBlock{block, {block.vtx[3]->GetHash()}};
+    CSegopMerkleBlock proof;
+    stream >> proof;
+    BOOST_CHECK_EQUAL(proof.header.GetHash(), block.GetHash());
+    BOOST_CHECK_EQUAL(proof.GetNumLeaves(), 3U);
+    BOOST_CHECK(proof.ExtractMatches() == root);
+    BOOST_REQUIRE_EQUAL(proof.matched.size(), 1U);
+    BOOST_CHECK_EQUAL(proof.matched[0].first, block.vtx[3]->GetHash());
+
+    // A proof claiming another commitment for the matched transaction fails.
+    proof.matched[0].second = leaves[0].second;
+    BOOST_CHECK(proof.ExtractMatches().IsNull());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
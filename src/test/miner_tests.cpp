@@ -11,6 +11,7 @@
 #include <interfaces/mining.h>
 #include <node/miner.h>
 #include <policy/policy.h>
+#include <segop/segop.h>
 #include <test/util/random.h>
 #include <test/util/transaction_utils.h>
 #include <test/util/txmempool.h>
@@ -42,6 +43,7 @@ struct MinerTestingSetup : public TestingSetup {
     void TestPackageSelection(const CScript& scriptPubKey, const std::vector<CTransactionRef>& txFirst) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
     void TestBasicMining(const CScript& scriptPubKey, const std::vector<CTransactionRef>& txFirst, int baseheight) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
     void TestPrioritisedMining(const CScript& scriptPubKey, const std::vector<CTransactionRef>& txFirst) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
+    void TestARBDAWeightLimits(const CScript& scriptPubKey, const std::vector<CTransactionRef>& txFirst) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
     bool TestSequenceLocks(const CTransaction& tx, CTxMemPool& tx_mempool) EXCLUSIVE_LOCKS_REQUIRED(::cs_main)
     {
         CCoinsViewMemPool view_mempool{&m_node.chainman->ActiveChainstate().CoinsTip(), tx_mempool};
@@ -666,6 +668,76 @@ void MinerTestingSetup::TestPrioritisedMining(const CScript& scriptPubKey, const
     }
 }
 
+void MinerTestingSetup::TestARBDAWeightLimits(const CScript& scriptPubKey, const std::vector<CTransactionRef>& txFirst)
+{
+    CTxMemPool& tx_mempool{MakeMempool()};
+    LOCK(tx_mempool.cs);
+
+    TestMemPoolEntryHelper entry;
+
+    // Spend txFirst[index] into a transaction carrying `payload`, if any.
+    const auto make_tx{[&](size_t index, const std::vector<unsigned char>& payload, CAmount fee) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        tx.vin[0].prevout.hash = txFirst[index]->GetHash();
+        tx.vin[0].prevout.n = 0;
+        tx.vin[0].scriptSig = CScript() << OP_1;
+        tx.vout.resize(1);
+        tx.vout[0].nValue = 5000000000LL - fee;
+        if (!payload.empty()) AddSegopPayload(tx, payload);
+        return tx;
+    }};
+
+    // Two arbitrary-data (T3) transactions, an L2 anchor (T2) and a plain payment.
+    const CMutableTransaction t3_high{make_tx(0, BuildSegopTextTlv("first"), 50000)};
+    const CMutableTransaction t3_low{make_tx(1, BuildSegopTextTlv("second"), 40000)};
+    const CMutableTransaction t2{make_tx(2, BuildSegopBUDSTextPayload(0x20, 0x01, "anchor"), 10000)};
+    const CMutableTransaction payment{make_tx(3, {}, 1000)};
+    const auto t3_high_entry{entry.Fee(50000).Time(Now<NodeSeconds>()).SpendsCoinbase(true).FromTx(t3_high)};
+    BOOST_CHECK(t3_high_entry.GetARBDATier() == segop::ARBDATier::T3);
+    AddToMempool(tx_mempool, t3_high_entry);
+    AddToMempool(tx_mempool, entry.Fee(40000).FromTx(t3_low));
+    AddToMempool(tx_mempool, entry.Fee(10000).FromTx(t2));
+    AddToMempool(tx_mempool, entry.Fee(1000).FromTx(payment));
+
+    // A plain, high-fee child of the second T3 transaction: its package carries T3 weight.
+    CMutableTransaction child;
+    child.vin.resize(1);
+    child.vin[0].prevout = COutPoint{t3_low.GetHash(), 0};
+    child.vin[0].scriptSig = CScript() << OP_1;
+    child.vout.resize(1);
+    child.vout[0].nValue = t3_low.vout[0].nValue - 100000;
+    AddToMempool(tx_mempool, entry.Fee(100000).SpendsCoinbase(false).FromTx(child));
+
+    BlockAssembler::Options options;
+    options.coinbase_output_script = scriptPubKey;
+    options.test_block_validity = false;
+
+    // Without a limit, everything is included.
+    auto block_template{BlockAssembler{m_node.chainman->ActiveChainstate(), &tx_mempool, options}.CreateNewBlock()};
+    BOOST_CHECK_EQUAL(block_template->block.vtx.size(), 6U);
+
+    // Room for one T3 transaction: the highest-feerate T3 package (the child
+    // and its parent) no longer fits as a whole, so the next one is taken,
+    // and other tiers are unaffected.
+    options.max_arbda_weight[static_cast<size_t>(segop::ARBDATier::T3)] = t3_high_entry.GetTxWeight();
+    block_template = BlockAssembler{m_node.chainman->ActiveChainstate(), &tx_mempool, options}.CreateNewBlock();
+    const CBlock& block{block_template->block};
+    BOOST_REQUIRE_EQUAL(block.vtx.size(), 4U);
+    BOOST_CHECK(block.vtx[1]->GetHash() == t3_high.GetHash());
+    BOOST_CHECK(block.vtx[2]->GetHash() == t2.GetHash());
+    BOOST_CHECK(block.vtx[3]->GetHash() == payment.GetHash());
+
+    // Parsing of -blockmaxarbdaweight values.
+    const auto parsed{node::ParseARBDAMaxWeight("T3:400000")};
+    BOOST_REQUIRE(parsed);
+    BOOST_CHECK(parsed->first == segop::ARBDATier::T3);
+    BOOST_CHECK_EQUAL(parsed->second, 400000U);
+    BOOST_CHECK(!node::ParseARBDAMaxWeight("T4:1"));
+    BOOST_CHECK(!node::ParseARBDAMaxWeight("T3"));
+    BOOST_CHECK(!node::ParseARBDAMaxWeight("T3:-1"));
+}
+
 // NOTE: These tests rely on CreateNewBlock doing its own self-validation!
 BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
 {
@@ -789,6 +861,11 @@ BOOST_AUTO_TEST_CASE(CreateNewBlock_validity)
     SetMockTime(0);
 
     TestPrioritisedMining(scriptPubKey, txFirst);
+
+    m_node.chainman->ActiveChain().Tip()->nHeight--;
+    SetMockTime(0);
+
+    TestARBDAWeightLimits(scriptPubKey, txFirst);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
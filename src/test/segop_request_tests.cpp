@@ -0,0 +1,119 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <segop/segop_request.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+
+#include <chrono>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace segop;
+
+namespace {
+
+Txid MakeTxid(uint8_t n)
+{
+    uint256 hash;
+    hash.data()[0] = n;
+    hash.data()[1] = 1;
+    return Txid::FromUint256(hash);
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(segop_request_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(segop_request_batching)
+{
+    SegopRequestTracker tracker;
+    const std::chrono::microseconds now{1000};
+
+    for (int i = 0; i < 100; ++i) {
+        BOOST_CHECK(tracker.Want(MakeTxid(i), {.height = 10}));
+    }
+    BOOST_CHECK(!tracker.Want(MakeTxid(0), {.height = 10}));
+    BOOST_CHECK_EQUAL(tracker.Size(), 100U);
+
+    // One getsegopdata carries at most MAX_GETSEGOPDATA_SIZE txids, and
+    // nothing more is handed to a peer until its requests are answered.
+    BOOST_CHECK_EQUAL(tracker.GetRequestable(/*peer=*/0, /*is_archive=*/false, now).size(), MAX_GETSEGOPDATA_SIZE);
+    BOOST_CHECK_EQUAL(tracker.CountInFlight(0), MAX_GETSEGOPDATA_SIZE);
+    BOOST_CHECK(tracker.GetRequestable(0, false, now).empty());
+
+    // The remainder goes to the next peer.
+    BOOST_CHECK_EQUAL(tracker.GetRequestable(1, false, now).size(), 100 - MAX_GETSEGOPDATA_SIZE);
+    BOOST_CHECK(tracker.GetRequestable(2, false, now).empty());
+}
+
+BOOST_AUTO_TEST_CASE(segop_request_archive_only)
+{
+    SegopRequestTracker tracker;
+    const std::chrono::microseconds now{1000};
+    const Txid recent{MakeTxid(1)};
+    const Txid old{MakeTxid(2)};
+    BOOST_CHECK(tracker.Want(recent, {.height = 100}));
+    BOOST_CHECK(tracker.Want(old, {.height = 1, .archive_only = true}));
+
+    // A NODE_SOP_RECENT peer is only asked for payloads inside the window.
+    BOOST_CHECK(tracker.GetRequestable(0, /*is_archive=*/false, now) == std::vector<Txid>{recent});
+    BOOST_CHECK(tracker.GetRequestable(1, /*is_archive=*/true, now) == std::vector<Txid>{old});
+}
+
+BOOST_AUTO_TEST_CASE(segop_request_retry)
+{
+    SegopRequestTracker tracker;
+    std::chrono::microseconds now{1000};
+    const Txid txid{MakeTxid(1)};
+    BOOST_CHECK(tracker.Want(txid, {.commitment = uint256::ONE, .height = 5}));
+
+    // Unsolicited responses are not matched.
+    BOOST_CHECK(!tracker.ReceivedResponse(0, txid));
+
+    // notfound from peer 0: the payload moves on to peer 1, never back to 0.
+    BOOST_CHECK_EQUAL(tracker.GetRequestable(0, false, now).size(), 1U);
+    BOOST_CHECK(tracker.GetRequestable(1, false, now).empty());
+    const auto wanted{tracker.ReceivedResponse(0, txid)};
+    BOOST_REQUIRE(wanted);
+    BOOST_CHECK_EQUAL(wanted->commitment, uint256::ONE);
+    BOOST_CHECK_EQUAL(wanted->height, 5);
+    BOOST_CHECK_EQUAL(tracker.CountInFlight(0), 0U);
+    BOOST_CHECK(tracker.GetRequestable(0, false, now).empty());
+    BOOST_CHECK_EQUAL(tracker.GetRequestable(1, false, now).size(), 1U);
+
+    // Peer 1 times out.
+    now += SEGOPDATA_REQUEST_TIMEOUT;
+    BOOST_CHECK_EQUAL(tracker.GetRequestable(2, false, now).size(), 1U);
+    BOOST_CHECK_EQUAL(tracker.CountInFlight(1), 0U);
+
+    // Peer 2 disconnects.
+    tracker.DisconnectedPeer(2);
+    BOOST_CHECK_EQUAL(tracker.CountInFlight(2), 0U);
+    BOOST_CHECK_EQUAL(tracker.GetRequestable(3, false, now).size(), 1U);
+
+    // A valid payload ends tracking.
+    BOOST_CHECK(tracker.ReceivedResponse(3, txid));
+    tracker.ForgetTxid(txid);
+    BOOST_CHECK_EQUAL(tracker.Size(), 0U);
+    BOOST_CHECK(tracker.GetRequestable(4, false, now).empty());
+}
+
+BOOST_AUTO_TEST_CASE(segop_request_give_up)
+{
+    SegopRequestTracker tracker;
+    const std::chrono::microseconds now{1000};
+    const Txid txid{MakeTxid(1)};
+    BOOST_CHECK(tracker.Want(txid, {.height = 5}));
+
+    for (NodeId peer = 0; peer < NodeId(MAX_SEGOP_REQUEST_ATTEMPTS); ++peer) {
+        BOOST_CHECK_EQUAL(tracker.GetRequestable(peer, false, now).size(), 1U);
+        BOOST_CHECK(tracker.ReceivedResponse(peer, txid));
+    }
+    BOOST_CHECK(tracker.GetRequestable(MAX_SEGOP_REQUEST_ATTEMPTS, false, now).empty());
+    BOOST_CHECK_EQUAL(tracker.Size(), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,486 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <common/args.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <segop/segop.h>
+#include <segop/segop_compress.h>
+#include <segop/segop_store.h>
+#include <streams.h>
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+#include <test/util/transaction_utils.h>
+#include <util/string.h>
+
+#include <atomic>
+#include <limits>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace segop;
+
+namespace {
+
+CBlock MakeSegopBlock(uint32_t first, size_t count)
+{
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vout.resize(1);
+    block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+    for (size_t i = 0; i < count; ++i) {
+        // Distinct payloads, so that none is stored as an alias of another.
+        std::string text(2000, 'a' + (i % 26));
+        const std::string n{util::ToString(first + i)};
+        text.replace(0, n.size(), n);
+        block.vtx.push_back(MakeTransactionRef(BuildSegopTransaction(text, first + i)));
+    }
+    return block;
+}
+
+CBlock StripBlock(const CBlock& block)
+{
+    DataStream stream;
+    stream << TX_WITH_WITNESS_NO_SEGOP(block);
+    CBlock stripped;
+    stream >> TX_WITH_WITNESS(stripped);
+    return stripped;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(segop_store_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(segop_store_roundtrip)
+{
+    const fs::path blocks_dir{m_args.GetDataDirBase() / "blocks"};
+    fs::create_directories(blocks_dir);
+    PayloadStore store{blocks_dir, DBParams{.path = blocks_dir / "segop", .cache_bytes = 1 << 20, .memory_only = true}, Obfuscation{}};
+
+    BOOST_CHECK_EQUAL(store.MinRetainedHeight(), std::numeric_limits<int>::max());
+    const CBlock block{MakeSegopBlock(0, 3)};
+    BOOST_CHECK_EQUAL(*store.WriteBlockPayloads(block, /*height=*/1), 3U);
+    BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 1);
+    const FlatFilePos blk_pos{0, 8};
+    BOOST_CHECK(!store.IsStrippedBlock(blk_pos));
+    BOOST_CHECK(store.MarkStrippedBlock(blk_pos, 3));
+    BOOST_CHECK(store.IsStrippedBlock(blk_pos));
+
+    // The stripped record keeps txids and the P2SOP outputs but not the payloads.
+    CBlock stripped{StripBlock(block)};
+    BOOST_CHECK_EQUAL(stripped.vtx.size(), block.vtx.size());
+    BOOST_CHECK(!IsPayloadStripped(*stripped.vtx[0]));
+    for (size_t i = 1; i < block.vtx.size(); ++i) {
+        BOOST_CHECK(IsPayloadStripped(*stripped.vtx[i]));
+        BOOST_CHECK_EQUAL(stripped.vtx[i]->GetHash(), block.vtx[i]->GetHash());
+    }
+
+    BOOST_CHECK(store.AttachPayloads(stripped));
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        BOOST_CHECK(!IsPayloadStripped(*stripped.vtx[i]));
+        BOOST_CHECK_EQUAL(stripped.vtx[i]->GetWitnessHash(), block.vtx[i]->GetWitnessHash());
+        BOOST_CHECK(stripped.vtx[i]->segop_payload.data == block.vtx[i]->segop_payload.data);
+    }
+
+    BOOST_CHECK(!store.ReadPayload(block.vtx[0]->GetHash()));
+    BOOST_CHECK_EQUAL(store.CalculateCurrentUsage(), 3 * (GetSerializeSize(block.vtx[1]->GetHash()) + GetSerializeSize(block.vtx[1]->segop_payload)));
+}
+
+BOOST_AUTO_TEST_CASE(segop_store_light_ibd)
+{
+    const fs::path blocks_dir{m_args.GetDataDirBase() / "blocks"};
+    fs::create_directories(blocks_dir);
+    const DBParams db_params{.path = blocks_dir / "segop", .cache_bytes = 1 << 20};
+    const FlatFilePos blk_pos{0, 8};
+    {
+        PayloadStore store{blocks_dir, db_params, Obfuscation{}};
+
+        // A block downloaded without its payloads is recorded as stripped, but
+        // the store no longer holds everything from its height up.
+        const CBlock buried{StripBlock(MakeSegopBlock(0, 2))};
+        BOOST_CHECK_EQUAL(*store.WriteBlockPayloads(buried, /*height=*/1), 2U);
+        BOOST_CHECK(store.MarkStrippedBlock(blk_pos, 2));
+        BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 2);
+        CBlock read{buried};
+        BOOST_CHECK(!store.AttachPayloads(read));
+
+        const CBlock recent{MakeSegopBlock(2, 2)};
+        BOOST_CHECK_EQUAL(*store.WriteBlockPayloads(recent, /*height=*/2), 2U);
+        BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 2);
+        read = StripBlock(recent);
+        BOOST_CHECK(store.AttachPayloads(read));
+    }
+
+    // Reconnecting the stripped block after a restart relies on both.
+    PayloadStore store{blocks_dir, db_params, Obfuscation{}};
+    BOOST_CHECK(store.IsStrippedBlock(blk_pos));
+    BOOST_CHECK(!store.IsStrippedBlock(FlatFilePos{0, 0}));
+    BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(segop_store_prune)
+{
+    const fs::path blocks_dir{m_args.GetDataDirBase() / "blocks"};
+    fs::create_directories(blocks_dir);
+    PayloadStore store{blocks_dir, DBParams{.path = blocks_dir / "segop", .cache_bytes = 1 << 20, .memory_only = true}, Obfuscation{}, /*fast_prune=*/true};
+
+    // With 64kiB files, 8 blocks of four ~2kB payloads fill one file.
+    std::vector<CBlock> blocks;
+    for (int height = 1; height <= 17; ++height) {
+        blocks.push_back(MakeSegopBlock(height * 4, 4));
+        BOOST_REQUIRE(store.WriteBlockPayloads(blocks.back(), height));
+    }
+    BOOST_CHECK(fs::exists(blocks_dir / "sop00000.dat"));
+    BOOST_CHECK(fs::exists(blocks_dir / "sop00001.dat"));
+    BOOST_CHECK(fs::exists(blocks_dir / "sop00002.dat"));
+    BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 1);
+
+    // Nothing below height 2 can free a whole file.
+    BOOST_CHECK_EQUAL(store.PruneBelow(2), 0);
+    BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 1);
+
+    // Pruning everything must still keep the file being appended to.
+    BOOST_CHECK_EQUAL(store.PruneBelow(18), 2);
+    BOOST_CHECK(!fs::exists(blocks_dir / "sop00000.dat"));
+    BOOST_CHECK(!fs::exists(blocks_dir / "sop00001.dat"));
+    BOOST_CHECK(fs::exists(blocks_dir / "sop00002.dat"));
+    BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 17);
+
+    CBlock oldest{StripBlock(blocks.front())};
+    BOOST_CHECK(!store.AttachPayloads(oldest));
+    BOOST_CHECK(IsPayloadStripped(*oldest.vtx[1]));
+    BOOST_CHECK(!store.ReadPayload(blocks.front().vtx[1]->GetHash()));
+
+    CBlock newest{StripBlock(blocks.back())};
+    BOOST_CHECK(store.AttachPayloads(newest));
+    BOOST_CHECK(store.ReadPayload(blocks.back().vtx[1]->GetHash()));
+}
+
+BOOST_AUTO_TEST_CASE(segop_store_prune_step)
+{
+    const fs::path blocks_dir{m_args.GetDataDirBase() / "blocks"};
+    fs::create_directories(blocks_dir);
+    PayloadStore store{blocks_dir, DBParams{.path = blocks_dir / "segop", .cache_bytes = 1 << 20, .memory_only = true}, Obfuscation{}, /*fast_prune=*/true};
+
+    std::vector<CBlock> blocks;
+    for (int height = 1; height <= 17; ++height) {
+        blocks.push_back(MakeSegopBlock(height * 4, 4));
+        BOOST_REQUIRE(store.WriteBlockPayloads(blocks.back(), height));
+    }
+
+    // Files 0 and 1 hold 32 payloads each. The first step stops part-way
+    // through file 0, but already stops claiming its heights.
+    auto progress{store.PruneStep(18, 20)};
+    BOOST_CHECK_EQUAL(progress.records, 20);
+    BOOST_CHECK_EQUAL(progress.files, 0);
+    BOOST_CHECK(!progress.done);
+    BOOST_CHECK(fs::exists(blocks_dir / "sop00000.dat"));
+    BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 9);
+
+    int steps{1};
+    int files{0};
+    while (!progress.done) {
+        progress = store.PruneStep(18, 20);
+        BOOST_CHECK_LE(progress.records, 20);
+        files += progress.files;
+        ++steps;
+    }
+    BOOST_CHECK_EQUAL(steps, 4);
+    BOOST_CHECK_EQUAL(files, 2);
+    BOOST_CHECK(!fs::exists(blocks_dir / "sop00000.dat"));
+    BOOST_CHECK(!fs::exists(blocks_dir / "sop00001.dat"));
+    BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 17);
+    BOOST_CHECK(!store.ReadPayload(blocks[7].vtx[4]->GetHash()));
+    BOOST_CHECK(store.ReadPayload(blocks[16].vtx[1]->GetHash()));
+}
+
+BOOST_AUTO_TEST_CASE(segop_store_compact)
+{
+    const fs::path blocks_dir{m_args.GetDataDirBase() / "blocks"};
+    fs::create_directories(blocks_dir);
+    PayloadStore store{blocks_dir, DBParams{.path = blocks_dir / "segop", .cache_bytes = 1 << 20, .memory_only = true}, Obfuscation{}, /*fast_prune=*/true};
+
+    std::vector<CBlock> blocks;
+    for (int height = 1; height <= 9; ++height) {
+        blocks.push_back(MakeSegopBlock(height * 4, 4));
+        BOOST_REQUIRE(store.WriteBlockPayloads(blocks.back(), height));
+    }
+    // Too little of file 0 is dead weight to be worth rewriting.
+    BOOST_CHECK_EQUAL(store.CompactStep(10)->reclaimed, 0U);
+
+    // Blocks 1-3 reorged out and back in: their records in file 0 are superseded.
+    for (int height = 1; height <= 3; ++height) {
+        BOOST_REQUIRE(store.WriteBlockPayloads(blocks[height - 1], height));
+    }
+    const auto file_size{[&] { return fs::file_size(blocks_dir / "sop00000.dat"); }};
+    const uint64_t before{file_size()};
+    // Nothing is compacted inside the archive window.
+    BOOST_CHECK_EQUAL(store.CompactStep(8)->reclaimed, 0U);
+
+    const auto progress{store.CompactStep(9)};
+    BOOST_REQUIRE(progress);
+    BOOST_CHECK(progress->done);
+    BOOST_CHECK_GT(progress->reclaimed, 0U);
+    BOOST_CHECK_LT(file_size(), before);
+    BOOST_CHECK(!fs::exists(blocks_dir / "sop00000.dat.compact"));
+    BOOST_CHECK_EQUAL(store.CompactStep(9)->reclaimed, 0U);
+
+    // Every payload is still readable, from whichever file now holds it.
+    for (const CBlock& block : blocks) {
+        for (size_t i = 1; i < block.vtx.size(); ++i) {
+            const auto payload{store.ReadPayload(block.vtx[i]->GetHash())};
+            BOOST_REQUIRE(payload);
+            BOOST_CHECK(payload->data == block.vtx[i]->segop_payload.data);
+        }
+    }
+    BOOST_CHECK_EQUAL(store.MinRetainedHeight(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(segop_store_compact_step)
+{
+    const fs::path blocks_dir{m_args.GetDataDirBase() / "blocks"};
+    fs::create_directories(blocks_dir);
+    PayloadStore store{blocks_dir, DBParams{.path = blocks_dir / "segop", .cache_bytes = 1 << 20, .memory_only = true}, Obfuscation{}, /*fast_prune=*/true};
+
+    std::vector<CBlock> blocks;
+    for (int height = 1; height <= 9; ++height) {
+        blocks.push_back(MakeSegopBlock(height * 4, 4));
+        BOOST_REQUIRE(store.WriteBlockPayloads(blocks.back(), height));
+    }
+    for (int height = 1; height <= 3; ++height) {
+        BOOST_REQUIRE(store.WriteBlockPayloads(blocks[height - 1], height));
+    }
+    const auto check_readable{[&] {
+        for (const CBlock& block : blocks) {
+            for (size_t i = 1; i < block.vtx.size(); ++i) {
+                const auto payload{store.ReadPayload(block.vtx[i]->GetHash())};
+                if (!payload || payload->data != block.vtx[i]->segop_payload.data) return false;
+            }
+        }
+        return true;
+    }};
+
+    // Readers running alongside never miss a payload.
+    std::atomic<bool> stop{false};
+    std::atomic<bool> missed{false};
+    std::thread reader{[&] {
+        while (!stop) {
+            if (!check_readable()) missed = true;
+        }
+    }};
+
+    // Two records per step at most.
+    const uint64_t budget{4000};
+    auto progress{store.CompactStep(9, budget)};
+    BOOST_REQUIRE(progress);
+    BOOST_CHECK(!progress->done);
+    BOOST_CHECK_EQUAL(progress->reclaimed, 0U);
+    BOOST_CHECK(fs::exists(blocks_dir / "sop00000.dat.compact"));
+
+    // Block 4 reorged out and back in while file 0 is being copied.
+    BOOST_REQUIRE(store.WriteBlockPayloads(blocks[3], 4));
+
+    int steps{1};
+    while (!progress->done) {
+        progress = store.CompactStep(9, budget);
+        BOOST_REQUIRE(progress);
+        ++steps;
+    }
+    stop = true;
+    reader.join();
+    BOOST_CHECK(!missed);
+    BOOST_CHECK_GT(steps, 2);
+    BOOST_CHECK_GT(progress->reclaimed, 0U);
+    BOOST_CHECK(!fs::exists(blocks_dir / "sop00000.dat.compact"));
+    BOOST_CHECK(check_readable());
+}
+
+BOOST_AUTO_TEST_CASE(segop_store_dedup)
+{
+    const fs::path blocks_dir{m_args.GetDataDirBase() / "blocks"};
+    fs::create_directories(blocks_dir);
+    PayloadStore store{blocks_dir, DBParams{.path = blocks_dir / "segop", .cache_bytes = 1 << 20, .memory_only = true}, Obfuscation{}, /*fast_prune=*/true};
+
+    // The same payload carried by three transactions, two in one block.
+    const std::string text(2000, 'z');
+    CBlock block{MakeSegopBlock(0, 1)};
+    block.vtx.push_back(MakeTransactionRef(BuildSegopTransaction(text, 100)));
+    block.vtx.push_back(MakeTransactionRef(BuildSegopTransaction(text, 101)));
+    BOOST_REQUIRE(block.vtx[2]->GetHash() != block.vtx[3]->GetHash());
+    BOOST_CHECK_EQUAL(*store.WriteBlockPayloads(block, /*height=*/1), 3U);
+    // Only the first carrier's record is written.
+    const auto record_size{[](const CTransactionRef& tx) { return GetSerializeSize(tx->GetHash()) + GetSerializeSize(tx->segop_payload); }};
+    const uint64_t usage{store.CalculateCurrentUsage()};
+    BOOST_CHECK_EQUAL(usage, record_size(block.vtx[1]) + record_size(block.vtx[2]));
+
+    CBlock next{MakeSegopBlock(1, 0)};
+    next.vtx.push_back(MakeTransactionRef(BuildSegopTransaction(text, 102)));
+    BOOST_CHECK_EQUAL(*store.WriteBlockPayloads(next, /*height=*/2), 1U);
+    BOOST_CHECK_EQUAL(store.CalculateCurrentUsage(), usage);
+
+    // Every carrier reads back the shared bytes, as does the commitment.
+    for (const CTransactionRef& tx : {block.vtx[2], block.vtx[3], next.vtx[1]}) {
+        const auto payload{store.ReadPayload(tx->GetHash())};
+        BOOST_REQUIRE(payload);
+        BOOST_CHECK(payload->data == block.vtx[2]->segop_payload.data);
+    }
+    const auto commitment{GetPayloadCommitment(*block.vtx[2])};
+    BOOST_REQUIRE(commitment);
+    BOOST_CHECK(*commitment == SegopCommitment(block.vtx[2]->segop_payload.data));
+    const auto by_commitment{store.ReadPayloadByCommitment(*commitment)};
+    BOOST_REQUIRE(by_commitment);
+    BOOST_CHECK(by_commitment->data == block.vtx[2]->segop_payload.data);
+    BOOST_CHECK(!store.ReadPayloadByCommitment(uint256::ONE));
+
+    CBlock stripped{StripBlock(next)};
+    BOOST_CHECK(store.AttachPayloads(stripped));
+    BOOST_CHECK_EQUAL(stripped.vtx[1]->GetWitnessHash(), next.vtx[1]->GetWitnessHash());
+
+    // Fill file 0 (32 records, up to height 10) and prune it: the record and
+    // all of its aliases go together.
+    for (int height = 3; height <= 12; ++height) {
+        BOOST_REQUIRE(store.WriteBlockPayloads(MakeSegopBlock(height * 4, 4), height));
+    }
+    BOOST_REQUIRE(fs::exists(blocks_dir / "sop00001.dat"));
+    BOOST_CHECK_EQUAL(store.PruneBelow(11), 1);
+    BOOST_CHECK(!store.ReadPayload(block.vtx[2]->GetHash()));
+    BOOST_CHECK(!store.ReadPayload(block.vtx[3]->GetHash()));
+    BOOST_CHECK(!store.ReadPayload(next.vtx[1]->GetHash()));
+    BOOST_CHECK(!store.ReadPayloadByCommitment(*commitment));
+}
+
+BOOST_AUTO_TEST_CASE(segop_lz_roundtrip)
+{
+    std::vector<std::vector<unsigned char>> inputs{
+        {},
+        {'x'},
+        std::vector<unsigned char>(100'000, 'a'),
+        m_rng.randbytes(5000),
+    };
+    std::string json;
+    for (int i = 0; i < 200; ++i) json += strprintf("{\"id\":%d,\"name\":\"item%d\",\"tags\":[\"a\",\"b\"]},", i, i % 7);
+    inputs.emplace_back(json.begin(), json.end());
+
+    for (const auto& input : inputs) {
+        const auto compressed{LZCompress(input)};
+        BOOST_CHECK(LZDecompress(compressed, input.size()) == input);
+        // The exact size is part of the format.
+        BOOST_CHECK(!LZDecompress(compressed, input.size() + 1));
+        if (input.size() > 1) BOOST_CHECK(!LZDecompress(compressed, input.size() - 1));
+    }
+    BOOST_CHECK_LT(LZCompress(inputs[2]).size(), 1000U);
+    BOOST_CHECK_LT(LZCompress(inputs[4]).size(), json.size() / 4);
+
+    // Corrupted streams fail cleanly: truncated, or a match reaching back
+    // before the start of the output.
+    const auto compressed{LZCompress(inputs[4])};
+    for (size_t len = 0; len < compressed.size(); len += 7) {
+        BOOST_CHECK(!LZDecompress(std::span{compressed}.first(len), json.size()));
+    }
+    const std::vector<unsigned char> bad_offset{0x10, 'a', 0x05, 0x00};
+    BOOST_CHECK(!LZDecompress(bad_offset, 10));
+}
+
+BOOST_AUTO_TEST_CASE(segop_store_compress)
+{
+    const fs::path blocks_dir{m_args.GetDataDirBase() / "blocks"};
+    fs::create_directories(blocks_dir);
+    const CompressionOptions compression{.tlv_types = {SegopTlvType::TEXT_UTF8}, .min_size = 4000};
+    PayloadStore store{blocks_dir, DBParams{.path = blocks_dir / "segop", .cache_bytes = 1 << 20, .memory_only = true}, Obfuscation{}, /*fast_prune=*/true, compression};
+
+    // A large text payload is compressed; a small one and a binary one are not.
+    std::vector<CTransactionRef> txs{MakeTransactionRef(BuildSegopTransaction(std::string(8000, 't'), 1)),
+                                     MakeTransactionRef(BuildSegopTransaction("short", 2))};
+    {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout = COutPoint{Txid{}, 3};
+        AddSegopPayload(mtx, BuildSegopBlobTlv(std::vector<unsigned char>(8000, 0)));
+        txs.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+    BOOST_CHECK(compression.ShouldCompress(txs[0]->segop_payload));
+    BOOST_CHECK(!compression.ShouldCompress(txs[1]->segop_payload));
+    BOOST_CHECK(!compression.ShouldCompress(txs[2]->segop_payload));
+
+    CBlock block{MakeSegopBlock(0, 0)};
+    block.vtx.insert(block.vtx.end(), txs.begin(), txs.end());
+    BOOST_CHECK_EQUAL(*store.WriteBlockPayloads(block, /*height=*/1), 3U);
+    const auto record_size{[](const CTransactionRef& tx) { return GetSerializeSize(tx->GetHash()) + GetSerializeSize(tx->segop_payload); }};
+    BOOST_CHECK_LT(store.CalculateCurrentUsage(), record_size(txs[0]) / 4 + record_size(txs[1]) + record_size(txs[2]));
+
+    // Reads return the payloads as committed to, by txid and by commitment.
+    for (const CTransactionRef& tx : txs) {
+        const auto payload{store.ReadPayload(tx->GetHash())};
+        BOOST_REQUIRE(payload);
+        BOOST_CHECK(payload->data == tx->segop_payload.data);
+        BOOST_CHECK_EQUAL(payload->version, tx->segop_payload.version);
+    }
+    const auto by_commitment{store.ReadPayloadByCommitment(SegopCommitment(txs[0]->segop_payload.data))};
+    BOOST_REQUIRE(by_commitment);
+    BOOST_CHECK(by_commitment->data == txs[0]->segop_payload.data);
+    CBlock stripped{StripBlock(block)};
+    BOOST_CHECK(store.AttachPayloads(stripped));
+    BOOST_CHECK_EQUAL(stripped.vtx[1]->GetWitnessHash(), txs[0]->GetWitnessHash());
+
+    // Compressed records survive compaction unchanged. Blocks 2-8 fill file
+    // 0; rewriting blocks 2-4 leaves enough of it dead to be compacted.
+    for (int height = 2; height <= 9; ++height) {
+        BOOST_REQUIRE(store.WriteBlockPayloads(MakeSegopBlock(height * 4, 4), height));
+    }
+    for (int height = 2; height <= 4; ++height) {
+        BOOST_REQUIRE(store.WriteBlockPayloads(MakeSegopBlock(height * 4, 4), height));
+    }
+    const auto progress{store.CompactStep(10)};
+    BOOST_REQUIRE(progress);
+    BOOST_CHECK_GT(progress->reclaimed, 0U);
+    for (const CTransactionRef& tx : txs) {
+        const auto payload{store.ReadPayload(tx->GetHash())};
+        BOOST_REQUIRE(payload);
+        BOOST_CHECK(payload->data == tx->segop_payload.data);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(segop_store_compress_rewrite)
+{
+    const fs::path blocks_dir{m_args.GetDataDirBase() / "blocks"};
+    fs::create_directories(blocks_dir);
+    const DBParams db_params{.path = blocks_dir / "segop", .cache_bytes = 1 << 20};
+
+    // Eight large text payloads fill file 0 uncompressed; the ninth starts file 1.
+    std::vector<CBlock> blocks;
+    for (uint32_t height = 1; height <= 9; ++height) {
+        CBlock block{MakeSegopBlock(0, 0)};
+        block.vtx.push_back(MakeTransactionRef(BuildSegopTransaction(std::string(8000, 'a' + height), height)));
+        blocks.push_back(std::move(block));
+    }
+    {
+        PayloadStore store{blocks_dir, db_params, Obfuscation{}, /*fast_prune=*/true};
+        for (int height = 1; height <= 9; ++height) {
+            BOOST_REQUIRE(store.WriteBlockPayloads(blocks[height - 1], height));
+        }
+        BOOST_REQUIRE(fs::exists(blocks_dir / "sop00001.dat"));
+    }
+
+    // Rewritten with -segopcompress, blocks 1-3 leave their uncompressed
+    // records in file 0 behind. Those count as dead weight in full, which
+    // makes the file worth compacting.
+    const CompressionOptions compression{.tlv_types = {SegopTlvType::TEXT_UTF8}, .min_size = 4000};
+    PayloadStore store{blocks_dir, db_params, Obfuscation{}, /*fast_prune=*/true, compression};
+    for (int height = 1; height <= 3; ++height) {
+        BOOST_REQUIRE(store.WriteBlockPayloads(blocks[height - 1], height));
+    }
+    const auto progress{store.CompactStep(10)};
+    BOOST_REQUIRE(progress);
+    BOOST_CHECK_GT(progress->reclaimed, 3 * 8000U);
+    for (const CBlock& block : blocks) {
+        const auto payload{store.ReadPayload(block.vtx[1]->GetHash())};
+        BOOST_REQUIRE(payload);
+        BOOST_CHECK(payload->data == block.vtx[1]->segop_payload.data);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
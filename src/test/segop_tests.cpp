@@ -0,0 +1,295 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <checkqueue.h>
+#include <consensus/tx_check.h>
+#include <consensus/validation.h>
+#include <core_io.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <segop/segop.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <test/util/transaction_utils.h>
+#include <validation.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(segop_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(segop_tlv_iterator)
+{
+    const std::vector<unsigned char> payload{BuildSegopTextTlvMulti({"ab", std::string(300, 'c'), ""})};
+
+    SegopTlvIterator it{payload};
+    auto record{it.Next()};
+    BOOST_REQUIRE(record);
+    BOOST_CHECK_EQUAL(record->type, SegopTlvType::TEXT_UTF8);
+    BOOST_CHECK_EQUAL(std::string(record->value.begin(), record->value.end()), "ab");
+    // Records view the payload bytes.
+    BOOST_CHECK(record->value.data() == payload.data() + 2);
+    record = it.Next();
+    BOOST_REQUIRE(record);
+    BOOST_CHECK_EQUAL(record->value.size(), 300U);
+    record = it.Next();
+    BOOST_REQUIRE(record);
+    BOOST_CHECK(record->value.empty());
+    BOOST_CHECK(!it.Next());
+    BOOST_CHECK(it.Done());
+    BOOST_CHECK(!it.Error());
+    BOOST_CHECK(SegopIsValidTLV(payload));
+    BOOST_CHECK(SegopIsValidTLV(std::vector<unsigned char>{}));
+
+    // Value running past the end.
+    std::vector<unsigned char> truncated{payload.begin(), payload.end() - 3};
+    BOOST_CHECK(!SegopIsValidTLV(truncated));
+    SegopTlvIterator it_truncated{truncated};
+    BOOST_CHECK(it_truncated.Next());
+    BOOST_CHECK(!it_truncated.Next());
+    BOOST_CHECK(it_truncated.Error());
+
+    // Non-canonical CompactSize length (0xfd encoding of 2).
+    BOOST_CHECK(!SegopIsValidTLV(std::vector<unsigned char>{0x01, 0xfd, 0x02, 0x00, 'a', 'b'}));
+    // Type byte without a length.
+    BOOST_CHECK(!SegopIsValidTLV(std::vector<unsigned char>{0x01, 0x00, 0x01}));
+
+    // Stopping early is not an error, but not done either.
+    SegopTlvIterator it_early{payload};
+    BOOST_CHECK(it_early.Next());
+    BOOST_CHECK(!it_early.Error());
+    BOOST_CHECK(!it_early.Done());
+}
+
+BOOST_AUTO_TEST_CASE(segop_tlv_classify)
+{
+    // Tier T2 (operational), type L2 state anchor.
+    const std::vector<unsigned char> labelled{BuildSegopBUDSTextPayload(0x20, 0x21, "anchor")};
+    SegopBUDSInfo info;
+    BOOST_CHECK(SegopParseTLV(labelled, &info));
+    BOOST_CHECK(info.has_tier);
+    BOOST_CHECK(info.tier == segop::BUDSTier::T2_OPERATIONAL);
+    BOOST_CHECK(info.arbda == segop::ARBDATier::T2);
+    BOOST_CHECK(SegopExtractBUDSInfo(labelled).arbda == info.arbda);
+
+    // Unlabelled data is arbitrary.
+    SegopBUDSInfo unlabelled;
+    BOOST_CHECK(SegopParseTLV(BuildSegopTextTlv("hello"), &unlabelled));
+    BOOST_CHECK(!unlabelled.has_tier);
+    BOOST_CHECK(unlabelled.arbda == segop::ARBDATier::T3);
+
+    // A malformed payload is reported, with the records before the error classified.
+    std::vector<unsigned char> malformed{labelled};
+    malformed.push_back(0x01);
+    SegopBUDSInfo partial;
+    BOOST_CHECK(!SegopParseTLV(malformed, &partial));
+    BOOST_CHECK(partial.tier == segop::BUDSTier::T2_OPERATIONAL);
+
+    // An empty payload carries no metadata.
+    BOOST_CHECK(SegopExtractBUDSInfo(std::vector<unsigned char>{}).arbda == segop::ARBDATier::T0);
+}
+
+BOOST_AUTO_TEST_CASE(segop_payload_unserialize)
+{
+    // Round trip.
+    CSegopPayload payload;
+    payload.version = CSegopPayload::SEGOP_VERSION;
+    payload.data = BuildSegopTextTlvMulti({"a", std::string(300, 'b'), std::string(70'000 / 2, 'c')});
+    DataStream stream;
+    stream << payload;
+    CSegopPayload decoded;
+    stream >> decoded;
+    BOOST_CHECK(decoded.data == payload.data);
+    BOOST_CHECK(stream.empty());
+
+    // A declared length over the cap fails before any payload byte is read.
+    stream.clear();
+    stream << CSegopPayload::SEGOP_VERSION;
+    WriteCompactSize(stream, CSegopPayload::MAX_SEGOP_PAYLOAD_SIZE + 1);
+    stream << std::vector<unsigned char>(16, 0x01);
+    BOOST_CHECK_EXCEPTION(stream >> decoded, std::ios_base::failure, HasReason("segOP payload exceeds size limit"));
+    BOOST_CHECK_EQUAL(stream.size(), 17U);
+
+    // A record running past the payload fails as soon as its header is read.
+    stream.clear();
+    stream << CSegopPayload::SEGOP_VERSION;
+    WriteCompactSize(stream, 60'000);
+    stream << uint8_t{0x01};
+    WriteCompactSize(stream, 60'000);
+    stream << std::vector<unsigned char>(10, 'x');
+    BOOST_CHECK_EXCEPTION(stream >> decoded, std::ios_base::failure, HasReason("segOP TLV record truncated"));
+    BOOST_CHECK_EQUAL(stream.size(), 11U);
+
+    // Non-canonical record lengths are rejected while reading.
+    stream.clear();
+    stream << CSegopPayload::SEGOP_VERSION;
+    stream << std::vector<unsigned char>{0x01, 0xfd, 0x02, 0x00, 'a', 'b'};
+    BOOST_CHECK_EXCEPTION(stream >> decoded, std::ios_base::failure, HasReason("non-canonical"));
+
+    // Other versions are not parsed as TLV (CheckTransaction rejects them).
+    stream.clear();
+    stream << uint8_t{0x02} << std::vector<unsigned char>{0x01, 0x05, 'a'};
+    stream >> decoded;
+    BOOST_CHECK_EQUAL(decoded.version, 0x02);
+    BOOST_CHECK_EQUAL(decoded.data.size(), 3U);
+}
+
+BOOST_AUTO_TEST_CASE(segop_decode_hex_tx)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout = COutPoint{Txid::FromUint256(uint256::ONE), 0};
+    AddSegopPayload(mtx, BuildSegopTextTlv("decode me"));
+    const CTransaction tx{mtx};
+
+    // The segOP section is read along with the rest of the transaction.
+    const std::string hex{EncodeHexTx(tx)};
+    CMutableTransaction decoded;
+    BOOST_REQUIRE(DecodeHexTx(decoded, hex, /*try_no_witness=*/true, /*try_witness=*/true));
+    BOOST_CHECK(decoded.segop_payload.data == mtx.segop_payload.data);
+    BOOST_CHECK_EQUAL(CTransaction{decoded}.GetFullxid(), tx.GetFullxid());
+
+    // The payload must be flagged, not appended after the transaction.
+    DataStream stream;
+    stream << TX_WITH_WITNESS_NO_SEGOP(tx) << tx.segop_payload;
+    BOOST_CHECK(!DecodeHexTx(decoded, HexStr(stream), /*try_no_witness=*/true, /*try_witness=*/true));
+    BOOST_CHECK(!DecodeHexTx(decoded, hex + "00", /*try_no_witness=*/true, /*try_witness=*/true));
+}
+
+BOOST_AUTO_TEST_CASE(segop_packed_buds_info)
+{
+    // Round trip of a labelled payload.
+    const SegopBUDSInfo info{SegopExtractBUDSInfo(BuildSegopBUDSTextPayload(0x20, 0x01, "anchor"))};
+    const SegopPackedBUDSInfo packed{info};
+    BOOST_CHECK_EQUAL(packed.TierCode(), 0x20);
+    BOOST_CHECK_EQUAL(packed.TypeCode(), 0x01);
+    BOOST_CHECK(packed.Tier() == segop::BUDSTier::T2_OPERATIONAL);
+    BOOST_CHECK(packed.Type() == segop::BUDSDataType::L2_STATE_ANCHOR);
+    BOOST_CHECK(packed.ARBDA() == segop::ARBDATier::T2);
+    BOOST_CHECK(packed.HasTier() && packed.HasType() && !packed.IsAmbiguous());
+    const SegopBUDSInfo unpacked{packed.Unpack()};
+    BOOST_CHECK_EQUAL(unpacked.tier_code, info.tier_code);
+    BOOST_CHECK(unpacked.type == info.type);
+    BOOST_CHECK(unpacked.arbda == info.arbda);
+
+    // Conflicting tier markers: ambiguous, with the conservative ARBDA tier.
+    const std::vector<unsigned char> conflicting{BuildSegopTlvSequence({{0xF0, {0x10}}, {0xF0, {0x30}}})};
+    const SegopPackedBUDSInfo ambiguous{SegopExtractBUDSInfo(conflicting)};
+    BOOST_CHECK(ambiguous.IsAmbiguous());
+    BOOST_CHECK(ambiguous.Tier() == segop::BUDSTier::AMBIGUOUS);
+    BOOST_CHECK(ambiguous.ARBDA() == segop::ARBDATier::T3);
+    BOOST_CHECK(!ambiguous.HasType());
+
+    // The default is a transaction without a payload.
+    BOOST_CHECK(SegopPackedBUDSInfo{}.ARBDA() == segop::ARBDATier::T0);
+    BOOST_CHECK(!SegopPackedBUDSInfo{}.HasTier());
+}
+
+BOOST_AUTO_TEST_CASE(segop_check_commitment)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout = COutPoint{Txid::FromUint256(uint256::ONE), 0};
+    mtx.vout.emplace_back(1000, CScript() << OP_TRUE);
+    BOOST_CHECK(CTransaction{mtx}.GetSegopCommitment().IsNull());
+
+    AddSegopPayload(mtx, BuildSegopTextTlv("hello"));
+    const CScript p2sop{mtx.vout.back().scriptPubKey};
+    const CTransaction tx{mtx};
+    BOOST_CHECK_EQUAL(tx.GetSegopCommitment(), SegopCommitment(tx.segop_payload.data));
+    BOOST_CHECK_EQUAL(*SegopGetCommitment(p2sop), tx.GetSegopCommitment());
+    TxValidationState state;
+    BOOST_CHECK(CheckTransaction(tx, state));
+
+    // A second P2SOP output, even a matching one, breaks the 1:1 coupling.
+    mtx.vout.emplace_back(0, p2sop);
+    BOOST_CHECK(!CheckTransaction(CTransaction{mtx}, state));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-txns-segop-no-p2sop");
+    mtx.vout.pop_back();
+
+    // Committing to different bytes.
+    mtx.segop_payload.data = BuildSegopTextTlv("hellO");
+    const CTransaction mismatched{mtx};
+    state = {};
+    BOOST_CHECK(!CheckTransaction(mismatched, state));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-txns-segop-no-p2sop");
+    // Once the segOP rules are known to hold (from the validation cache), they are not re-run.
+    state = {};
+    BOOST_CHECK(CheckTransaction(mismatched, state, /*segop_checked=*/true));
+
+    // P2SOP without a payload.
+    mtx.segop_payload = CSegopPayload{};
+    state = {};
+    BOOST_CHECK(!CheckTransaction(CTransaction{mtx}, state));
+    BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-txns-segop-p2sop-without-segop");
+}
+
+BOOST_AUTO_TEST_CASE(segop_check_queue)
+{
+    CBlock block;
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].scriptSig = CScript() << OP_1 << OP_1;
+    coinbase.vout.emplace_back(0, CScript() << OP_TRUE);
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+    for (uint32_t i = 0; i < 20; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout = COutPoint{Txid::FromUint256(uint256::ONE), i};
+        AddSegopPayload(mtx, BuildSegopTextTlv(std::string(1000, 'a')));
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+
+    CCheckQueue<CBlockCheck> queue{/*batch_size=*/4, /*worker_threads_num=*/2};
+    const auto& consensus{Params().GetConsensus()};
+    BlockValidationState state;
+    BOOST_CHECK(CheckBlock(block, state, consensus, /*fCheckPOW=*/false, /*fCheckMerkleRoot=*/false, /*validation_cache=*/nullptr, &queue));
+
+    // A payload that commits correctly but is not valid TLV fails on a worker,
+    // with the same reject reason as the serial check.
+    CMutableTransaction bad{*block.vtx[7]};
+    bad.segop_payload.data = std::vector<unsigned char>{0x01, 0x05, 'a'};
+    bad.vout[0].scriptPubKey = CScript() << OP_RETURN << BuildSegopCommitmentBlob(bad.segop_payload.data);
+    block.vtx[7] = MakeTransactionRef(std::move(bad));
+    for (CCheckQueue<CBlockCheck>* check_queue : {&queue, static_cast<CCheckQueue<CBlockCheck>*>(nullptr)}) {
+        state = {};
+        BOOST_CHECK(!CheckBlock(block, state, consensus, /*fCheckPOW=*/false, /*fCheckMerkleRoot=*/false, /*validation_cache=*/nullptr, check_queue));
+        BOOST_CHECK_EQUAL(state.GetRejectReason(), "bad-txns-segop-tlv");
+        BOOST_CHECK(state.GetResult() == BlockValidationResult::BLOCK_CONSENSUS);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(segop_block_batch_hashes)
+{
+    // Payloads of varied sizes, with and without witnesses, mixed with plain
+    // transactions: deserializing the block hashes the payloads as a batch.
+    CBlock block;
+    for (uint32_t i = 0; i < 12; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout = COutPoint{Txid::FromUint256(uint256::ONE), i};
+        if (i % 3 == 0) mtx.vin[0].scriptWitness.stack = {std::vector<unsigned char>(72, 0x30)};
+        mtx.vout.emplace_back(1000, CScript() << OP_TRUE);
+        if (i % 4 != 1) AddSegopPayload(mtx, BuildSegopTextTlv(std::string(i * 700, 'a' + i)));
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+
+    DataStream stream;
+    stream << TX_WITH_WITNESS(block);
+    CBlock decoded;
+    stream >> TX_WITH_WITNESS(decoded);
+    BOOST_REQUIRE_EQUAL(decoded.vtx.size(), block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        BOOST_CHECK_EQUAL(decoded.vtx[i]->GetHash(), block.vtx[i]->GetHash());
+        BOOST_CHECK_EQUAL(decoded.vtx[i]->GetWitnessHash(), block.vtx[i]->GetWitnessHash());
+        BOOST_CHECK_EQUAL(decoded.vtx[i]->GetFullxid(), block.vtx[i]->GetFullxid());
+        BOOST_CHECK_EQUAL(decoded.vtx[i]->GetSegopCommitment(), block.vtx[i]->GetSegopCommitment());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
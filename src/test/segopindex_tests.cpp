@@ -0,0 +1,147 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <chain.h>
+#include <consensus/validation.h>
+#include <index/segopindex.h>
+#include <interfaces/chain.h>
+#include <merkleblock.h>
+#include <script/script.h>
+#include <segop/segop.h>
+#include <test/util/setup_common.h>
+#include <test/util/transaction_utils.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+namespace {
+
+//! Spend a mature coinbase into a transaction carrying `payload`.
+CMutableTransaction MakeSegopSpend(TestChain100Setup& setup, size_t coinbase_index, const std::vector<unsigned char>& payload)
+{
+    const CTransactionRef& coinbase{setup.m_coinbase_txns[coinbase_index]};
+    CMutableTransaction segop;
+    AddSegopPayload(segop, payload);
+    const std::vector<CTxOut> outputs{
+        {coinbase->vout[0].nValue - 10'000, GetScriptForDestination(PKHash(setup.coinbaseKey.GetPubKey()))},
+        segop.vout[0],
+    };
+    // Signatures do not cover the payload itself, only the P2SOP commitment.
+    CMutableTransaction mtx{setup.CreateValidTransaction({coinbase}, {COutPoint{coinbase->GetHash(), 0}}, /*input_height=*/coinbase_index + 1,
+                                                         {setup.coinbaseKey}, outputs, std::nullopt, std::nullopt).first};
+    mtx.segop_payload = segop.segop_payload;
+    return mtx;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(segopindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(segopindex_range_queries, TestChain100Setup)
+{
+    const CScript coinbase_script{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+    // Heights 101-103: an L2 state anchor (T2), a text note (T1) and an unlabelled payload.
+    const std::vector<std::vector<unsigned char>> payloads{
+        BuildSegopBUDSTextPayload(0x20, 0x01, "anchor"),
+        BuildSegopBUDSTextPayload(0x10, 0x01, "note"),
+        BuildSegopTextTlv("hello"),
+    };
+    std::vector<Txid> txids;
+    std::vector<CBlock> blocks;
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        const CMutableTransaction mtx{MakeSegopSpend(*this, i, payloads[i])};
+        txids.push_back(mtx.GetHash());
+        blocks.push_back(CreateAndProcessBlock({mtx}, coinbase_script));
+        BOOST_REQUIRE_EQUAL(blocks.back().vtx.size(), 2U);
+    }
+
+    SegopIndex segopindex(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(segopindex.Init());
+    segopindex.Sync();
+
+    std::vector<SegopIndexEntry> entries;
+    BOOST_CHECK(segopindex.FindSegopTxs(0, 1000, {}, 1000, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 3U);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        BOOST_CHECK_EQUAL(entries[i].txid, txids[i]);
+        BOOST_CHECK_EQUAL(entries[i].height, 101 + int(i));
+        BOOST_CHECK_EQUAL(entries[i].payload_size, payloads[i].size());
+        BOOST_CHECK_EQUAL(entries[i].block_hash, blocks[i].GetHash());
+    }
+    BOOST_CHECK(entries[0].tier == segop::BUDSTier::T2_OPERATIONAL);
+    BOOST_CHECK(entries[0].type == segop::BUDSDataType::L2_STATE_ANCHOR);
+    BOOST_CHECK(entries[0].arbda == segop::ARBDATier::T2);
+    BOOST_CHECK(entries[1].type == segop::BUDSDataType::TEXT_NOTE);
+    BOOST_CHECK(entries[2].tier == segop::BUDSTier::UNSPECIFIED);
+
+    // The recorded position locates the transaction, payload included.
+    CTransactionRef tx;
+    BOOST_REQUIRE(segopindex.ReadTx(entries[1], tx));
+    BOOST_CHECK_EQUAL(tx->GetHash(), txids[1]);
+    BOOST_CHECK(tx->segop_payload.data == payloads[1]);
+
+    // The segOP merkle root of each block is recorded.
+    SegopBlockRoot root;
+    BOOST_REQUIRE(segopindex.FindBlockRoot(blocks[0].GetHash(), root));
+    BOOST_CHECK_EQUAL(root.leaves, 1U);
+    BOOST_CHECK(root.root == ComputeSegopMerkleRoot(GetSegopLeaves(blocks[0])));
+    BOOST_CHECK(!segopindex.FindBlockRoot(uint256::ONE, root));
+
+    // Height bounds and the limit.
+    entries.clear();
+    BOOST_CHECK(segopindex.FindSegopTxs(102, 102, {}, 1000, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 1U);
+    BOOST_CHECK_EQUAL(entries[0].txid, txids[1]);
+    entries.clear();
+    BOOST_CHECK(segopindex.FindSegopTxs(0, 1000, {}, 2, entries));
+    BOOST_CHECK_EQUAL(entries.size(), 2U);
+
+    // By tier, by data type, and by both.
+    entries.clear();
+    BOOST_CHECK(segopindex.FindSegopTxs(0, 1000, {.tier = segop::BUDSTier::T1_METADATA}, 1000, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 1U);
+    BOOST_CHECK_EQUAL(entries[0].txid, txids[1]);
+    entries.clear();
+    BOOST_CHECK(segopindex.FindSegopTxs(0, 1000, {.type = segop::BUDSDataType::L2_STATE_ANCHOR}, 1000, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 1U);
+    BOOST_CHECK_EQUAL(entries[0].txid, txids[0]);
+    entries.clear();
+    BOOST_CHECK(segopindex.FindSegopTxs(0, 1000, {.tier = segop::BUDSTier::T1_METADATA, .type = segop::BUDSDataType::L2_STATE_ANCHOR}, 1000, entries));
+    BOOST_CHECK(entries.empty());
+
+    // Reorg out the last block: its entry goes once the index follows the new tip.
+    entries.clear();
+    BOOST_CHECK(segopindex.FindSegopTxs(103, 103, {}, 1000, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 1U);
+    const SegopIndexEntry stale{entries[0]};
+    {
+        BlockValidationState state;
+        CBlockIndex* tip{WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip())};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, tip));
+    }
+    CreateAndProcessBlock({}, CScript() << OP_TRUE);
+    BOOST_CHECK(segopindex.BlockUntilSyncedToCurrentChain());
+    entries.clear();
+    BOOST_CHECK(segopindex.FindSegopTxs(0, 1000, {}, 1000, entries));
+    BOOST_REQUIRE_EQUAL(entries.size(), 2U);
+    entries.clear();
+    BOOST_CHECK(segopindex.FindSegopTxs(0, 1000, {.tier = segop::BUDSTier::UNSPECIFIED}, 1000, entries));
+    BOOST_CHECK(entries.empty());
+    BOOST_CHECK(!segopindex.FindBlockRoot(blocks[2].GetHash(), root));
+    // An entry read before the reorg still names the block it came from, not
+    // the one now at its height.
+    {
+        LOCK(cs_main);
+        const CChain& active_chain{m_node.chainman->ActiveChain()};
+        BOOST_CHECK(!active_chain.Contains(m_node.chainman->m_blockman.LookupBlockIndex(stale.block_hash)));
+        BOOST_CHECK(active_chain[stale.height]->GetBlockHash() != stale.block_hash);
+    }
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    m_node.validation_signals->SyncWithValidationInterfaceQueue();
+    segopindex.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -13,6 +13,7 @@
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
 #include <core_io.h>
+#include <hash.h>
 #include <key.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
@@ -23,6 +24,7 @@
 #include <script/sign.h>
 #include <script/signingprovider.h>
 #include <script/solver.h>
+#include <segop/segop.h>
 #include <streams.h>
 #include <test/util/json.h>
 #include <test/util/random.h>
@@ -1304,4 +1306,62 @@ BOOST_AUTO_TEST_CASE(spends_witness_prog)
     }
 }
 
+BOOST_AUTO_TEST_CASE(segop_transaction_hashes)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vout.emplace_back(1, CScript() << OP_TRUE);
+    const CTransaction legacy{mtx};
+
+    mtx.segop_payload.version = CSegopPayload::SEGOP_VERSION;
+    mtx.segop_payload.data = BuildSegopTextTlv("hello");
+    const CTransaction segop_only{mtx};
+
+    // txid and wtxid ignore the segOP section; fullxid commits to it.
+    BOOST_CHECK_EQUAL(segop_only.GetHash(), legacy.GetHash());
+    BOOST_CHECK_EQUAL(segop_only.GetWitnessHash(), legacy.GetWitnessHash());
+    BOOST_CHECK_EQUAL(mtx.GetHash(), segop_only.GetHash());
+    BOOST_CHECK(segop_only.GetFullxid() != legacy.GetFullxid());
+    BOOST_CHECK_EQUAL(segop_only.GetHash(), Txid::FromUint256((HashWriter{} << TX_NO_WITNESS_NO_SEGOP(segop_only)).GetHash()));
+    BOOST_CHECK_EQUAL(segop_only.GetFullxid(), Fullxid::FromUint256((TaggedHash("segop:fullxid") << TX_WITH_WITNESS(segop_only)).GetHash()));
+
+    mtx.vin[0].scriptWitness.stack.push_back({1});
+    const CTransaction with_witness{mtx};
+    BOOST_CHECK_EQUAL(with_witness.GetHash(), legacy.GetHash());
+    BOOST_CHECK_EQUAL(with_witness.GetWitnessHash(), Wtxid::FromUint256((HashWriter{} << TX_WITH_WITNESS_NO_SEGOP(with_witness)).GetHash()));
+    BOOST_CHECK(with_witness.GetWitnessHash() != legacy.GetWitnessHash());
+    BOOST_CHECK_EQUAL(with_witness.GetFullxid(), Fullxid::FromUint256((TaggedHash("segop:fullxid") << TX_WITH_WITNESS(with_witness)).GetHash()));
+}
+
+BOOST_AUTO_TEST_CASE(segop_payload_shared)
+{
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vout.emplace_back(1, CScript() << OP_TRUE);
+    mtx.segop_payload.version = CSegopPayload::SEGOP_VERSION;
+    mtx.segop_payload.data = BuildSegopTextTlv(std::string(1000, 'x'));
+    BOOST_CHECK_EQUAL(mtx.segop_payload.data.use_count(), 1);
+
+    // Copies share the payload bytes.
+    const CTransactionRef tx{MakeTransactionRef(mtx)};
+    const CMutableTransaction mtx2{*tx};
+    BOOST_CHECK_EQUAL(mtx.segop_payload.data.use_count(), 3);
+    BOOST_CHECK_EQUAL(mtx2.segop_payload.data.data(), mtx.segop_payload.data.data());
+
+    // Replacing the bytes of one copy leaves the others alone.
+    mtx.segop_payload.data = BuildSegopTextTlv("y");
+    BOOST_CHECK_EQUAL(tx->segop_payload.data.use_count(), 2);
+    BOOST_CHECK(tx->segop_payload.data == mtx2.segop_payload.data);
+    BOOST_CHECK(!(tx->segop_payload.data == mtx.segop_payload.data));
+
+    // A deserialized payload equals the original without sharing it.
+    DataStream stream;
+    stream << TX_WITH_WITNESS(*tx);
+    CMutableTransaction mtx3;
+    stream >> TX_WITH_WITNESS(mtx3);
+    BOOST_CHECK(mtx3.segop_payload.data == tx->segop_payload.data);
+    BOOST_CHECK_EQUAL(mtx3.segop_payload.data.use_count(), 1);
+    BOOST_CHECK_EQUAL(CTransaction{mtx3}.GetFullxid(), tx->GetFullxid());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
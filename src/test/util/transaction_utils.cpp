@@ -5,6 +5,7 @@
 #include <coins.h>
 #include <consensus/validation.h>
 #include <script/signingprovider.h>
+#include <segop/segop.h>
 #include <test/util/transaction_utils.h>
 
 CMutableTransaction BuildCreditingTransaction(const CScript& scriptPubKey, int nValue)
@@ -41,6 +42,23 @@ CMutableTransaction BuildSpendingTransaction(const CScript& scriptSig, const CSc
     return txSpend;
 }
 
+void AddSegopPayload(CMutableTransaction& tx, const std::vector<unsigned char>& payload)
+{
+    tx.segop_payload.version = CSegopPayload::SEGOP_VERSION;
+    tx.segop_payload.data = payload;
+    tx.vout.emplace_back(0, CScript() << OP_RETURN << BuildSegopCommitmentBlob(payload));
+}
+
+CMutableTransaction BuildSegopTransaction(const std::string& text, uint32_t n)
+{
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    tx.vin[0].prevout = COutPoint{Txid{}, n};
+    AddSegopPayload(tx, BuildSegopTextTlv(text));
+
+    return tx;
+}
+
 std::vector<CMutableTransaction> SetupDummyInputs(FillableSigningProvider& keystoreRet, CCoinsViewCache& coinsRet, const std::array<CAmount,4>& nValues)
 {
     std::vector<CMutableTransaction> dummyTransactions;
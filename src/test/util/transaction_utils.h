@@ -9,6 +9,8 @@
 #include <script/sign.h>
 
 #include <array>
+#include <string>
+#include <vector>
 
 class FillableSigningProvider;
 class CCoinsViewCache;
@@ -27,6 +29,13 @@ CMutableTransaction BuildSpendingTransaction(const CScript& scriptSig, const CSc
 // the second nValues[2] and nValues[3] outputs paid to a TxoutType::PUBKEYHASH.
 std::vector<CMutableTransaction> SetupDummyInputs(FillableSigningProvider& keystoreRet, CCoinsViewCache& coinsRet, const std::array<CAmount,4>& nValues);
 
+// attach a segOP payload to tx, along with the P2SOP output committing to it
+void AddSegopPayload(CMutableTransaction& tx, const std::vector<unsigned char>& payload);
+
+// create segOP transaction
+// [1 input spending output n of a null txid => 1 P2SOP output, committing to a text payload]
+CMutableTransaction BuildSegopTransaction(const std::string& text, uint32_t n = 0);
+
 // bulk transaction to reach a certain target weight,
 // by appending a single output with padded output script
 void BulkTransaction(CMutableTransaction& tx, int32_t target_weight);
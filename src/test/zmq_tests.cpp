@@ -0,0 +1,66 @@
+// Copyright (c) 2025 - Defenwycke - segOP
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <segop/buds.h>
+#include <segop/segop.h>
+#include <test/util/setup_common.h>
+#include <zmq/zmqpublishnotifier.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(zmq_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(zmq_segop_filter_parse)
+{
+    const auto tier{ParseZMQSegopFilter("T2_OPERATIONAL")};
+    BOOST_REQUIRE(tier);
+    BOOST_CHECK(tier->tier == segop::BUDSTier::T2_OPERATIONAL);
+    BOOST_CHECK(!tier->type);
+
+    const auto type{ParseZMQSegopFilter("L2_STATE_ANCHOR")};
+    BOOST_REQUIRE(type);
+    BOOST_CHECK(!type->tier);
+    BOOST_CHECK(type->type == segop::BUDSDataType::L2_STATE_ANCHOR);
+
+    // UNSPECIFIED names both a tier and a data type; the tier is meant.
+    const auto unspecified{ParseZMQSegopFilter("UNSPECIFIED")};
+    BOOST_REQUIRE(unspecified);
+    BOOST_CHECK(unspecified->tier == segop::BUDSTier::UNSPECIFIED);
+    BOOST_CHECK(!unspecified->type);
+
+    BOOST_CHECK(!ParseZMQSegopFilter(""));
+    BOOST_CHECK(!ParseZMQSegopFilter("t2_operational"));
+    BOOST_CHECK(!ParseZMQSegopFilter("T2"));
+    BOOST_CHECK(!ParseZMQSegopFilter("T2_OPERATIONAL "));
+}
+
+BOOST_AUTO_TEST_CASE(zmq_segop_filter_matches)
+{
+    const SegopBUDSInfo anchor{SegopExtractBUDSInfo(BuildSegopBUDSTextPayload(/*T2*/ 0x20, /*L2_STATE_ANCHOR*/ 0x01, "anchor"))};
+    const SegopBUDSInfo note{SegopExtractBUDSInfo(BuildSegopBUDSTextPayload(/*T1*/ 0x10, /*TEXT_NOTE*/ 0x01, "note"))};
+    const SegopBUDSInfo unlabelled{SegopExtractBUDSInfo(BuildSegopTextTlv("unlabelled"))};
+
+    // No filter: everything is published.
+    const ZMQSegopFilter all{};
+    BOOST_CHECK(all.Matches(anchor));
+    BOOST_CHECK(all.Matches(note));
+    BOOST_CHECK(all.Matches(unlabelled));
+
+    const ZMQSegopFilter tier{*ParseZMQSegopFilter("T2_OPERATIONAL")};
+    BOOST_CHECK(tier.Matches(anchor));
+    BOOST_CHECK(!tier.Matches(note));
+    BOOST_CHECK(!tier.Matches(unlabelled));
+
+    const ZMQSegopFilter type{*ParseZMQSegopFilter("TEXT_NOTE")};
+    BOOST_CHECK(!type.Matches(anchor));
+    BOOST_CHECK(type.Matches(note));
+    BOOST_CHECK(!type.Matches(unlabelled));
+
+    const ZMQSegopFilter unspecified{*ParseZMQSegopFilter("UNSPECIFIED")};
+    BOOST_CHECK(!unspecified.Matches(anchor));
+    BOOST_CHECK(!unspecified.Matches(note));
+    BOOST_CHECK(unspecified.Matches(unlabelled));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -15,6 +15,7 @@
 #include <policy/policy.h>
 #include <policy/settings.h>
 #include <random.h>
+#include <segop/segop_store.h>
 #include <tinyformat.h>
 #include <util/check.h>
 #include <util/feefrac.h>
@@ -506,6 +507,15 @@ void CTxMemPool::addNewTransaction(CTxMemPool::txiter newit, CTxMemPool::setEntr
     nTransactionsUpdated++;
     totalTxSize += entry.GetTxSize();
     m_total_fee += entry.GetFee();
+    m_total_segop_size += entry.GetSegopSize();
+    if (!tx.segop_payload.IsNull()) {
+        if (const auto commitment{segop::GetPayloadCommitment(tx)}) {
+            std::vector<Txid>& refs{m_segop_by_commitment[*commitment]};
+            cachedInnerUsage -= memusage::DynamicUsage(refs);
+            refs.push_back(tx.GetHash());
+            cachedInnerUsage += memusage::DynamicUsage(refs);
+        }
+    }
 
     txns_randomized.emplace_back(tx.GetWitnessHash(), newit);
     newit->idx_randomized = txns_randomized.size() - 1;
@@ -557,6 +567,21 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason)
 
     totalTxSize -= it->GetTxSize();
     m_total_fee -= it->GetFee();
+    m_total_segop_size -= it->GetSegopSize();
+    if (!it->GetTx().segop_payload.IsNull()) {
+        if (const auto commitment{segop::GetPayloadCommitment(it->GetTx())}) {
+            const auto refs{m_segop_by_commitment.find(*commitment)};
+            if (refs != m_segop_by_commitment.end()) {
+                cachedInnerUsage -= memusage::DynamicUsage(refs->second);
+                std::erase(refs->second, it->GetTx().GetHash());
+                if (refs->second.empty()) {
+                    m_segop_by_commitment.erase(refs);
+                } else {
+                    cachedInnerUsage += memusage::DynamicUsage(refs->second);
+                }
+            }
+        }
+    }
     cachedInnerUsage -= it->DynamicMemoryUsage();
     cachedInnerUsage -= memusage::DynamicUsage(it->GetMemPoolParentsConst()) + memusage::DynamicUsage(it->GetMemPoolChildrenConst());
     mapTx.erase(it);
@@ -701,6 +726,8 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
 
     uint64_t checkTotal = 0;
     CAmount check_total_fee{0};
+    uint64_t check_total_segop_size{0};
+    size_t check_segop_refs{0};
     uint64_t innerUsage = 0;
     uint64_t prev_ancestor_count{0};
 
@@ -709,6 +736,16 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
     for (const auto& it : GetSortedDepthAndScore()) {
         checkTotal += it->GetTxSize();
         check_total_fee += it->GetFee();
+        check_total_segop_size += it->GetSegopSize();
+        if (const auto commitment{segop::GetPayloadCommitment(it->GetTx())}; commitment && !it->GetTx().segop_payload.IsNull()) {
+            const auto refs{m_segop_by_commitment.find(*commitment)};
+            assert(refs != m_segop_by_commitment.end());
+            assert(std::ranges::count(refs->second, it->GetTx().GetHash()) == 1);
+            // Every transaction carrying the payload shares one buffer.
+            const SegopBytes& first{mapTx.find(refs->second.front())->GetTx().segop_payload.data};
+            assert(it->GetTx().segop_payload.data.data() == first.data() || it->GetTx().segop_payload.data != first.get());
+            ++check_segop_refs;
+        }
         innerUsage += it->DynamicMemoryUsage();
         const CTransaction& tx = it->GetTx();
         innerUsage += memusage::DynamicUsage(it->GetMemPoolParentsConst()) + memusage::DynamicUsage(it->GetMemPoolChildrenConst());
@@ -790,6 +827,12 @@ void CTxMemPool::check(const CCoinsViewCache& active_coins_tip, int64_t spendhei
 
     assert(totalTxSize == checkTotal);
     assert(m_total_fee == check_total_fee);
+    assert(m_total_segop_size == check_total_segop_size);
+    for (const auto& [commitment, txids] : m_segop_by_commitment) {
+        check_segop_refs -= txids.size();
+        innerUsage += memusage::DynamicUsage(txids);
+    }
+    assert(check_segop_refs == 0);
     assert(innerUsage == cachedInnerUsage);
 }
 
@@ -876,6 +919,16 @@ const CTxMemPoolEntry* CTxMemPool::GetEntry(const Txid& txid) const
     return i == mapTx.end() ? nullptr : &(*i);
 }
 
+std::optional<CSegopPayload> CTxMemPool::GetSegopPayload(const uint256& commitment) const
+{
+    LOCK(cs);
+    const auto refs{m_segop_by_commitment.find(commitment)};
+    if (refs == m_segop_by_commitment.end()) return std::nullopt;
+    const auto it{mapTx.find(refs->second.front())};
+    if (it == mapTx.end()) return std::nullopt;
+    return it->GetTx().segop_payload;
+}
+
 CTransactionRef CTxMemPool::get(const Txid& hash) const
 {
     LOCK(cs);
@@ -1044,8 +1097,8 @@ void CCoinsViewMemPool::Reset()
 
 size_t CTxMemPool::DynamicMemoryUsage() const {
     LOCK(cs);
-    // Estimate the overhead of mapTx to be 15 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
-    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 15 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(txns_randomized) + cachedInnerUsage;
+    // Estimate the overhead of mapTx to be 18 pointers + an allocation, as no exact formula for boost::multi_index_contained is implemented.
+    return memusage::MallocUsage(sizeof(CTxMemPoolEntry) + 18 * sizeof(void*)) * mapTx.size() + memusage::DynamicUsage(mapNextTx) + memusage::DynamicUsage(mapDeltas) + memusage::DynamicUsage(txns_randomized) + memusage::DynamicUsage(m_segop_by_commitment) + cachedInnerUsage;
 }
 
 void CTxMemPool::RemoveUnbroadcastTx(const Txid& txid, const bool unchecked) {
@@ -1143,6 +1196,22 @@ void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpends
 
     unsigned nTxnRemoved = 0;
     CFeeRate maxFeeRateRemoved(0);
+    // Bring the segOP lane within its own budget first. Its entry price is
+    // GetSegopMinFee() rather than the rolling minimum fee, so that a flood of
+    // payloads does not raise the feerate needed by other transactions.
+    unsigned nSegopTxnRemoved = 0;
+    while (m_total_segop_size > static_cast<uint64_t>(m_opts.max_segop_size_bytes)) {
+        indexed_transaction_set::index<segop_score>::type::iterator it = mapTx.get<segop_score>().begin();
+        Assume(it->GetSegopSize() > 0);
+        setEntries stage;
+        CalculateDescendants(mapTx.project<0>(it), stage);
+        nSegopTxnRemoved += stage.size();
+        RemoveStagedForSizeLimit(stage, pvNoSpendsRemaining);
+    }
+    if (nSegopTxnRemoved > 0) {
+        LogDebug(BCLog::MEMPOOL, "Removed %u txn to keep the segOP lane within %d bytes\n", nSegopTxnRemoved, m_opts.max_segop_size_bytes);
+    }
+
     while (!mapTx.empty() && DynamicMemoryUsage() > sizelimit) {
         indexed_transaction_set::index<descendant_score>::type::iterator it = mapTx.get<descendant_score>().begin();
 
@@ -1158,27 +1227,50 @@ void CTxMemPool::TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpends
         setEntries stage;
         CalculateDescendants(mapTx.project<0>(it), stage);
         nTxnRemoved += stage.size();
+        RemoveStagedForSizeLimit(stage, pvNoSpendsRemaining);
+    }
 
-        std::vector<CTransaction> txn;
-        if (pvNoSpendsRemaining) {
-            txn.reserve(stage.size());
-            for (txiter iter : stage)
-                txn.push_back(iter->GetTx());
-        }
-        RemoveStaged(stage, false, MemPoolRemovalReason::SIZELIMIT);
-        if (pvNoSpendsRemaining) {
-            for (const CTransaction& tx : txn) {
-                for (const CTxIn& txin : tx.vin) {
-                    if (exists(txin.prevout.hash)) continue;
-                    pvNoSpendsRemaining->push_back(txin.prevout);
-                }
+    if (maxFeeRateRemoved > CFeeRate(0)) {
+        LogDebug(BCLog::MEMPOOL, "Removed %u txn, rolling minimum fee bumped to %s\n", nTxnRemoved, maxFeeRateRemoved.ToString());
+    }
+}
+
+void CTxMemPool::RemoveStagedForSizeLimit(setEntries& stage, std::vector<COutPoint>* pvNoSpendsRemaining)
+{
+    AssertLockHeld(cs);
+
+    std::vector<CTransaction> txn;
+    if (pvNoSpendsRemaining) {
+        txn.reserve(stage.size());
+        for (txiter iter : stage)
+            txn.push_back(iter->GetTx());
+    }
+    RemoveStaged(stage, false, MemPoolRemovalReason::SIZELIMIT);
+    if (pvNoSpendsRemaining) {
+        for (const CTransaction& tx : txn) {
+            for (const CTxIn& txin : tx.vin) {
+                if (exists(txin.prevout.hash)) continue;
+                pvNoSpendsRemaining->push_back(txin.prevout);
             }
         }
     }
+}
 
-    if (maxFeeRateRemoved > CFeeRate(0)) {
-        LogDebug(BCLog::MEMPOOL, "Removed %u txn, rolling minimum fee bumped to %s\n", nTxnRemoved, maxFeeRateRemoved.ToString());
+CFeeRate CTxMemPool::GetSegopMinFee(uint64_t segop_size) const
+{
+    AssertLockHeld(cs);
+    if (segop_size == 0 || m_total_segop_size + segop_size <= static_cast<uint64_t>(m_opts.max_segop_size_bytes)) {
+        return CFeeRate(0);
     }
+    const auto& by_segop_score{mapTx.get<segop_score>()};
+    if (by_segop_score.empty() || by_segop_score.begin()->GetSegopSize() == 0) {
+        // Larger than the whole lane; it will not stay in the mempool anyway.
+        return m_opts.incremental_relay_feerate;
+    }
+    const FeeFrac lowest{CompareTxMemPoolEntryByDescendantScore().GetModFeeAndSize(*by_segop_score.begin())};
+    CFeeRate min_fee(lowest.fee, lowest.size);
+    min_fee += m_opts.incremental_relay_feerate;
+    return min_fee;
 }
 
 uint64_t CTxMemPool::CalculateDescendantMaximum(txiter entry) const {
@@ -1389,7 +1481,21 @@ CTxMemPool::ChangeSet::TxHandle CTxMemPool::ChangeSet::StageAddition(const CTran
 {
     LOCK(m_pool->cs);
     Assume(m_to_add.find(tx->GetHash()) == m_to_add.end());
-    auto newit = m_to_add.emplace(tx, fee, time, entry_height, entry_sequence, spends_coinbase, sigops_cost, lp).first;
+    // A payload already carried by a pool transaction is kept only once: the
+    // entry holds a copy of tx whose payload shares the pool's buffer.
+    CTransactionRef entry_tx{tx};
+    if (!tx->segop_payload.IsNull()) {
+        if (const auto commitment{segop::GetPayloadCommitment(*tx)}) {
+            if (const auto pooled{m_pool->GetSegopPayload(*commitment)};
+                pooled && pooled->data.data() != tx->segop_payload.data.data() && pooled->data == tx->segop_payload.data) {
+                CMutableTransaction mtx{*tx};
+                mtx.segop_payload.data = pooled->data;
+                entry_tx = MakeTransactionRef(std::move(mtx));
+                Assume(entry_tx->GetWitnessHash() == tx->GetWitnessHash());
+            }
+        }
+    }
+    auto newit = m_to_add.emplace(entry_tx, fee, time, entry_height, entry_sequence, spends_coinbase, sigops_cost, lp).first;
     CAmount delta{0};
     m_pool->ApplyDelta(tx->GetHash(), delta);
     if (delta) m_to_add.modify(newit, [&delta](CTxMemPoolEntry& e) { e.UpdateModifiedFee(delta); });
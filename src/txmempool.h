@@ -115,6 +115,23 @@ public:
     }
 };
 
+/** \class CompareTxMemPoolEntryBySegopScore
+ *
+ *  Sort transactions with a segOP payload before all others, and then by
+ *  descendant score, so that the lowest-feerate segOP transaction comes first.
+ */
+class CompareTxMemPoolEntryBySegopScore
+{
+public:
+    bool operator()(const CTxMemPoolEntry& a, const CTxMemPoolEntry& b) const
+    {
+        const bool a_segop{a.GetSegopSize() > 0};
+        const bool b_segop{b.GetSegopSize() > 0};
+        if (a_segop != b_segop) return a_segop;
+        return CompareTxMemPoolEntryByDescendantScore()(a, b);
+    }
+};
+
 /** \class CompareTxMemPoolEntryByScore
  *
  *  Sort by feerate of entry (fee/size) in descending order
@@ -181,6 +198,7 @@ public:
 struct descendant_score {};
 struct entry_time {};
 struct ancestor_score {};
+struct segop_score {};
 struct index_by_wtxid {};
 
 /**
@@ -219,12 +237,13 @@ struct TxMempoolInfo
  *
  * CTxMemPool::mapTx, and CTxMemPoolEntry bookkeeping:
  *
- * mapTx is a boost::multi_index that sorts the mempool on 5 criteria:
+ * mapTx is a boost::multi_index that sorts the mempool on 6 criteria:
  * - transaction hash (txid)
  * - witness-transaction hash (wtxid)
  * - descendant feerate [we use max(feerate of tx, feerate of tx with all descendants)]
  * - time in mempool
  * - ancestor feerate [we use min(feerate of tx, feerate of tx with all unconfirmed ancestors)]
+ * - segOP lane, then descendant feerate [to evict segOP transactions under -maxsegopmempool]
  *
  * Note: the term "descendant" refers to in-mempool transactions that depend on
  * this one, while "ancestor" refers to in-mempool transactions that a given
@@ -285,6 +304,13 @@ protected:
     uint64_t totalTxSize GUARDED_BY(cs){0};      //!< sum of all mempool tx's virtual sizes. Differs from serialized tx size since witness data is discounted. Defined in BIP 141.
     CAmount m_total_fee GUARDED_BY(cs){0};       //!< sum of all mempool tx's fees (NOT modified fee)
     uint64_t cachedInnerUsage GUARDED_BY(cs){0}; //!< sum of dynamic memory usage of all the map elements (NOT the maps themselves)
+    uint64_t m_total_segop_size GUARDED_BY(cs){0}; //!< sum of all mempool tx's segOP payload sizes (the segOP lane)
+    //! Mempool transactions carrying each segOP payload, keyed by P2SOP
+    //! commitment. The same bytes relayed under several txids share one key,
+    //! with one entry (reference) per transaction, and one payload buffer
+    //! (see ChangeSet::StageAddition). The vectors' memory is counted in
+    //! cachedInnerUsage.
+    std::map<uint256, std::vector<Txid>> m_segop_by_commitment GUARDED_BY(cs);
 
     mutable int64_t lastRollingFeeUpdate GUARDED_BY(cs){GetTime()};
     mutable bool blockSinceLastRollingFeeBump GUARDED_BY(cs){false};
@@ -332,6 +358,12 @@ public:
                 boost::multi_index::tag<ancestor_score>,
                 boost::multi_index::identity<CTxMemPoolEntry>,
                 CompareTxMemPoolEntryByAncestorFee
+            >,
+            // segOP transactions first, sorted by fee rate
+            boost::multi_index::ordered_non_unique<
+                boost::multi_index::tag<segop_score>,
+                boost::multi_index::identity<CTxMemPoolEntry>,
+                CompareTxMemPoolEntryBySegopScore
             >
         >
         {};
@@ -581,11 +613,19 @@ public:
     }
 
     /** Remove transactions from the mempool until its dynamic size is <= sizelimit.
+      *  The lowest-feerate segOP transactions are removed first, until the segOP
+      *  lane is within m_opts.max_segop_size_bytes.
       *  pvNoSpendsRemaining, if set, will be populated with the list of outpoints
       *  which are not in mempool which no longer have any spends in this mempool.
       */
     void TrimToSize(size_t sizelimit, std::vector<COutPoint>* pvNoSpendsRemaining = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    /** The minimum feerate for transactions adding segop_size payload bytes to
+      *  the segOP lane: zero while they fit in m_opts.max_segop_size_bytes,
+      *  otherwise above the lowest-feerate segOP transaction they would displace.
+      */
+    CFeeRate GetSegopMinFee(uint64_t segop_size) const EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     /** Expire all transaction (and their dependencies) in the mempool older than time. Return the number of removed transactions. */
     int Expire(std::chrono::seconds time) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
@@ -627,6 +667,15 @@ public:
         return m_total_fee;
     }
 
+    uint64_t GetTotalSegopSize() const EXCLUSIVE_LOCKS_REQUIRED(cs)
+    {
+        AssertLockHeld(cs);
+        return m_total_segop_size;
+    }
+
+    /** The segOP payload committed to by `commitment`, if a mempool transaction carries it. */
+    std::optional<CSegopPayload> GetSegopPayload(const uint256& commitment) const;
+
     bool exists(const Txid& txid) const
     {
         LOCK(cs);
@@ -765,6 +814,8 @@ private:
      *  removal.
      */
     void removeUnchecked(txiter entry, MemPoolRemovalReason reason) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    /** Remove a set of transactions evicted by TrimToSize(), see pvNoSpendsRemaining there. */
+    void RemoveStagedForSizeLimit(setEntries& stage, std::vector<COutPoint>* pvNoSpendsRemaining) EXCLUSIVE_LOCKS_REQUIRED(cs);
 public:
     /** visited marks a CTxMemPoolEntry as having been traversed
      * during the lifetime of the most recently created Epoch::Guard
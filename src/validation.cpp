@@ -43,6 +43,8 @@
 #include <random.h>
 #include <script/script.h>
 #include <script/sigcache.h>
+#include <segop/segop_prune.h>
+#include <segop/segop_store.h>
 #include <signet.h>
 #include <tinyformat.h>
 #include <txdb.h>
@@ -699,8 +701,9 @@ private:
                        std::map<Wtxid, MempoolAcceptResult>& results)
          EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_pool.cs);
 
-    // Compare a package's feerate against minimum allowed.
-    bool CheckFeeRate(size_t package_size, CAmount package_fee, TxValidationState& state) EXCLUSIVE_LOCKS_REQUIRED(::cs_main, m_pool.cs)
+    // Compare a package's feerate against minimum allowed, including the segOP
+    // lane's if the package carries segop_size payload bytes.
+    bool CheckFeeRate(size_t package_size, CAmount package_fee, uint64_t segop_size, TxValidationState& state) EXCLUSIVE_LOCKS_REQUIRED(::cs_main, m_pool.cs)
     {
         AssertLockHeld(::cs_main);
         AssertLockHeld(m_pool.cs);
@@ -709,6 +712,11 @@ private:
             return state.Invalid(TxValidationResult::TX_RECONSIDERABLE, "mempool min fee not met", strprintf("%d < %d", package_fee, mempoolRejectFee));
         }
 
+        const CAmount segop_reject_fee{m_pool.GetSegopMinFee(segop_size).GetFee(package_size)};
+        if (segop_reject_fee > 0 && package_fee < segop_reject_fee) {
+            return state.Invalid(TxValidationResult::TX_RECONSIDERABLE, "segop mempool min fee not met", strprintf("%d < %d", package_fee, segop_reject_fee));
+        }
+
         if (package_fee < m_pool.m_opts.min_relay_feerate.GetFee(package_size)) {
             return state.Invalid(TxValidationResult::TX_RECONSIDERABLE, "min relay fee not met",
                                  strprintf("%d < %d", package_fee, m_pool.m_opts.min_relay_feerate.GetFee(package_size)));
@@ -802,6 +810,11 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     if (!CheckTransaction(tx, state)) {
         return false; // state filled in by CheckTransaction
     }
+    // segOP: the payload rules are context-free, so remember this tx passed
+    // them whether or not it makes it into the mempool.
+    if (!tx.segop_payload.IsNull()) {
+        GetValidationCache().m_segop_check_cache.insert(GetValidationCache().SegopCheckCacheKey(tx));
+    }
 
     // Coinbase is only valid in a block, not as a loose transaction
     if (tx.IsCoinBase())
@@ -958,7 +971,7 @@ bool MemPoolAccept::PreChecks(ATMPArgs& args, Workspace& ws)
     // No individual transactions are allowed below the mempool min feerate except from disconnected
     // blocks and transactions in a package. Package transactions will be checked using package
     // feerate later.
-    if (!bypass_limits && !args.m_package_feerates && !CheckFeeRate(ws.m_vsize, ws.m_modified_fees, state)) return false;
+    if (!bypass_limits && !args.m_package_feerates && !CheckFeeRate(ws.m_vsize, ws.m_modified_fees, tx.segop_payload.data.size(), state)) return false;
 
     ws.m_iters_conflicting = m_pool.GetIterSet(ws.m_conflicts);
 
@@ -1593,9 +1606,11 @@ PackageMempoolAcceptResult MemPoolAccept::AcceptMultipleTransactions(const std::
     all_package_wtxids.reserve(workspaces.size());
     std::transform(workspaces.cbegin(), workspaces.cend(), std::back_inserter(all_package_wtxids),
                    [](const auto& ws) { return ws.m_ptx->GetWitnessHash(); });
+    const uint64_t package_segop_size{std::accumulate(workspaces.cbegin(), workspaces.cend(), uint64_t{0},
+        [](uint64_t sum, auto& ws) { return sum + ws.m_ptx->segop_payload.data.size(); })};
     TxValidationState placeholder_state;
     if (args.m_package_feerates &&
-        !CheckFeeRate(m_subpackage.m_total_vsize, m_subpackage.m_total_modified_fees, placeholder_state)) {
+        !CheckFeeRate(m_subpackage.m_total_vsize, m_subpackage.m_total_modified_fees, package_segop_size, placeholder_state)) {
         package_state.Invalid(PackageValidationResult::PCKG_TX, "transaction failed");
         return PackageMempoolAcceptResult(package_state, {{workspaces.back().m_ptx->GetWitnessHash(),
             MempoolAcceptResult::FeeFailure(placeholder_state, CFeeRate(m_subpackage.m_total_modified_fees, m_subpackage.m_total_vsize), all_package_wtxids)}});
@@ -2106,6 +2121,22 @@ std::optional<std::pair<ScriptError, std::string>> CScriptCheck::operator()() {
     }
 }
 
+std::optional<std::pair<std::string, std::string>> CSegopCheck::operator()() const
+{
+    TxValidationState state;
+    if (CheckSegopPayload(*m_tx, state)) return std::nullopt;
+    return std::make_pair(state.GetRejectReason(), strprintf("Transaction check failed (tx hash %s)", m_tx->GetHash().ToString()));
+}
+
+std::optional<std::pair<std::string, std::string>> CBlockCheck::operator()()
+{
+    if (auto* segop_check = std::get_if<CSegopCheck>(&m_check)) return (*segop_check)();
+    if (auto result = std::get<CScriptCheck>(m_check)()) {
+        return std::make_pair(strprintf("block-script-verify-flag-failed (%s)", ScriptErrorString(result->first)), std::move(result->second));
+    }
+    return std::nullopt;
+}
+
 ValidationCache::ValidationCache(const size_t script_execution_cache_bytes, const size_t signature_cache_bytes)
     : m_signature_cache{signature_cache_bytes}
 {
@@ -2120,6 +2151,21 @@ ValidationCache::ValidationCache(const size_t script_execution_cache_bytes, cons
     const auto [num_elems, approx_size_bytes] = m_script_execution_cache.setup_bytes(script_execution_cache_bytes);
     LogInfo("Using %zu MiB out of %zu MiB requested for script execution cache, able to store %zu elements",
               approx_size_bytes >> 20, script_execution_cache_bytes >> 20, num_elems);
+
+    // segOP: one entry per segOP transaction rather than per (tx, flags), so
+    // a quarter of the script execution cache budget is plenty.
+    const auto [segop_elems, segop_size_bytes] = m_segop_check_cache.setup_bytes(script_execution_cache_bytes / 4);
+    LogInfo("Using %zu MiB for segOP check cache, able to store %zu elements",
+              segop_size_bytes >> 20, segop_elems);
+}
+
+uint256 ValidationCache::SegopCheckCacheKey(const CTransaction& tx) const
+{
+    // The fullxid commits to the payload and every output, i.e. to all the
+    // data the segOP rules look at.
+    uint256 key;
+    ScriptExecutionCacheHasher().Write(UCharCast(tx.GetFullxid().begin()), 32).Finalize(key.begin());
+    return key;
 }
 
 /**
@@ -2400,7 +2446,8 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     // is enforced in ContextualCheckBlockHeader(); we wouldn't want to
     // re-enforce that rule here (at least until we make it impossible for
     // the clock to go backward).
-    if (!CheckBlock(block, state, params.GetConsensus(), !fJustCheck, !fJustCheck)) {
+    if (!CheckBlock(block, state, params.GetConsensus(), !fJustCheck, !fJustCheck, &m_chainman.m_validation_cache, &m_chainman.GetCheckQueue(),
+                    m_chainman.IsSegopPayloadAssumed(*pindex))) {
         if (state.GetResult() == BlockValidationResult::BLOCK_MUTATED) {
             // We don't write down blocks to disk if they may have been
             // corrupted, so this should be impossible unless we're having hardware
@@ -2577,7 +2624,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     // in multiple threads). Preallocate the vector size so a new allocation
     // doesn't invalidate pointers into the vector, and keep txsdata in scope
     // for as long as `control`.
-    std::optional<CCheckQueueControl<CScriptCheck>> control;
+    std::optional<CCheckQueueControl<CBlockCheck>> control;
     if (auto& queue = m_chainman.GetCheckQueue(); queue.HasThreads() && fScriptChecks) control.emplace(queue);
 
     std::vector<PrecomputedTransactionData> txsdata(block.vtx.size());
@@ -2647,7 +2694,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             if (control) {
                 std::vector<CScriptCheck> vChecks;
                 tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache, &vChecks);
-                if (tx_ok) control->Add(std::move(vChecks));
+                if (tx_ok) control->Add(std::vector<CBlockCheck>(std::make_move_iterator(vChecks.begin()), std::make_move_iterator(vChecks.end())));
             } else {
                 tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache);
             }
@@ -2681,7 +2728,7 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
     if (control) {
         auto parallel_result = control->Complete();
         if (parallel_result.has_value() && state.IsValid()) {
-            state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, strprintf("block-script-verify-flag-failed (%s)", ScriptErrorString(parallel_result->first)), parallel_result->second);
+            state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, parallel_result->first, parallel_result->second);
         }
     }
     if (!state.IsValid()) {
@@ -4011,7 +4058,8 @@ static bool CheckWitnessMalleation(const CBlock& block, bool expect_witness_comm
     return true;
 }
 
-bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, bool fCheckMerkleRoot)
+bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW, bool fCheckMerkleRoot,
+                const ValidationCache* validation_cache, CCheckQueue<CBlockCheck>* check_queue, bool segop_assumed)
 {
     // These are checks that are independent of context.
 
@@ -4052,9 +4100,25 @@ bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensu
 
     // Check transactions
     // Must check for duplicate inputs (see CVE-2018-17144)
+    // segOP payload checks are independent per transaction and dominate on
+    // blocks of large payloads, so with a check queue they are handed to its
+    // workers while the remaining checks run here.
+    std::optional<CCheckQueueControl<CBlockCheck>> control;
+    if (check_queue && check_queue->HasThreads()) control.emplace(*check_queue);
+    std::vector<CBlockCheck> segop_checks;
     for (const auto& tx : block.vtx) {
         TxValidationState tx_state;
-        if (!CheckTransaction(*tx, tx_state)) {
+        const bool has_segop{!tx->segop_payload.IsNull()};
+        bool segop_checked{validation_cache && has_segop &&
+                           validation_cache->m_segop_check_cache.contains(validation_cache->SegopCheckCacheKey(*tx), /*erase=*/false)};
+        // A payload stripped below the assumevalid block is assumed to match
+        // its commitment, as scripts there are assumed valid.
+        if (segop_assumed && !has_segop && segop::IsPayloadStripped(*tx)) segop_checked = true;
+        if (control && has_segop && !segop_checked) {
+            segop_checks.emplace_back(CSegopCheck{*tx});
+            segop_checked = true;
+        }
+        if (!CheckTransaction(*tx, tx_state, segop_checked)) {
             // CheckBlock() does context-free validation checks. The only
             // possible failures are consensus failures.
             assert(tx_state.GetResult() == TxValidationResult::TX_CONSENSUS);
@@ -4062,6 +4126,12 @@ bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensu
                                  strprintf("Transaction check failed (tx hash %s) %s", tx->GetHash().ToString(), tx_state.GetDebugMessage()));
         }
     }
+    if (control) {
+        control->Add(std::move(segop_checks));
+        if (auto segop_result = control->Complete()) {
+            return state.Invalid(BlockValidationResult::BLOCK_CONSENSUS, segop_result->first, segop_result->second);
+        }
+    }
     // This underestimates the number of sigops, because unlike ConnectBlock it
     // does not count witness and p2sh sigops.
     unsigned int nSigOps = 0;
@@ -4446,7 +4516,11 @@ bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock,
 
     const CChainParams& params{GetParams()};
 
-    if (!CheckBlock(block, state, params.GetConsensus()) ||
+    // With -reindex the block is re-read from our own block files and is not
+    // marked as stored yet; payloads pruned since it was written are assumed.
+    const bool segop_assumed{IsSegopPayloadAssumed(*pindex) || (dbp && m_blockman.IsSegopPayloadPruned(*dbp, pindex->nHeight))};
+    if (!CheckBlock(block, state, params.GetConsensus(), /*fCheckPOW=*/true, /*fCheckMerkleRoot=*/true, &m_validation_cache, &GetCheckQueue(),
+                    segop_assumed) ||
         !ContextualCheckBlock(block, state, *this, pindex->pprev)) {
         if (Assume(state.IsInvalid())) {
             ActiveChainstate().InvalidBlockFound(pindex, state);
@@ -4512,7 +4586,9 @@ bool ChainstateManager::ProcessNewBlock(const std::shared_ptr<const CBlock>& blo
         // malleability that cause CheckBlock() to fail; see e.g. CVE-2012-2459 and
         // https://lists.linuxfoundation.org/pipermail/bitcoin-dev/2019-February/016697.html.  Because CheckBlock() is
         // not very expensive, the anti-DoS benefits of caching failure (of a definitely-invalid block) are not substantial.
-        bool ret = CheckBlock(*block, state, GetConsensus());
+        const CBlockIndex* known_index{m_blockman.LookupBlockIndex(block->GetHash())};
+        bool ret = CheckBlock(*block, state, GetConsensus(), /*fCheckPOW=*/true, /*fCheckMerkleRoot=*/true, &m_validation_cache, &GetCheckQueue(),
+                              /*segop_assumed=*/known_index && IsSegopPayloadAssumed(*known_index));
         if (ret) {
             // Store to disk
             ret = AcceptBlock(block, state, &pindex, force_processing, nullptr, new_block, min_pow_checked);
@@ -4746,7 +4822,9 @@ VerifyDBResult CVerifyDB::VerifyDB(
             return VerifyDBResult::CORRUPTED_BLOCK_DB;
         }
         // check level 1: verify block validity
-        if (nCheckLevel >= 1 && !CheckBlock(block, state, consensus_params)) {
+        if (nCheckLevel >= 1 && !CheckBlock(block, state, consensus_params, /*fCheckPOW=*/true, /*fCheckMerkleRoot=*/true,
+                                            /*validation_cache=*/nullptr, /*check_queue=*/nullptr,
+                                            /*segop_assumed=*/chainstate.m_chainman.IsSegopPayloadAssumed(*pindex))) {
             LogPrintf("Verification error: found bad block at %d, hash=%s (%s)\n",
                       pindex->nHeight, pindex->GetBlockHash().ToString(), state.ToString());
             return VerifyDBResult::CORRUPTED_BLOCK_DB;
@@ -5099,6 +5177,11 @@ void ChainstateManager::LoadExternalBlockFile(
                         pblock = std::make_shared<CBlock>();
                         blkdat >> TX_WITH_WITNESS(*pblock);
                         nRewind = blkdat.GetPos();
+                        // Payloads that have been pruned stay stripped; AcceptBlock()
+                        // assumes them, as they were checked when first stored.
+                        if (dbp && m_blockman.m_segop_store && m_blockman.m_segop_store->IsStrippedBlock(*dbp)) {
+                            m_blockman.m_segop_store->AttachPayloads(*pblock);
+                        }
 
                         BlockValidationState state;
                         if (AcceptBlock(pblock, state, nullptr, true, dbp, nullptr, true)) {
@@ -5206,6 +5289,23 @@ bool ChainstateManager::ShouldCheckBlockIndex() const
     return true;
 }
 
+bool ChainstateManager::IsSegopPayloadAssumed(const CBlockIndex& index) const
+{
+    AssertLockHeld(cs_main);
+    if (m_blockman.IsSegopPayloadPruned(index)) return true;
+    if (!m_options.segop_light_ibd || AssumedValidBlock().IsNull() || !m_best_header) return false;
+    const auto it{m_blockman.m_block_index.find(AssumedValidBlock())};
+    if (it == m_blockman.m_block_index.end()) return false;
+    // The same conditions under which ConnectBlock() skips script checks.
+    if (it->second.GetAncestor(index.nHeight) != &index ||
+        m_best_header->GetAncestor(index.nHeight) != &index ||
+        m_best_header->nChainWork < MinimumChainWork() ||
+        GetBlockProofEquivalentTime(*m_best_header, index, *m_best_header, GetConsensus()) <= 60 * 60 * 24 * 7 * 2) {
+        return false;
+    }
+    return !segop::IsInValidationWindow(m_best_header->nHeight, index.nHeight);
+}
+
 void ChainstateManager::CheckBlockIndex() const
 {
     if (!ShouldCheckBlockIndex()) {
@@ -47,6 +47,7 @@
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 class Chainstate;
@@ -358,6 +359,40 @@ static_assert(std::is_nothrow_move_assignable_v<CScriptCheck>);
 static_assert(std::is_nothrow_move_constructible_v<CScriptCheck>);
 static_assert(std::is_nothrow_destructible_v<CScriptCheck>);
 
+/** segOP: closure representing the payload rules (CheckSegopPayload) of one transaction. */
+class CSegopCheck
+{
+private:
+    const CTransaction* m_tx;
+
+public:
+    explicit CSegopCheck(const CTransaction& tx) : m_tx(&tx) {}
+
+    //! Returns the reject reason and debug message on failure.
+    std::optional<std::pair<std::string, std::string>> operator()() const;
+};
+
+/**
+ * A job for the block validation check queue: either an input script or a
+ * segOP payload, so both share the script-check worker threads.
+ */
+class CBlockCheck
+{
+private:
+    std::variant<CScriptCheck, CSegopCheck> m_check;
+
+public:
+    explicit CBlockCheck(CScriptCheck&& check) noexcept : m_check(std::move(check)) {}
+    explicit CBlockCheck(CSegopCheck check) noexcept : m_check(check) {}
+
+    //! Returns the reject reason and debug message on failure.
+    std::optional<std::pair<std::string, std::string>> operator()();
+};
+
+static_assert(std::is_nothrow_move_assignable_v<CBlockCheck>);
+static_assert(std::is_nothrow_move_constructible_v<CBlockCheck>);
+static_assert(std::is_nothrow_destructible_v<CBlockCheck>);
+
 /**
  * Convenience class for initializing and passing the script execution cache
  * and signature cache.
@@ -371,6 +406,10 @@ private:
 public:
     CuckooCache::cache<uint256, SignatureCacheHasher> m_script_execution_cache;
     SignatureCache m_signature_cache;
+    //! segOP: salted fullxids of transactions that passed the segOP rules in
+    //! CheckTransaction (see SegopCheckCacheKey). Like the script execution
+    //! cache, only accessed under cs_main.
+    CuckooCache::cache<uint256, SignatureCacheHasher> m_segop_check_cache;
 
     ValidationCache(size_t script_execution_cache_bytes, size_t signature_cache_bytes);
 
@@ -379,12 +418,21 @@ public:
 
     //! Return a copy of the pre-initialized hasher.
     CSHA256 ScriptExecutionCacheHasher() const { return m_script_execution_cache_hasher; }
+
+    //! segOP: the m_segop_check_cache entry for a transaction.
+    uint256 SegopCheckCacheKey(const CTransaction& tx) const;
 };
 
 /** Functions for validating blocks and updating the block tree */
 
-/** Context-independent validity checks */
-bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckMerkleRoot = true);
+/** Context-independent validity checks. With a validation_cache, the segOP
+ *  checks of transactions already validated in the mempool are skipped; with
+ *  a check_queue, the remaining ones run on its worker threads. With
+ *  segop_assumed (see ChainstateManager::IsSegopPayloadAssumed()),
+ *  transactions whose payloads were stripped are accepted on their P2SOP
+ *  commitments alone. */
+bool CheckBlock(const CBlock& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, bool fCheckMerkleRoot = true,
+                const ValidationCache* validation_cache = nullptr, CCheckQueue<CBlockCheck>* check_queue = nullptr, bool segop_assumed = false);
 
 /**
  * Verify a block, including transactions.
@@ -977,7 +1025,7 @@ private:
     }
 
     //! A queue for script verifications that have to be performed by worker threads.
-    CCheckQueue<CScriptCheck> m_script_check_queue;
+    CCheckQueue<CBlockCheck> m_script_check_queue;
 
     //! Timers and counters used for benchmarking validation in both background
     //! and active chainstates.
@@ -1008,6 +1056,19 @@ public:
     bool ShouldCheckBlockIndex() const;
     const arith_uint256& MinimumChainWork() const { return *Assert(m_options.minimum_chain_work); }
     const uint256& AssumedValidBlock() const { return *Assert(m_options.assumed_valid_block); }
+    /**
+     * Whether the block at `index` may be downloaded and accepted without its
+     * segOP payloads (-segoplightibd). Like the skipping of script checks in
+     * ConnectBlock(), this applies to blocks buried under the assumevalid
+     * block in the best header chain, and never within the segOP validation
+     * window of the best header.
+     *
+     * It also applies to stored blocks whose payloads have since been pruned
+     * (-segopprune): their payloads were checked against their commitments
+     * before the block was first written, so reconnecting them in a reorg or
+     * with -reindex-chainstate must not fail on the missing payloads.
+     */
+    bool IsSegopPayloadAssumed(const CBlockIndex& index) const EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
     kernel::Notifications& GetNotifications() const { return m_options.notifications; };
 
     /**
@@ -1335,7 +1396,7 @@ public:
     //! header in our block-index not known to be invalid, recalculate it.
     void RecalculateBestHeader() EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
-    CCheckQueue<CScriptCheck>& GetCheckQueue() { return m_script_check_queue; }
+    CCheckQueue<CBlockCheck>& GetCheckQueue() { return m_script_check_queue; }
 
     ~ChainstateManager();
 };
@@ -117,6 +117,9 @@ public:
     std::optional<uint32_t> m_locktime;
     //! Caps weight of resulting tx
     std::optional<int> m_max_tx_weight{std::nullopt};
+    //! segOP payload to attach, counted in the transaction's size during coin selection.
+    //! The P2SOP output committing to it must be among the recipients.
+    std::optional<CSegopPayload> m_segop_payload;
 
     CCoinControl();
 
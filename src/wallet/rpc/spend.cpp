@@ -15,6 +15,7 @@
 #include <script/script.h>
 #include <util/rbf.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 #include <util/translation.h>
 #include <util/vector.h>
 #include <wallet/coincontrol.h>
@@ -657,6 +658,11 @@ RPCHelpMan segopsend()
 
             std::vector<CRecipient> recipients{CreateRecipients(ParseOutputs(address_amounts), sffo_set)};
 
+            // The P2SOP output and the payload are part of the funded transaction,
+            // so that coin selection pays for their weight.
+            recipients.push_back({CNoDestination{BuildP2SopScript(segop_payload)}, CAmount{0}, /*fSubtractFeeFromAmount=*/false});
+            coin_control.m_segop_payload = segop_payload;
+
             // Fund the transaction using the shared helper. mtx.vout is still empty here,
             // which matches FundTransaction's assertion requirements.
             auto res = FundTransaction(*pwallet, mtx, recipients,
@@ -673,15 +679,6 @@ RPCHelpMan segopsend()
             // Start from the funded (but unsigned) transaction
             CMutableTransaction mtx_signed(*txr.tx);
 
-            // Append P2SOP OP_RETURN output (0-value) AFTER funding
-            if (use_p2sop) {
-                CScript p2sop_script = BuildP2SopScript(segop_payload);
-                mtx_signed.vout.emplace_back(CAmount{0}, std::move(p2sop_script));
-            }
-
-            // Attach segOP lane AFTER funding so we don't break FundTransaction's assumptions
-            mtx_signed.segop_payload = segop_payload;
-
             // Sign the transaction in-place
             if (!pwallet->SignTransaction(mtx_signed)) {
                 throw JSONRPCError(RPC_WALLET_ERROR, "Failed to sign segOP transaction");
@@ -710,6 +707,221 @@ RPCHelpMan segopsend()
 }
 
 
+RPCHelpMan segopsendmany()
+{
+    return RPCHelpMan{
+        "segopsendmany",
+        "Publish several segOP payloads, one transaction per payload, in a single call.\n"
+        "Each transaction carries one payload and its P2SOP commitment, and pays for the payload's\n"
+        "weight in coin selection. All transactions are built and signed under one wallet lock\n"
+        "before any of them is broadcast, so a failure to build one leaves nothing sent.\n"
+        "If one is not accepted to the mempool, it is abandoned, those after it are not sent,\n"
+        "and the error lists the transactions already broadcast.\n"
+        "With \"chained\", each transaction spends the change of the one before it, so a single\n"
+        "wallet coin can fund the whole batch; the batch must then fit the mempool ancestor limit.\n"
+        "Otherwise every transaction spends its own wallet coins.\n"
+        + HELP_REQUIRING_PASSPHRASE,
+        {
+            {"payloads", RPCArg::Type::ARR, RPCArg::Optional::NO,
+             "The segOP payloads, as strings. Interpretation is controlled by \"options.encoding\".",
+             {
+                 {"payload", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "A segOP payload"},
+             },
+            },
+            {"options", RPCArg::Type::OBJ, RPCArg::Optional::OMITTED, "",
+             {
+                 {"encoding", RPCArg::Type::STR, RPCArg::Default{"text"},
+                  "Payload encoding, for every payload: \"text\", \"json\" or \"hex\"."},
+                 {"version", RPCArg::Type::NUM, RPCArg::Default{1},
+                  "segOP version 1-255, for every payload."},
+                 {"chained", RPCArg::Type::BOOL, RPCArg::Default{false},
+                  "Spend the change of each transaction in the next one."},
+                 {"replaceable", RPCArg::Type::BOOL, RPCArg::DefaultHint{"wallet default"},
+                  "Mark the transactions BIP125 replaceable."},
+                 {"conf_target", RPCArg::Type::NUM, RPCArg::DefaultHint{"wallet -txconfirmtarget"}, "Confirmation target in blocks"},
+                 {"estimate_mode", RPCArg::Type::STR, RPCArg::Default{"unset"}, "The fee estimate mode, must be one of (case insensitive):\n"
+                  + FeeModesDetail(std::string("economical mode is used if the transaction is replaceable;\notherwise, conservative mode is used"))},
+                 {"fee_rate", RPCArg::Type::AMOUNT, RPCArg::DefaultHint{"not set, falls back to wallet fee estimation"}, "Specify a fee rate in " + CURRENCY_ATOM + "/vB."},
+             },
+            },
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::ARR, "txids", "The transaction ids, in the order of the payloads.",
+                 {
+                     {RPCResult::Type::STR_HEX, "", "The transaction id."},
+                 }},
+                {RPCResult::Type::STR_AMOUNT, "fee", "The total fee paid in " + CURRENCY_UNIT},
+            }
+        },
+        RPCExamples{
+            "\nPublish two text payloads, each funded from its own coins:\n"
+            + HelpExampleCli("segopsendmany", "'[\"first note\",\"second note\"]'") +
+            "\nPublish two hex payloads as a chain at 2 " + CURRENCY_ATOM + "/vB:\n"
+            + HelpExampleCli("segopsendmany", "'[\"534754\",\"455354\"]' '{\"encoding\":\"hex\",\"chained\":true,\"fee_rate\":2}'")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+        {
+            std::shared_ptr<CWallet> const pwallet = GetWalletForJSONRPCRequest(request);
+            if (!pwallet) return UniValue::VNULL;
+
+            pwallet->BlockUntilSyncedToCurrentChain();
+
+            const UniValue& payloads{request.params[0].get_array()};
+            if (payloads.empty()) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "payloads must not be empty");
+            }
+            const UniValue options{request.params[1].isNull() ? UniValue{UniValue::VOBJ} : request.params[1].get_obj()};
+            RPCTypeCheckObj(options,
+                {
+                    {"encoding", UniValueType(UniValue::VSTR)},
+                    {"version", UniValueType(UniValue::VNUM)},
+                    {"chained", UniValueType(UniValue::VBOOL)},
+                    {"replaceable", UniValueType(UniValue::VBOOL)},
+                    {"conf_target", UniValueType(UniValue::VNUM)},
+                    {"estimate_mode", UniValueType(UniValue::VSTR)},
+                    {"fee_rate", UniValueType()}, // will be checked by AmountFromValue() in SetFeeEstimateMode()
+                },
+                /*fAllowNull=*/true, /*fStrict=*/true);
+            const bool chained{options.exists("chained") && options["chained"].get_bool()};
+
+            // Only the encoding and version are shared; the encodings that take
+            // their data from the options rather than the payload string are not
+            // meaningful here.
+            UniValue payload_options(UniValue::VOBJ);
+            if (options.exists("encoding")) {
+                const std::string& encoding{options["encoding"].get_str()};
+                if (encoding != "text" && encoding != "json" && encoding != "hex") {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, "Unsupported segOP encoding for segopsendmany: " + encoding);
+                }
+                payload_options.pushKV("encoding", encoding);
+            }
+            if (options.exists("version")) payload_options.pushKV("version", options["version"]);
+
+            std::vector<CSegopPayload> segop_payloads(payloads.size());
+            for (size_t i = 0; i < payloads.size(); ++i) {
+                std::string segop_error;
+                if (!BuildSegopPayloadFromRequest(payloads[i].get_str(), payload_options, segop_payloads[i], segop_error)) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("payloads[%d]: %s", i, segop_error));
+                }
+            }
+
+            if (chained) {
+                unsigned int limit_ancestor_count{0};
+                unsigned int limit_descendant_count{0};
+                pwallet->chain().getPackageLimits(limit_ancestor_count, limit_descendant_count);
+                const unsigned int limit{std::min(limit_ancestor_count, limit_descendant_count)};
+                if (payloads.size() > limit) {
+                    throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("A chain of %d transactions exceeds the mempool chain limit of %d", payloads.size(), limit));
+                }
+            }
+
+            LOCK(pwallet->cs_wallet);
+            EnsureWalletIsUnlocked(*pwallet);
+
+            CCoinControl coin_control;
+            if (options.exists("replaceable")) {
+                coin_control.m_signal_bip125_rbf = options["replaceable"].get_bool();
+            }
+            SetFeeEstimateMode(*pwallet, coin_control, options["conf_target"], options["estimate_mode"], options["fee_rate"], /*override_min_fee=*/false);
+
+            // Build and sign every transaction before committing any. Inputs
+            // are locked in memory as they are spent so that the next coin
+            // selection does not pick them again, and unlocked once all
+            // transactions are committed or one of them fails.
+            std::vector<CTransactionRef> txs;
+            std::vector<COutPoint> locked;
+            std::map<COutPoint, Coin> batch_coins; // Change outputs of the batch, for signing chained spends
+            std::optional<COutPoint> prev_change;
+            CAmount total_fee{0};
+            std::string error;
+            for (size_t i = 0; i < segop_payloads.size() && error.empty(); ++i) {
+                CCoinControl tx_control{coin_control};
+                tx_control.m_segop_payload = segop_payloads[i];
+                if (prev_change) {
+                    const CTxOut& change{batch_coins.at(*prev_change).out};
+                    tx_control.Select(*prev_change).SetTxOut(change);
+                    tx_control.SetInputWeight(*prev_change, CalculateMaximumSignedInputSize(change, pwallet.get(), /*coin_control=*/nullptr) * WITNESS_SCALE_FACTOR);
+                }
+                const std::vector<CRecipient> recipients{{CNoDestination{BuildP2SopScript(segop_payloads[i])}, CAmount{0}, /*fSubtractFeeFromAmount=*/false}};
+                auto res{CreateTransaction(*pwallet, recipients, /*change_pos=*/std::nullopt, tx_control, /*sign=*/false)};
+                if (!res) {
+                    error = strprintf("payloads[%d]: %s", i, util::ErrorString(res).original);
+                    break;
+                }
+
+                // Sign now, so that the txid the next transaction spends from is final.
+                CMutableTransaction mtx{*res->tx};
+                std::map<COutPoint, Coin> coins;
+                for (const CTxIn& txin : mtx.vin) {
+                    pwallet->LockCoin(txin.prevout, /*persist=*/false);
+                    locked.push_back(txin.prevout);
+                    if (const auto it{batch_coins.find(txin.prevout)}; it != batch_coins.end()) {
+                        coins.emplace(*it);
+                    } else if (const auto txo{pwallet->GetTXO(txin.prevout)}) {
+                        coins.emplace(txin.prevout, Coin{txo->GetTxOut(), /*nHeightIn=*/0, txo->GetWalletTx().IsCoinBase()});
+                    }
+                }
+                std::map<int, bilingual_str> input_errors;
+                if (!pwallet->SignTransaction(mtx, coins, SIGHASH_DEFAULT, input_errors)) {
+                    error = strprintf("payloads[%d]: Failed to sign segOP transaction", i);
+                    break;
+                }
+                const CTransactionRef tx{MakeTransactionRef(std::move(mtx))};
+                prev_change.reset();
+                if (res->change_pos) {
+                    const COutPoint change_outpoint{tx->GetHash(), *res->change_pos};
+                    batch_coins.emplace(change_outpoint, Coin{tx->vout[*res->change_pos], /*nHeightIn=*/0, /*fCoinBaseIn=*/false});
+                    if (chained) prev_change = change_outpoint;
+                }
+                total_fee += res->fee;
+                txs.push_back(tx);
+            }
+
+            // Parents come before children, so commit in batch order, and
+            // stop at the first transaction the mempool does not take: the
+            // ones after it may spend its change.
+            std::vector<std::string> broadcast;
+            if (error.empty()) {
+                for (size_t i = 0; i < txs.size(); ++i) {
+                    const Txid& txid{txs[i]->GetHash()};
+                    try {
+                        pwallet->CommitTransaction(txs[i], /*mapValue=*/{}, /*orderForm=*/{});
+                    } catch (const std::runtime_error& e) {
+                        error = strprintf("payloads[%d]: %s", i, e.what());
+                        break;
+                    }
+                    if (pwallet->GetBroadcastTransactions() && !pwallet->GetWalletTx(txid)->InMempool()) {
+                        pwallet->AbandonTransaction(txid);
+                        error = strprintf("payloads[%d]: Transaction %s was not accepted to the mempool and was abandoned", i, txid.GetHex());
+                        break;
+                    }
+                    broadcast.push_back(txid.GetHex());
+                }
+                if (!error.empty()) {
+                    error += broadcast.empty() ? ". No transaction was broadcast" : ". Already broadcast: " + util::Join(broadcast, ", ");
+                }
+            }
+            for (const COutPoint& outpoint : locked) {
+                pwallet->UnlockCoin(outpoint);
+            }
+            if (!error.empty()) {
+                throw JSONRPCError(RPC_WALLET_ERROR, error);
+            }
+
+            UniValue txids(UniValue::VARR);
+            for (const CTransactionRef& tx : txs) {
+                txids.push_back(tx->GetHash().GetHex());
+            }
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("txids", std::move(txids));
+            result.pushKV("fee", ValueFromAmount(total_fee));
+            return result;
+        }
+    };
+}
+
 ////////////////
 RPCHelpMan sendmany()
 {
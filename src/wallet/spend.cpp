@@ -158,6 +158,13 @@ TxSize CalculateMaximumSignedTxSize(const CTransaction &tx, const CWallet *walle
     // Add the size of the transaction outputs.
     for (const auto& txo : tx.vout) weight += GetSerializeSize(txo) * WITNESS_SCALE_FACTOR;
 
+    // The segOP marker and payload are not witness data and count in full,
+    // as do the extended-format dummy and flag that announce them.
+    if (!tx.segop_payload.IsNull()) {
+        weight += (1 + GetSerializeSize(tx.segop_payload)) * WITNESS_SCALE_FACTOR;
+        weight += 2 * WITNESS_SCALE_FACTOR - (is_segwit ? 2 : 0);
+    }
+
     // Add the size of the transaction inputs as if they were signed.
     for (uint32_t i = 0; i < txouts.size(); i++) {
         const auto txin_weight = GetSignedTxinWeight(wallet, coin_control, tx.vin[i], txouts[i], is_segwit, wallet->CanGrindR());
@@ -1057,6 +1064,7 @@ static util::Result<CreatedTransactionResult> CreateTransactionInternal(
     CMutableTransaction txNew; // The resulting transaction that we make
 
     txNew.version = coin_control.m_version;
+    if (coin_control.m_segop_payload) txNew.segop_payload = *coin_control.m_segop_payload;
 
     CoinSelectionParams coin_selection_params{rng_fast}; // Parameters for coin selection, init with dummy
     coin_selection_params.m_avoid_partial_spends = coin_control.m_avoid_partial_spends;
@@ -1071,6 +1079,11 @@ static util::Result<CreatedTransactionResult> CreateTransactionInternal(
     coin_selection_params.m_long_term_feerate = wallet.m_consolidate_feerate;
     // Static vsize overhead + outputs vsize. 4 nVersion, 4 nLocktime, 1 input count, 1 witness overhead (dummy, flag, stack size)
     coin_selection_params.tx_noinputs_size = 10 + GetSizeOfCompactSize(vecSend.size()); // bytes for output count
+    // The segOP marker and payload are not witness data, so they count in full,
+    // as do the extended-format dummy and flag that announce them.
+    if (!txNew.segop_payload.IsNull()) {
+        coin_selection_params.tx_noinputs_size += 2 + 1 + GetSerializeSize(txNew.segop_payload);
+    }
 
     CAmount recipients_sum = 0;
     const OutputType change_type = wallet.TransactionChangeType(coin_control.m_change_type ? *coin_control.m_change_type : wallet.m_default_change_type, vecSend);
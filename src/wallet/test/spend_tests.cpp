@@ -4,7 +4,9 @@
 
 #include <consensus/amount.h>
 #include <policy/fees.h>
+#include <policy/policy.h>
 #include <script/solver.h>
+#include <segop/segop.h>
 #include <validation.h>
 #include <wallet/coincontrol.h>
 #include <wallet/spend.h>
@@ -61,6 +63,34 @@ BOOST_FIXTURE_TEST_CASE(SubtractFee, TestChain100Setup)
     BOOST_CHECK_EQUAL(fee, check_tx(fee + 123));
 }
 
+BOOST_FIXTURE_TEST_CASE(segop_payload_fee, TestChain100Setup)
+{
+    CreateAndProcessBlock({}, GetScriptForRawPubKey(coinbaseKey.GetPubKey()));
+    auto wallet = CreateSyncedWallet(*m_node.chain, WITH_LOCK(Assert(m_node.chainman)->GetMutex(), return m_node.chainman->ActiveChain()), coinbaseKey);
+
+    // The payload is not witness data: coin selection must pay for all of its
+    // weight, not just for the P2SOP output that commits to it.
+    CSegopPayload payload;
+    payload.version = CSegopPayload::SEGOP_VERSION;
+    payload.data = BuildSegopTextTlv(std::string(10'000, 'x'));
+    const CFeeRate feerate{10'000};
+    CCoinControl coin_control;
+    coin_control.m_feerate = feerate;
+    coin_control.fOverrideFeeRate = true;
+    coin_control.m_segop_payload = payload;
+    const CRecipient p2sop{CNoDestination{CScript() << OP_RETURN << BuildSegopCommitmentBlob(payload.data)}, 0, /*subtract_fee=*/false};
+    auto res = CreateTransaction(*wallet, {p2sop}, /*change_pos=*/std::nullopt, coin_control);
+    BOOST_REQUIRE(res);
+    const CTransaction& tx{*res->tx};
+    BOOST_CHECK(tx.segop_payload.data == payload.data);
+    // The estimate used for the fee must match the signed transaction exactly,
+    // down to the extended-format and segOP marker bytes.
+    const int64_t vsize{GetVirtualTransactionSize(tx)};
+    BOOST_CHECK_GT(vsize, 10'000);
+    BOOST_CHECK_EQUAL(WITH_LOCK(wallet->cs_wallet, return CalculateMaximumSignedTxSize(tx, wallet.get(), &coin_control).vsize), vsize);
+    BOOST_CHECK_EQUAL(res->fee, feerate.GetFee(vsize));
+}
+
 BOOST_FIXTURE_TEST_CASE(wallet_duplicated_preset_inputs_test, TestChain100Setup)
 {
     // Verify that the wallet's Coin Selection process does not include pre-selected inputs twice in a transaction.
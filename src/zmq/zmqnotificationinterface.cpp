@@ -50,6 +50,14 @@ std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(std
     };
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
     factories["pubsequence"] = CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>;
+    // The filter has been checked in AppInitParameterInteraction().
+    const ZMQSegopFilter segop_filter{ParseZMQSegopFilter(gArgs.GetArg("-zmqsegopfilter", "")).value_or(ZMQSegopFilter{})};
+    factories["pubhashsegop"] = [&segop_filter]() -> std::unique_ptr<CZMQAbstractNotifier> {
+        return std::make_unique<CZMQPublishHashSegopNotifier>(segop_filter);
+    };
+    factories["pubrawsegop"] = [&segop_filter]() -> std::unique_ptr<CZMQAbstractNotifier> {
+        return std::make_unique<CZMQPublishRawSegopNotifier>(segop_filter);
+    };
 
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
     for (const auto& entry : factories)
@@ -15,6 +15,7 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/server.h>
+#include <segop/segop.h>
 #include <serialize.h>
 #include <streams.h>
 #include <sync.h>
@@ -23,6 +24,7 @@
 
 #include <zmq.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdarg>
 #include <cstddef>
@@ -44,6 +46,8 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_HASHSEGOP = "hashsegop";
+static const char *MSG_RAWSEGOP  = "rawsegop";
 static const char *MSG_SEQUENCE  = "sequence";
 
 // Internal function to send multipart message
@@ -261,6 +265,47 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
 
+bool ZMQSegopFilter::Matches(const SegopBUDSInfo& info) const
+{
+    return (!tier || info.tier == *tier) && (!type || info.type == *type);
+}
+
+std::optional<ZMQSegopFilter> ParseZMQSegopFilter(std::string_view name)
+{
+    // Tier names are tried first, so UNSPECIFIED selects unlabelled payloads.
+    if (const auto tier{segop::BUDSTierFromString(name)}) return ZMQSegopFilter{.tier = tier};
+    if (const auto type{segop::BUDSDataTypeFromString(name)}) return ZMQSegopFilter{.type = type};
+    return std::nullopt;
+}
+
+bool CZMQAbstractSegopNotifier::SendSegopMsg(const char* command, const CTransaction& transaction, bool with_payload)
+{
+    if (transaction.segop_payload.IsNull()) return true;
+    const SegopBUDSInfo info{SegopExtractBUDSInfo(transaction.segop_payload.data)};
+    if (!m_filter.Matches(info)) return true;
+
+    const uint256& txid{transaction.GetHash().ToUint256()};
+    const uint256& fullxid{transaction.GetFullxid().ToUint256()};
+    LogDebug(BCLog::ZMQ, "Publish %s %s to %s\n", command, txid.GetHex(), this->address);
+    std::vector<unsigned char> data(2 * uint256::size() + 2);
+    std::reverse_copy(txid.begin(), txid.end(), data.begin());
+    std::reverse_copy(fullxid.begin(), fullxid.end(), data.begin() + uint256::size());
+    data[2 * uint256::size()] = static_cast<uint8_t>(info.tier);
+    data[2 * uint256::size() + 1] = static_cast<uint8_t>(info.type);
+    if (with_payload) data.insert(data.end(), transaction.segop_payload.data.begin(), transaction.segop_payload.data.end());
+    return SendZmqMessage(command, data.data(), data.size());
+}
+
+bool CZMQPublishHashSegopNotifier::NotifyTransaction(const CTransaction &transaction)
+{
+    return SendSegopMsg(MSG_HASHSEGOP, transaction, /*with_payload=*/false);
+}
+
+bool CZMQPublishRawSegopNotifier::NotifyTransaction(const CTransaction &transaction)
+{
+    return SendSegopMsg(MSG_RAWSEGOP, transaction, /*with_payload=*/true);
+}
+
 // Helper function to send a 'sequence' topic message with the following structure:
 //    <32-byte hash> | <1-byte label> | <8-byte LE sequence> (optional)
 static bool SendSequenceMsg(CZMQAbstractPublishNotifier& notifier, uint256 hash, char label, std::optional<uint64_t> sequence = {})
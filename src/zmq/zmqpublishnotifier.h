@@ -5,15 +5,30 @@
 #ifndef BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
 #define BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H
 
+#include <segop/buds.h>
 #include <zmq/zmqabstractnotifier.h>
 
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <optional>
+#include <string_view>
 #include <vector>
 
 class CBlockIndex;
 class CTransaction;
+struct SegopBUDSInfo;
+
+/** Restricts the segOP notifiers to one BUDS tier or data type (-zmqsegopfilter). */
+struct ZMQSegopFilter {
+    std::optional<segop::BUDSTier> tier{};
+    std::optional<segop::BUDSDataType> type{};
+
+    bool Matches(const SegopBUDSInfo& info) const;
+};
+
+/** Parse a BUDS tier name (e.g. T2_OPERATIONAL) or data type name (e.g. L2_STATE_ANCHOR); nullopt if it is neither. */
+std::optional<ZMQSegopFilter> ParseZMQSegopFilter(std::string_view name);
 
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 {
@@ -63,6 +78,35 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+/** Publishes transactions that carry a segOP payload and pass the filter. */
+class CZMQAbstractSegopNotifier : public CZMQAbstractPublishNotifier
+{
+private:
+    const ZMQSegopFilter m_filter;
+
+protected:
+    /* Publish <32-byte txid> | <32-byte fullxid> | <1-byte BUDS tier> | <1-byte BUDS data type>,
+       followed by the payload bytes if `with_payload` */
+    bool SendSegopMsg(const char* command, const CTransaction& transaction, bool with_payload);
+
+public:
+    explicit CZMQAbstractSegopNotifier(ZMQSegopFilter filter) : m_filter{std::move(filter)} {}
+};
+
+class CZMQPublishHashSegopNotifier : public CZMQAbstractSegopNotifier
+{
+public:
+    using CZMQAbstractSegopNotifier::CZMQAbstractSegopNotifier;
+    bool NotifyTransaction(const CTransaction &transaction) override;
+};
+
+class CZMQPublishRawSegopNotifier : public CZMQAbstractSegopNotifier
+{
+public:
+    using CZMQAbstractSegopNotifier::CZMQAbstractSegopNotifier;
+    bool NotifyTransaction(const CTransaction &transaction) override;
+};
+
 class CZMQPublishSequenceNotifier : public CZMQAbstractPublishNotifier
 {
 public:
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 - Defenwycke - segOP
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test -segoplightibd.
+
+- A node signalling NODE_SOP_RECENT serves blocks without their segOP
+  payloads on request (MSG_WITNESS_BLOCK_NO_SEGOP).
+- A node running -segoplightibd downloads blocks buried under its
+  -assumevalid block that way, and stores them stripped.
+- After a restart, without -segoplightibd, the stripped blocks are
+  reconnected from disk (-reindex-chainstate): the node knows their
+  payloads were never stored and does not take them for invalid.
+"""
+
+from test_framework.messages import (
+    CBlock,
+    CInv,
+    MSG_BLOCK,
+    MSG_WITNESS_BLOCK_NO_SEGOP,
+    MSG_WITNESS_FLAG,
+    NODE_SOP_RECENT,
+    from_hex,
+    msg_getdata,
+)
+from test_framework.p2p import P2PInterface
+from test_framework.segop import (
+    p2sop_script,
+    segop_text_payload,
+    send_segop_tx,
+)
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_not_equal,
+)
+from test_framework.wallet import MiniWallet
+
+# Blocks must be buried by more than two weeks worth of work under the
+# -assumevalid block for their payloads to be assumed.
+BURY_DEPTH = 2100
+
+
+class SegopLightIBDTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.num_nodes = 2
+        # nodes[0] looks payloads up through -txindex, so it serves them.
+        self.extra_args = [["-txindex"], []]
+
+    def setup_network(self):
+        self.setup_nodes()
+
+    def find_tx(self, block, txid):
+        return next(tx for tx in block.vtx if tx.txid_hex == txid)
+
+    def run_test(self):
+        node = self.nodes[0]
+        wallet = MiniWallet(node)
+
+        self.log.info("Mine a segOP transaction and bury it under the future -assumevalid block")
+        payload = segop_text_payload("light ibd")
+        txid = send_segop_tx(node, wallet, payload)["txid"]
+        segop_block = self.generate(node, 1, sync_fun=self.no_op)[0]
+        tip = self.generate(node, BURY_DEPTH, sync_fun=self.no_op)[-1]
+        assert_not_equal(int(node.getnetworkinfo()["localservices"], 16) & NODE_SOP_RECENT, 0)
+
+        self.test_stripped_block_request(segop_block, txid, payload)
+        self.test_light_ibd(segop_block, txid, tip)
+
+    def test_stripped_block_request(self, segop_block, txid, payload):
+        self.log.info("Test that a block is served without its segOP payloads on request")
+        peer = self.nodes[0].add_p2p_connection(P2PInterface())
+        for inv_type, expected in [(MSG_WITNESS_BLOCK_NO_SEGOP, b""), (MSG_BLOCK | MSG_WITNESS_FLAG, payload)]:
+            peer.send_and_ping(msg_getdata([CInv(inv_type, int(segop_block, 16))]))
+            peer.wait_for_block(int(segop_block, 16))
+            tx = self.find_tx(peer.last_message["block"].block, txid)
+            assert_equal(tx.segop.data, expected)
+            # The P2SOP commitment stays in the block either way.
+            assert p2sop_script(payload) in [txout.scriptPubKey for txout in tx.vout]
+            del peer.last_message["block"]
+        self.nodes[0].disconnect_p2ps()
+
+    def test_light_ibd(self, segop_block, txid, tip):
+        self.log.info("Test that a -segoplightibd node downloads buried blocks without their segOP payloads")
+        node = self.nodes[1]
+        self.restart_node(1, extra_args=["-segoplightibd", f"-assumevalid={tip}", "-segopvalidationwindow=6"])
+        # Blocks are only known to be buried once the headers up to the
+        # -assumevalid block are, which takes more than one headers message.
+        for height in range(node.getblockcount() + 1, self.nodes[0].getblockcount() + 1):
+            node.submitheader(self.nodes[0].getblockheader(self.nodes[0].getblockhash(height), False))
+        self.connect_nodes(1, 0)
+        self.sync_blocks(timeout=240)
+        block = from_hex(CBlock(), node.getblock(segop_block, 0))
+        assert_equal(block.hash_hex, segop_block)
+        assert self.find_tx(block, txid).segop.is_null()
+
+        self.log.info("Test that the stripped blocks are reconnected across a restart, without -segoplightibd")
+        self.restart_node(1, extra_args=["-segopprune", "-reindex-chainstate"])
+        self.wait_until(lambda: node.getbestblockhash() == tip, timeout=240)
+        assert_equal([chaintip["status"] for chaintip in node.getchaintips()], ["active"])
+        block = from_hex(CBlock(), node.getblock(segop_block, 0))
+        assert self.find_tx(block, txid).segop.is_null()
+
+
+if __name__ == '__main__':
+    SegopLightIBDTest(__file__).main()
@@ -17,6 +17,13 @@ from test_framework.messages import (
     BLOCK_HEADER_SIZE,
     COIN,
     deser_block_spent_outputs,
+    ser_compact_size,
+)
+from test_framework.segop import (
+    BUDS_TIER_T2,
+    BUDS_TYPE_T2_L2_STATE_ANCHOR,
+    segop_text_payload,
+    send_segop_tx,
 )
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import (
@@ -472,5 +479,73 @@ class RESTTest (BitcoinTestFramework):
         resp = self.test_rest_request(f"/deploymentinfo/{INVALID_PARAM}", ret_type=RetType.OBJ, status=400)
         assert_equal(resp.read().decode('utf-8').rstrip(), f"Invalid hash: {INVALID_PARAM}")
 
+        self.test_segop()
+
+    def test_segop(self):
+        self.log.info("Test the /segop and /blocksegop URIs")
+        # Payloads leave the retention window E = max(W, R) = 6 blocks after
+        # being mined and small sop files roll over quickly.
+        self.restart_node(0, extra_args=["-rest", "-txindex", "-segopprune", "-segopvalidationwindow=6", "-segopoperatorwindow=0", "-fastprune"])
+        node = self.nodes[0]
+
+        def segop_record(txid, version, payload):
+            return bytes.fromhex(txid)[::-1] + bytes([version]) + ser_compact_size(len(payload)) + payload
+
+        payload = segop_text_payload("segOP over REST", tier=BUDS_TIER_T2, data_type=BUDS_TYPE_T2_L2_STATE_ANCHOR)
+        txid = send_segop_tx(node, self.wallet, payload)["txid"]
+
+        json_obj = self.test_rest_request(f"/segop/{txid}")
+        assert_equal(json_obj["txid"], txid)
+        assert_equal(len(json_obj["fullxid"]), 64)
+        assert_equal(json_obj["version"], 1)
+        assert_equal(json_obj["size"], len(payload))
+        assert_equal(json_obj["buds_tier"], "T2_OPERATIONAL")
+        assert_equal(json_obj["buds_type"], "L2_STATE_ANCHOR")
+        assert_equal(json_obj["hex"], payload.hex())
+        record = segop_record(txid, 1, payload)
+        assert_equal(self.test_rest_request(f"/segop/{txid}", req_type=ReqType.BIN, ret_type=RetType.BYTES), record)
+        assert_equal(self.test_rest_request(f"/segop/{txid}", req_type=ReqType.HEX, ret_type=RetType.BYTES).decode().rstrip(), record.hex())
+
+        blockhash = self.generate(self.wallet, 1, sync_fun=self.no_op)[0]
+        assert_equal(self.test_rest_request(f"/segop/{txid}"), json_obj)
+        assert_equal(self.test_rest_request(f"/blocksegop/{blockhash}"), [json_obj])
+        assert_equal(self.test_rest_request(f"/blocksegop/{blockhash}", req_type=ReqType.BIN, ret_type=RetType.BYTES), record)
+        assert_equal(self.test_rest_request(f"/blocksegop/{blockhash}", req_type=ReqType.HEX, ret_type=RetType.BYTES).decode().rstrip(), record.hex())
+
+        self.log.info("Test the /segop and /blocksegop URIs with unknown or invalid data")
+        plain_txid = self.wallet.send_self_transfer(from_node=node)["txid"]
+        resp = self.test_rest_request(f"/segop/{plain_txid}", ret_type=RetType.OBJ, status=404)
+        assert_equal(resp.read().decode('utf-8').rstrip(), f"{plain_txid} has no segOP payload")
+        for uri in ("/segop", "/blocksegop"):
+            resp = self.test_rest_request(f"{uri}/{UNKNOWN_PARAM}", ret_type=RetType.OBJ, status=404)
+            assert_equal(resp.read().decode('utf-8').rstrip(), f"{UNKNOWN_PARAM} not found")
+            resp = self.test_rest_request(f"{uri}/{INVALID_PARAM}", ret_type=RetType.OBJ, status=400)
+            assert_equal(resp.read().decode('utf-8').rstrip(), f"Invalid hash: {INVALID_PARAM}")
+        # A block without segOP transactions has no records
+        empty_blockhash = self.generate(self.wallet, 1, sync_fun=self.no_op)[0]
+        assert_equal(self.test_rest_request(f"/blocksegop/{empty_blockhash}"), [])
+        assert_equal(self.test_rest_request(f"/blocksegop/{empty_blockhash}", req_type=ReqType.BIN, ret_type=RetType.BYTES), b"")
+
+        self.log.info("Test the /segop and /blocksegop URIs with a pruned payload")
+        # Two large payloads do not fit into one 64 KiB -fastprune sop file,
+        # so the first one's file is wholly below the retention window once
+        # it has been left behind.
+        pruned_txid = send_segop_tx(node, self.wallet, segop_text_payload("p" * 40000))["txid"]
+        pruned_blockhash = self.generate(self.wallet, 1, sync_fun=self.no_op)[0]
+        send_segop_tx(node, self.wallet, segop_text_payload("r" * 40000))
+        self.generate(self.wallet, 7, sync_fun=self.no_op)
+        node.syncwithvalidationinterfacequeue()
+
+        pruned_json = {"txid": pruned_txid, "pruned": True}
+        assert_equal(self.test_rest_request(f"/segop/{pruned_txid}"), pruned_json)
+        assert_equal(self.test_rest_request(f"/blocksegop/{pruned_blockhash}"), [pruned_json])
+        # Written as the null payload: version 0 and no bytes
+        pruned_record = segop_record(pruned_txid, 0, b"")
+        assert_equal(self.test_rest_request(f"/segop/{pruned_txid}", req_type=ReqType.BIN, ret_type=RetType.BYTES), pruned_record)
+        assert_equal(self.test_rest_request(f"/blocksegop/{pruned_blockhash}", req_type=ReqType.BIN, ret_type=RetType.BYTES), pruned_record)
+        assert_equal(self.test_rest_request(f"/blocksegop/{pruned_blockhash}", req_type=ReqType.HEX, ret_type=RetType.BYTES).decode().rstrip(), pruned_record.hex())
+        # The earlier payload shared the pruned file
+        assert_equal(self.test_rest_request(f"/segop/{txid}"), {"txid": txid, "pruned": True})
+
 if __name__ == '__main__':
     RESTTest(__file__).main()
@@ -33,6 +33,14 @@ from test_framework.wallet import (
     MiniWallet,
 )
 from test_framework.netutil import test_ipv6_local, test_unix_socket
+from test_framework.segop import (
+    BUDS_TIER_T1,
+    BUDS_TIER_T2,
+    BUDS_TYPE_T1_TEXT_NOTE,
+    BUDS_TYPE_T2_L2_STATE_ANCHOR,
+    segop_text_payload,
+    send_segop_tx,
+)
 
 
 # Test may be skipped and not have zmq installed
@@ -130,6 +138,7 @@ class ZMQTest (BitcoinTestFramework):
             self.test_reorg()
             self.test_multiple_interfaces()
             self.test_ipv6()
+            self.test_segop()
         finally:
             # Destroy the ZMQ context.
             self.log.debug("Destroying ZMQ context")
@@ -572,6 +581,68 @@ class ZMQTest (BitcoinTestFramework):
         assert_equal(self.nodes[0].getbestblockhash(), subscribers[0].receive().hex())
         assert_equal(self.nodes[0].getbestblockhash(), subscribers[1].receive().hex())
 
+    # Restart node with the segOP notifications enabled and subscribe to both.
+    # Only segOP transactions are published on these topics, so the "sync up"
+    # procedure of setup_zmq_test() is done with segOP transactions carrying
+    # `sync_payload` instead of blocks.
+    def setup_segop_zmq_test(self, address, sync_payload, extra_args=[]):
+        subscribers = [ZMQSubscriber(self.ctx.socket(zmq.SUB), topic) for topic in (b"hashsegop", b"rawsegop")]
+        self.restart_node(0, [f"-zmqpubhashsegop={address}", f"-zmqpubrawsegop={address}"] + extra_args)
+        for sub in subscribers:
+            sub.socket.connect(address)
+            sub.socket.set(zmq.RCVTIMEO, 1000)
+        while True:
+            txid = send_segop_tx(self.nodes[0], self.wallet, sync_payload)["txid"]
+            try:
+                for sub in subscribers:
+                    while sub.receive()[:32][::-1].hex() != txid:
+                        self.log.debug("Ignoring sync-up notification for previously sent transaction.")
+                break
+            except zmq.error.Again:
+                self.log.debug("Didn't receive sync-up notification, trying again.")
+        for sub in subscribers:
+            sub.socket.set(zmq.RCVTIMEO, 60000)
+        return subscribers
+
+    def test_segop(self):
+        self.log.info("Testing 'hashsegop' and 'rawsegop' publishers")
+        address = f"tcp://127.0.0.1:{self.zmq_port_base}"
+        anchor = segop_text_payload("anchor", tier=BUDS_TIER_T2, data_type=BUDS_TYPE_T2_L2_STATE_ANCHOR)
+        note = segop_text_payload("note", tier=BUDS_TIER_T1, data_type=BUDS_TYPE_T1_TEXT_NOTE)
+        hashsegop, rawsegop = self.setup_segop_zmq_test(address, anchor)
+
+        # Plain transactions are not published on the segOP topics.
+        self.wallet.send_self_transfer(from_node=self.nodes[0])
+        for payload, tier, data_type in ((note, 1, 0x11), (anchor, 2, 0x21)):
+            txid = send_segop_tx(self.nodes[0], self.wallet, payload)["txid"]
+            # <txid><fullxid><1-byte tier><1-byte type>, both hashes reversed
+            # as for the other topics, and the payload for rawsegop
+            body = hashsegop.receive()
+            assert_equal(len(body), 32 + 32 + 2)
+            assert_equal(body[:32][::-1].hex(), txid)
+            assert body[32:64] != body[:32]
+            assert_equal(body[64:], bytes([tier, data_type]))
+            assert_equal(rawsegop.receive(), body + payload)
+        # Published again when mined, as for hashtx and rawtx
+        segop_txids = [txid for txid, entry in self.nodes[0].getrawmempool(verbose=True).items() if "segop" in entry]
+        self.generatetoaddress(self.nodes[0], 1, ADDRESS_BCRT1_UNSPENDABLE, sync_fun=self.no_op)
+        mined = [hashsegop.receive()[:32][::-1].hex() for _ in segop_txids]
+        assert_equal(sorted(mined), sorted(segop_txids))
+
+        self.log.info("Testing -zmqsegopfilter")
+        hashsegop, rawsegop = self.setup_segop_zmq_test(address, anchor, ["-zmqsegopfilter=T2_OPERATIONAL"])
+        send_segop_tx(self.nodes[0], self.wallet, note)
+        txid = send_segop_tx(self.nodes[0], self.wallet, anchor)["txid"]
+        # The T1 note is skipped on both topics.
+        assert_equal(hashsegop.receive()[:32][::-1].hex(), txid)
+        assert_equal(rawsegop.receive()[:32][::-1].hex(), txid)
+        hashsegop, rawsegop = self.setup_segop_zmq_test(address, note, ["-zmqsegopfilter=TEXT_NOTE"])
+        send_segop_tx(self.nodes[0], self.wallet, anchor)
+        txid = send_segop_tx(self.nodes[0], self.wallet, note)["txid"]
+        assert_equal(hashsegop.receive()[:32][::-1].hex(), txid)
+        assert_equal(rawsegop.receive()[:32][::-1].hex(), txid)
+        self.restart_node(0)
+
     def test_ipv6(self):
         if not test_ipv6_local():
             self.log.info("Skipping IPv6 test, because IPv6 is not supported.")
@@ -13,6 +13,8 @@ from test_framework.messages import (
     MSG_BLOCK,
     NODE_NETWORK_LIMITED,
     NODE_P2P_V2,
+    NODE_SOP_ARCHIVE,
+    NODE_SOP_RECENT,
     NODE_WITNESS,
     msg_getdata,
 )
@@ -46,7 +48,7 @@ class NodeNetworkLimitedTest(BitcoinTestFramework):
     def set_test_params(self):
         self.setup_clean_chain = True
         self.num_nodes = 3
-        self.extra_args = [['-prune=550'], [], []]
+        self.extra_args = [['-prune=550'], ['-txindex'], []]
 
     def disconnect_all(self):
         self.disconnect_nodes(0, 1)
@@ -128,6 +130,11 @@ class NodeNetworkLimitedTest(BitcoinTestFramework):
         self.log.info("Check that the localservices is as expected.")
         assert_equal(int(self.nodes[0].getnetworkinfo()['localservices'], 16), expected_services)
 
+        self.log.info("Check that only a node that can look up confirmed segOP payloads signals serving them.")
+        sop_services = NODE_SOP_RECENT | NODE_SOP_ARCHIVE
+        assert_equal(int(self.nodes[1].getnetworkinfo()['localservices'], 16) & sop_services, sop_services)
+        assert_equal(int(self.nodes[2].getnetworkinfo()['localservices'], 16) & NODE_SOP_ARCHIVE, 0)
+
         self.log.info("Mine enough blocks to reach the NODE_NETWORK_LIMITED range.")
         self.connect_nodes(0, 1)
         blocks = self.generate(self.nodes[1], 292, sync_fun=lambda: self.sync_blocks([self.nodes[0], self.nodes[1]]))
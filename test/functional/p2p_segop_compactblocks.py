@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 - Defenwycke - segOP
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test compact blocks whose transactions arrive without their segOP payloads.
+
+A reconstructed compact block lacking segOP payloads is held back while
+they are fetched with getsegopdata from peers signalling NODE_SOP_RECENT:
+- once they arrive in a segopdata message, the block is connected;
+- if they do not arrive within SEGOP_BLOCK_PAYLOAD_TIMEOUT, the block is
+  downloaded in full instead;
+- without a peer that could serve them, the block is downloaded in full
+  right away.
+"""
+import copy
+import time
+
+from test_framework.blocktools import (
+    add_witness_commitment,
+    create_block,
+    create_coinbase,
+)
+from test_framework.messages import (
+    CBlock,
+    CSegopPayload,
+    CTxOut,
+    HeaderAndShortIDs,
+    MSG_BLOCK,
+    MSG_WITNESS_FLAG,
+    NODE_SOP_RECENT,
+    SegopDataEntry,
+    from_hex,
+    msg_cmpctblock,
+    msg_segopdata,
+    tx_from_hex,
+)
+from test_framework.p2p import (
+    P2P_SERVICES,
+    P2PDataStore,
+    p2p_lock,
+)
+from test_framework.segop import (
+    p2sop_script,
+    segop_text_payload,
+)
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal
+from test_framework.wallet import MiniWallet
+
+# Must match SEGOP_BLOCK_PAYLOAD_TIMEOUT in net_processing.cpp
+SEGOP_BLOCK_PAYLOAD_TIMEOUT = 60
+
+
+class SegopCompactBlocksTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+
+    def run_test(self):
+        self.wallet = MiniWallet(self.nodes[0])
+        self.generate(self.wallet, 110)
+
+        self.test_fetch_payloads()
+        self.test_fetch_timeout()
+        self.test_no_payload_peer()
+
+    def build_segop_block(self, text):
+        """A block confirming a segOP transaction that is not in the node's mempool."""
+        node = self.nodes[0]
+        payload = segop_text_payload(text)
+        tx = self.wallet.create_self_transfer()["tx"]
+        tx.vout.append(CTxOut(0, p2sop_script(payload)))
+        tx = tx_from_hex(node.createsegoptx(tx.serialize().hex(), payload.hex())["hex"])
+        assert_equal(tx.segop.data, payload)
+
+        tip = node.getblock(node.getbestblockhash())
+        block = create_block(int(tip["hash"], 16), create_coinbase(tip["height"] + 1), tip["time"] + 1, txlist=[tx])
+        add_witness_commitment(block)
+        block.solve()
+        return block
+
+    def send_stripped_cmpctblock(self, peer, block):
+        """Announce `block` as a compact block prefilling its segOP transaction without the payload."""
+        stripped = copy.deepcopy(block)
+        stripped.vtx[1].segop = CSegopPayload()
+        cmpct = HeaderAndShortIDs()
+        cmpct.initialize_from_block(stripped, prefill_list=[0, 1], use_witness=True)
+        peer.block_store[block.hash_int] = block
+        peer.send_and_ping(msg_cmpctblock(cmpct.to_p2p()))
+
+    def check_block_payload(self, block):
+        node = self.nodes[0]
+        assert_equal(node.getbestblockhash(), block.hash_hex)
+        connected = from_hex(CBlock(), node.getblock(block.hash_hex, 0))
+        assert_equal(connected.vtx[1].segop.data, block.vtx[1].segop.data)
+
+    def test_fetch_payloads(self):
+        self.log.info("Test that missing segOP payloads are fetched with getsegopdata and the block connected")
+        node = self.nodes[0]
+        peer = node.add_p2p_connection(P2PDataStore(), services=P2P_SERVICES | NODE_SOP_RECENT)
+        block = self.build_segop_block("fetched")
+        self.send_stripped_cmpctblock(peer, block)
+
+        peer.wait_until(lambda: "getsegopdata" in peer.last_message)
+        with p2p_lock:
+            assert_equal(peer.last_message["getsegopdata"].txids, [block.vtx[1].txid_int])
+        # The block is held back, and was not requested in full.
+        assert node.getbestblockhash() != block.hash_hex
+        assert "getdata" not in peer.last_message
+
+        peer.send_and_ping(msg_segopdata([SegopDataEntry(block.vtx[1].txid_int, block.vtx[1].segop)]))
+        self.check_block_payload(block)
+        node.disconnect_p2ps()
+
+    def test_fetch_timeout(self):
+        self.log.info("Test that a block whose segOP payloads do not arrive in time is downloaded in full")
+        node = self.nodes[0]
+        peer = node.add_p2p_connection(P2PDataStore(), services=P2P_SERVICES | NODE_SOP_RECENT)
+        block = self.build_segop_block("timed out")
+        self.send_stripped_cmpctblock(peer, block)
+
+        peer.wait_until(lambda: "getsegopdata" in peer.last_message)
+        assert node.getbestblockhash() != block.hash_hex
+        assert "getdata" not in peer.last_message
+        node.setmocktime(int(time.time()) + SEGOP_BLOCK_PAYLOAD_TIMEOUT + 1)
+        peer.wait_for_getdata([block.hash_int])
+        with p2p_lock:
+            assert_equal(peer.last_message["getdata"].inv[0].type, MSG_BLOCK | MSG_WITNESS_FLAG)
+        self.wait_until(lambda: node.getbestblockhash() == block.hash_hex)
+        self.check_block_payload(block)
+        node.disconnect_p2ps()
+
+    def test_no_payload_peer(self):
+        self.log.info("Test that a block is downloaded in full right away if no peer can serve its segOP payloads")
+        node = self.nodes[0]
+        peer = node.add_p2p_connection(P2PDataStore())
+        block = self.build_segop_block("unavailable")
+        self.send_stripped_cmpctblock(peer, block)
+
+        peer.wait_for_getdata([block.hash_int])
+        self.wait_until(lambda: node.getbestblockhash() == block.hash_hex)
+        assert "getsegopdata" not in peer.last_message
+        self.check_block_payload(block)
+        node.disconnect_p2ps()
+
+
+if __name__ == '__main__':
+    SegopCompactBlocksTest(__file__).main()
@@ -2,12 +2,16 @@
 # Copyright (c) 2014-2021 The Bitcoin Core developers
 # Distributed under the MIT software license, see the accompanying
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
-"""Test gettxoutproof and verifytxoutproof RPCs."""
+"""Test gettxoutproof and verifytxoutproof RPCs, and their segOP counterparts getsegopproof and verifysegopproof."""
 
 from test_framework.messages import (
     CMerkleBlock,
     from_hex,
 )
+from test_framework.segop import (
+    segop_text_payload,
+    send_segop_tx,
+)
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import (
     assert_equal,
@@ -22,7 +26,7 @@ class MerkleBlockTest(BitcoinTestFramework):
         self.num_nodes = 2
         self.extra_args = [
             [],
-            ["-txindex"],
+            ["-txindex", "-segopindex"],
         ]
 
     def run_test(self):
@@ -109,5 +113,45 @@ class MerkleBlockTest(BitcoinTestFramework):
         # TODO: try more variants, eg transactions at different depths, and
         # verify that the proofs are invalid
 
+        self.test_segop_proof(miniwallet)
+
+    def test_segop_proof(self, miniwallet):
+        self.log.info("Test getsegopproof and verifysegopproof")
+        # Only nodes[1] runs -segopindex; nodes[0] computes the segOP root from the block.
+        segop_txids = [send_segop_tx(self.nodes[0], miniwallet, segop_text_payload(f"proof {i}"))["txid"] for i in range(3)]
+        plain_txid = miniwallet.send_self_transfer(from_node=self.nodes[0])["txid"]
+        blockhash = self.generate(self.nodes[0], 1)[0]
+        self.wait_until(lambda: self.nodes[1].getindexinfo("segopindex")["segopindex"]["synced"])
+
+        # Round trip, between and within nodes with and without the index
+        for prover in self.nodes:
+            proof = prover.getsegopproof([segop_txids[0]])
+            for verifier in self.nodes:
+                leaves = verifier.verifysegopproof(proof)
+                assert_equal([leaf["txid"] for leaf in leaves], [segop_txids[0]])
+        proof = self.nodes[0].getsegopproof(segop_txids[:2], blockhash)
+        leaves = self.nodes[1].verifysegopproof(proof)
+        assert_equal(sorted(leaf["txid"] for leaf in leaves), sorted(segop_txids[:2]))
+        assert_equal(self.nodes[0].verifysegopproof(proof), leaves)
+
+        # Transactions without a segOP payload have no leaf
+        assert_raises_rpc_error(-5, "Not all segOP transactions found in specified or retrieved block", self.nodes[0].getsegopproof, [plain_txid], blockhash)
+        assert_raises_rpc_error(-8, "Parameter 'txids' cannot be empty", self.nodes[0].getsegopproof, [])
+
+        # A proof whose matched commitment or partial tree was tampered with proves nothing
+        proof = bytes.fromhex(self.nodes[0].getsegopproof([segop_txids[0]]))
+        tweaked_commitment = proof[:-1] + bytes([proof[-1] ^ 1])
+        # The first hash of the partial tree follows the header, the leaf count and the hash count.
+        tweaked_tree = proof[:85] + bytes([proof[85] ^ 1]) + proof[86:]
+        for tweaked in (tweaked_commitment, tweaked_tree):
+            for n in self.nodes:
+                assert_equal(n.verifysegopproof(tweaked.hex()), [])
+
+        # A block without segOP transactions cannot be proven against
+        empty_blockhash = self.generate(self.nodes[0], 1)[0]
+        coinbase_txid = self.nodes[0].getblock(empty_blockhash)["tx"][0]
+        for n in self.nodes:
+            assert_raises_rpc_error(-5, "Block has no segOP transactions to prove", n.getsegopproof, [coinbase_txid], empty_blockhash)
+
 if __name__ == '__main__':
     MerkleBlockTest(__file__).main()
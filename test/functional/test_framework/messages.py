@@ -56,15 +56,20 @@ NODE_WITNESS = (1 << 3)
 NODE_COMPACT_FILTERS = (1 << 6)
 NODE_NETWORK_LIMITED = (1 << 10)
 NODE_P2P_V2 = (1 << 11)
+NODE_SOP_RECENT = (1 << 24)
+NODE_SOP_ARCHIVE = (1 << 25)
 
 MSG_TX = 1
 MSG_BLOCK = 2
 MSG_FILTERED_BLOCK = 3
 MSG_CMPCT_BLOCK = 4
 MSG_WTX = 5
+MSG_SOPDATA = 0x53
+MSG_SEGOP_STRIPPED_FLAG = 1 << 29
 MSG_WITNESS_FLAG = 1 << 30
 MSG_TYPE_MASK = 0xffffffff >> 2
 MSG_WITNESS_TX = MSG_TX | MSG_WITNESS_FLAG
+MSG_WITNESS_BLOCK_NO_SEGOP = MSG_BLOCK | MSG_WITNESS_FLAG | MSG_SEGOP_STRIPPED_FLAG
 
 FILTER_TYPE_BASIC = 0
 
@@ -408,6 +413,8 @@ class CInv:
         MSG_FILTERED_BLOCK: "filtered Block",
         MSG_CMPCT_BLOCK: "CompactBlock",
         MSG_WTX: "WTX",
+        MSG_SOPDATA: "SopData",
+        MSG_WITNESS_BLOCK_NO_SEGOP: "WitnessBlockNoSegop",
     }
 
     def __init__(self, t=0, h=0):
@@ -592,8 +599,32 @@ class CTxWitness:
         return True
 
 
+class CSegopPayload:
+    __slots__ = ("data", "version")
+
+    def __init__(self, version=0, data=b""):
+        self.version = version
+        self.data = data
+
+    def deserialize(self, f):
+        self.version = int.from_bytes(f.read(1), "little")
+        self.data = deser_string(f)
+
+    def serialize(self):
+        r = b""
+        r += self.version.to_bytes(1, "little")
+        r += ser_string(self.data)
+        return r
+
+    def is_null(self):
+        return self.version == 0 and len(self.data) == 0
+
+    def __repr__(self):
+        return "CSegopPayload(version=%i data=%s)" % (self.version, self.data.hex())
+
+
 class CTransaction:
-    __slots__ = ("nLockTime", "version", "vin", "vout", "wit")
+    __slots__ = ("nLockTime", "segop", "version", "vin", "vout", "wit")
 
     def __init__(self, tx=None):
         if tx is None:
@@ -601,6 +632,7 @@ class CTransaction:
             self.vin = []
             self.vout = []
             self.wit = CTxWitness()
+            self.segop = CSegopPayload()
             self.nLockTime = 0
         else:
             self.version = tx.version
@@ -608,6 +640,7 @@ class CTransaction:
             self.vout = copy.deepcopy(tx.vout)
             self.nLockTime = tx.nLockTime
             self.wit = copy.deepcopy(tx.wit)
+            self.segop = copy.deepcopy(tx.segop)
 
     def deserialize(self, f):
         self.version = int.from_bytes(f.read(4), "little")
@@ -622,11 +655,15 @@ class CTransaction:
                 self.vout = deser_vector(f, CTxOut)
         else:
             self.vout = deser_vector(f, CTxOut)
-        if flags != 0:
+        if flags & 1:
             self.wit.vtxinwit = [CTxInWitness() for _ in range(len(self.vin))]
             self.wit.deserialize(f)
         else:
             self.wit = CTxWitness()
+        self.segop = CSegopPayload()
+        if flags & 2:
+            assert_equal(f.read(1), b"\x53")
+            self.segop.deserialize(f)
         self.nLockTime = int.from_bytes(f.read(4), "little")
 
     def serialize_without_witness(self):
@@ -637,11 +674,15 @@ class CTransaction:
         r += self.nLockTime.to_bytes(4, "little")
         return r
 
-    # Only serialize with witness when explicitly called for
-    def serialize_with_witness(self):
+    # Only serialize with witness when explicitly called for. The segOP
+    # payload, if any, goes along with the witness unless `with_segop` is
+    # unset, as for the wtxid.
+    def serialize_with_witness(self, *, with_segop=True):
         flags = 0
         if not self.wit.is_null():
             flags |= 1
+        if with_segop and not self.segop.is_null():
+            flags |= 2
         r = b""
         r += self.version.to_bytes(4, "little")
         if flags:
@@ -657,6 +698,9 @@ class CTransaction:
                 for _ in range(len(self.wit.vtxinwit), len(self.vin)):
                     self.wit.vtxinwit.append(CTxInWitness())
             r += self.wit.serialize()
+        if flags & 2:
+            r += b"\x53"
+            r += self.segop.serialize()
         r += self.nLockTime.to_bytes(4, "little")
         return r
 
@@ -668,12 +712,12 @@ class CTransaction:
     @property
     def wtxid_hex(self):
         """Return wtxid (transaction hash with witness) as hex string."""
-        return hash256(self.serialize())[::-1].hex()
+        return hash256(self.serialize_with_witness(with_segop=False))[::-1].hex()
 
     @property
     def wtxid_int(self):
         """Return wtxid (transaction hash with witness) as integer."""
-        return uint256_from_str(hash256(self.serialize_with_witness()))
+        return uint256_from_str(hash256(self.serialize_with_witness(with_segop=False)))
 
     @property
     def txid_hex(self):
@@ -692,10 +736,16 @@ class CTransaction:
         return True
 
     # Calculate the transaction weight using witness and non-witness
-    # serialization size (does NOT use sigops).
+    # serialization size (does NOT use sigops). The segOP payload is not
+    # discounted: it counts towards the non-witness size.
     def get_weight(self):
         with_witness_size = len(self.serialize_with_witness())
-        without_witness_size = len(self.serialize_without_witness())
+        if self.segop.is_null():
+            without_witness_size = len(self.serialize_without_witness())
+        else:
+            no_witness = CTransaction(self)
+            no_witness.wit = CTxWitness()
+            without_witness_size = len(no_witness.serialize_with_witness())
         return (WITNESS_SCALE_FACTOR - 1) * without_witness_size + with_witness_size
 
     def get_vsize(self):
@@ -1906,6 +1956,62 @@ class msg_sendtxrcncl:
         return "msg_sendtxrcncl(version=%lu, salt=%lu)" %\
             (self.version, self.salt)
 
+class SegopDataEntry:
+    __slots__ = ("payload", "txid")
+
+    def __init__(self, txid=0, payload=None):
+        self.txid = txid
+        self.payload = payload if payload is not None else CSegopPayload()
+
+    def deserialize(self, f):
+        self.txid = deser_uint256(f)
+        self.payload = CSegopPayload()
+        self.payload.deserialize(f)
+
+    def serialize(self):
+        r = b""
+        r += ser_uint256(self.txid)
+        r += self.payload.serialize()
+        return r
+
+    def __repr__(self):
+        return "SegopDataEntry(txid=%064x payload=%s)" % (self.txid, repr(self.payload))
+
+
+class msg_getsegopdata:
+    __slots__ = ("txids",)
+    msgtype = b"getsegopdata"
+
+    def __init__(self, txids=None):
+        self.txids = txids if txids is not None else []
+
+    def deserialize(self, f):
+        self.txids = deser_uint256_vector(f)
+
+    def serialize(self):
+        return ser_uint256_vector(self.txids)
+
+    def __repr__(self):
+        return "msg_getsegopdata(txids=%s)" % (["%064x" % txid for txid in self.txids])
+
+
+class msg_segopdata:
+    __slots__ = ("entries",)
+    msgtype = b"segopdata"
+
+    def __init__(self, entries=None):
+        self.entries = entries if entries is not None else []
+
+    def deserialize(self, f):
+        self.entries = deser_vector(f, SegopDataEntry)
+
+    def serialize(self):
+        return ser_vector(self.entries)
+
+    def __repr__(self):
+        return "msg_segopdata(entries=%s)" % (repr(self.entries))
+
+
 class TestFrameworkScript(unittest.TestCase):
     def test_addrv2_encode_decode(self):
         def check_addrv2(ip, net):
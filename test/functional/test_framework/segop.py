@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 - Defenwycke - segOP
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Utilities for creating segOP transactions in functional tests."""
+
+from decimal import Decimal
+
+from .key import TaggedHash
+from .messages import (
+    CTxOut,
+    ser_compact_size,
+    sha256,
+)
+from .script import (
+    CScript,
+    OP_RETURN,
+)
+
+# BUDS tier codes, carried in a 0xF0 TLV record
+BUDS_TIER_T1 = 0x10
+BUDS_TIER_T2 = 0x20
+# BUDS data type codes, carried in a 0xF1 TLV record; their meaning depends on the tier
+BUDS_TYPE_T1_TEXT_NOTE = 0x01
+BUDS_TYPE_T2_L2_STATE_ANCHOR = 0x01
+
+TLV_TEXT = 0x01
+TLV_BUDS_TIER = 0xF0
+TLV_BUDS_TYPE = 0xF1
+
+
+def segop_tlv(tlv_type, value):
+    """Serialize one TLV record: [type][CompactSize length][value]."""
+    return bytes([tlv_type]) + ser_compact_size(len(value)) + value
+
+
+def segop_text_payload(text, *, tier=None, data_type=None):
+    """A segOP payload holding `text`, optionally labelled with a BUDS tier and data type."""
+    payload = b""
+    if tier is not None:
+        payload += segop_tlv(TLV_BUDS_TIER, bytes([tier]))
+    if data_type is not None:
+        payload += segop_tlv(TLV_BUDS_TYPE, bytes([data_type]))
+    return payload + segop_tlv(TLV_TEXT, text.encode())
+
+
+def p2sop_script(payload):
+    """The P2SOP output committing to `payload`: OP_RETURN "P2SOP" || commitment."""
+    # The commitment is the double SHA256 of the tagged hash preimage.
+    commitment = sha256(TaggedHash("segop:commitment", payload))
+    return CScript([OP_RETURN, b"P2SOP" + commitment])
+
+
+def send_segop_tx(node, wallet, payload, *, fee=Decimal("0.001")):
+    """Broadcast a MiniWallet self-transfer carrying `payload` and its P2SOP commitment.
+
+    Returns the txid and hex of the transaction.
+    """
+    tx = wallet.create_self_transfer(fee=fee)["tx"]
+    tx.vout.append(CTxOut(0, p2sop_script(payload)))
+    tx_hex = node.createsegoptx(tx.serialize().hex(), payload.hex())["hex"]
+    return {"txid": node.sendrawtransaction(tx_hex), "hex": tx_hex}
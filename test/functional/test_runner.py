@@ -126,6 +126,7 @@ BASE_SCRIPTS = [
     'wallet_groups.py',
     'p2p_blockfilters.py',
     'feature_assumevalid.py',
+    'feature_segop_lightibd.py',
     'wallet_taproot.py',
     'feature_bip68_sequence.py',
     'rpc_packages.py',
@@ -156,6 +157,7 @@ BASE_SCRIPTS = [
     'feature_reindex_readonly.py',
     'wallet_labels.py',
     'p2p_compactblocks.py',
+    'p2p_segop_compactblocks.py',
     'p2p_compactblocks_blocksonly.py',
     'wallet_hd.py',
     'wallet_blank.py',
@@ -307,6 +309,7 @@ BASE_SCRIPTS = [
     'wallet_send.py',
     'wallet_sendall.py',
     'wallet_sendmany.py',
+    'wallet_segopsendmany.py',
     'wallet_spend_unconfirmed.py',
     'wallet_rescan_unconfirmed.py',
     'p2p_fingerprint.py',
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 - Defenwycke - segOP
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test the segopsendmany RPC command.
+
+- Every transaction carries its payload and the P2SOP output committing
+  to it, and pays for the payload's weight.
+- A chained batch spends the change of each transaction in the next one.
+- A transaction the mempool does not accept stops the batch, and the
+  error lists the transactions already broadcast.
+"""
+from test_framework.authproxy import JSONRPCException
+from test_framework.messages import (
+    COIN,
+    tx_from_hex,
+)
+from test_framework.segop import (
+    BUDS_TIER_T1,
+    BUDS_TYPE_T1_TEXT_NOTE,
+    p2sop_script,
+    segop_text_payload,
+)
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+
+# Chains longer than this are rejected by the mempool (-limitancestorcount)
+ANCESTOR_LIMIT = 5
+FEE_RATE = 10  # sat/vB
+
+
+class SegopSendManyTest(BitcoinTestFramework):
+    def skip_test_if_missing_module(self):
+        self.skip_if_no_wallet()
+
+    def set_test_params(self):
+        self.num_nodes = 1
+        self.setup_clean_chain = True
+        self.extra_args = [[f"-limitancestorcount={ANCESTOR_LIMIT}"]]
+
+    def run_test(self):
+        self.def_wallet = self.nodes[0].get_wallet_rpc(self.default_wallet_name)
+        # Enough mature coins to fund an unchained batch
+        self.generate(self.nodes[0], 110)
+
+        self.test_payloads_and_fees(chained=False)
+        self.test_payloads_and_fees(chained=True)
+        self.test_partial_broadcast()
+
+    def check_batch(self, wallet, txids, texts):
+        """Check that every transaction carries its payload, and that its fee covers, but barely exceeds, its weight.
+
+        Returns the total fee, in satoshis.
+        """
+        node = self.nodes[0]
+        total_fee = 0
+        for txid, text in zip(txids, texts, strict=True):
+            # The "text" encoding labels payloads as text notes.
+            payload = segop_text_payload(text, tier=BUDS_TIER_T1, data_type=BUDS_TYPE_T1_TEXT_NOTE)
+            tx = tx_from_hex(wallet.gettransaction(txid)["hex"])
+            assert_equal(tx.txid_hex, txid)
+            assert_equal(tx.segop.data, payload)
+            assert_equal([txout.scriptPubKey for txout in tx.vout].count(p2sop_script(payload)), 1)
+
+            # The wallet pays FEE_RATE for the vsize it estimated for the
+            # signed transaction, which is an upper bound of the actual one,
+            # off by at most a byte per signature.
+            entry = node.getmempoolentry(txid)
+            fee = int(entry["fees"]["base"] * COIN)
+            assert_equal(fee % FEE_RATE, 0)
+            estimated_vsize = fee // FEE_RATE
+            assert entry["vsize"] <= estimated_vsize <= entry["vsize"] + len(tx.vin)
+            assert_equal(entry["weight"], tx.get_weight())
+            total_fee += fee
+        return total_fee
+
+    def test_payloads_and_fees(self, *, chained):
+        self.log.info(f"Test that each {'chained ' if chained else ''}transaction carries its payload and pays for its weight")
+        texts = ["first note", "second note", "a longer third note " * 20]
+        res = self.def_wallet.segopsendmany(texts, {"chained": chained, "fee_rate": FEE_RATE})
+        assert_equal(int(res["fee"] * COIN), self.check_batch(self.def_wallet, res["txids"], texts))
+
+        txs = [tx_from_hex(self.def_wallet.gettransaction(txid)["hex"]) for txid in res["txids"]]
+        for parent, child in zip(txs, txs[1:]):
+            spends_parent = any(txin.prevout.hash == parent.txid_int for txin in child.vin)
+            assert_equal(spends_parent, chained)
+        self.generate(self.nodes[0], 1)
+
+    def test_partial_broadcast(self):
+        self.log.info("Test that a transaction the mempool rejects stops the batch and the broadcast ones are reported")
+        node = self.nodes[0]
+        node.createwallet("partial")
+        wallet = node.get_wallet_rpc("partial")
+        self.def_wallet.sendtoaddress(wallet.getnewaddress(), 1)
+        self.generate(node, 1)
+        # A single unconfirmed coin, so that a chain of ANCESTOR_LIMIT
+        # transactions spending it exceeds the limit by one.
+        wallet.sendall([wallet.getnewaddress()])
+        assert_equal(len(wallet.listunspent(minconf=0)), 1)
+
+        texts = [f"note {i}" for i in range(ANCESTOR_LIMIT)]
+        try:
+            wallet.segopsendmany(texts, {"chained": True, "fee_rate": FEE_RATE})
+            raise AssertionError("segopsendmany should have failed")
+        except JSONRPCException as e:
+            assert_equal(e.error["code"], -4)
+            message = e.error["message"]
+        assert message.startswith(f"payloads[{ANCESTOR_LIMIT - 1}]: Transaction ")
+        assert " was not accepted to the mempool and was abandoned. Already broadcast: " in message
+        broadcast = message.split("Already broadcast: ")[1].split(", ")
+        self.check_batch(wallet, broadcast, texts[:-1])
+        rejected = message.split(" ")[2]
+        assert rejected not in node.getrawmempool()
+        # Abandoning it made the change it spent available again.
+        assert_equal([utxo["txid"] for utxo in wallet.listunspent(minconf=0)], [broadcast[-1]])
+
+        self.log.info("Test that a batch that cannot be built sends nothing")
+        self.generate(node, 1)
+        # The change of the last broadcast transaction is the only coin left.
+        assert_equal(len(wallet.listunspent()), 1)
+        assert_raises_rpc_error(-4, "payloads[1]: Insufficient funds", wallet.segopsendmany, texts[:2], {"fee_rate": FEE_RATE})
+        assert_equal(node.getrawmempool(), [])
+
+        self.log.info("Test that the rest of the batch can be sent once the chain is confirmed")
+        res = wallet.segopsendmany(texts[-1:], {"fee_rate": FEE_RATE})
+        assert_equal(int(res["fee"] * COIN), self.check_batch(wallet, res["txids"], texts[-1:]))
+
+
+if __name__ == '__main__':
+    SegopSendManyTest(__file__).main()